@@ -0,0 +1,140 @@
+#include "autotuner.h"
+#include "raster_tuning.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    constexpr int BLOCK_SIZES[] = {8, 16, 32, 64};
+    constexpr int PARALLEL_THRESHOLDS[] = {256, 1024, 4096, 16384};
+    constexpr int MSAA_ROWS_PER_TASK[] = {0, 1, 2, 4, 8, 16}; // 0：按工作者数自动
+    constexpr int RESOLVE_TILE_ROWS[] = {1, 2, 4, 8};
+
+    // 用给定参数渲染若干帧，返回帧时间中位数（毫秒）
+    double measureFrameTime(Renderer &renderer, Scene &scene, const RasterTuning &tuning,
+                            const AutotuneOptions &options, std::vector<uint32_t> &pixels)
+    {
+        renderer.setRasterTuning(tuning);
+        const FrameBuffer &frameBuffer = renderer.getFrameBuffer();
+        auto renderFrame = [&]() {
+            scene.render(renderer);
+            frameBuffer.copyToPlatform(pixels.data());
+        };
+
+        for (int frame = 0; frame < options.warmupFrames; ++frame)
+        {
+            renderFrame();
+        }
+        std::vector<double> frameMs;
+        for (int frame = 0; frame < std::max(options.timedFrames, 1); ++frame)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            renderFrame();
+            frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+        }
+        std::sort(frameMs.begin(), frameMs.end());
+        return frameMs[frameMs.size() / 2];
+    }
+
+    // 在候选值中选出帧时间最短的一个，field指向tuning中被调整的参数
+    template <size_t N>
+    double tuneParameter(Renderer &renderer, Scene &scene, RasterTuning &tuning, int RasterTuning::*field,
+                         const int (&candidates)[N], const char *name, const AutotuneOptions &options,
+                         std::vector<uint32_t> &pixels)
+    {
+        double bestMs = 0.0;
+        int bestValue = tuning.*field;
+        for (int value : candidates)
+        {
+            RasterTuning candidate = tuning;
+            candidate.*field = value;
+            const double ms = measureFrameTime(renderer, scene, candidate, options, pixels);
+            if (options.debugMode)
+            {
+                std::cout << "[Autotune]   " << name << "=" << value << "  " << ms << " ms" << std::endl;
+            }
+            if (bestMs == 0.0 || ms < bestMs)
+            {
+                bestMs = ms;
+                bestValue = value;
+            }
+        }
+        tuning.*field = bestValue;
+        return bestMs;
+    }
+}
+
+RasterTuning runAutotune(Renderer &renderer, Scene &scene, const AutotuneOptions &options)
+{
+    const bool pipelining = renderer.isFramePipeliningEnabled();
+    const bool msaa = renderer.getFrameBuffer().isMSAAEnabled();
+    renderer.enableFramePipelining(false);
+
+    const FrameBuffer &frameBuffer = renderer.getFrameBuffer();
+    std::vector<uint32_t> pixels(static_cast<size_t>(frameBuffer.getWidth()) * frameBuffer.getHeight());
+    std::cout << std::fixed << std::setprecision(3);
+
+    const double defaultMs = measureFrameTime(renderer, scene, RasterTuning(), options, pixels);
+    std::cout << "[Autotune] 默认参数: " << defaultMs << " ms/帧" << std::endl;
+
+    // 1. 分块大小和并行门限：小块负载更均衡但调度开销大，门限决定多大的三角形值得拆成任务
+    RasterTuning best = RasterTuning();
+    double bestMs = 0.0;
+    renderer.enableMSAA(false);
+    for (int blockSize : BLOCK_SIZES)
+    {
+        for (int threshold : PARALLEL_THRESHOLDS)
+        {
+            RasterTuning candidate = best;
+            candidate.blockSize = blockSize;
+            candidate.parallelPixelThreshold = threshold;
+            const double ms = measureFrameTime(renderer, scene, candidate, options, pixels);
+            if (options.debugMode)
+            {
+                std::cout << "[Autotune]   block=" << blockSize << " threshold=" << threshold << "  " << ms << " ms" << std::endl;
+            }
+            if (bestMs == 0.0 || ms < bestMs)
+            {
+                bestMs = ms;
+                best.blockSize = blockSize;
+                best.parallelPixelThreshold = threshold;
+            }
+        }
+    }
+    std::cout << "[Autotune] 分块 " << best.blockSize << ", 并行门限 " << best.parallelPixelThreshold
+              << " 像素: " << bestMs << " ms/帧" << std::endl;
+
+    // 2. MSAA按行并行遍历的任务粒度
+    renderer.enableMSAA(true);
+    const double msaaMs = tuneParameter(renderer, scene, best, &RasterTuning::msaaRowsPerTask, MSAA_ROWS_PER_TASK,
+                                        "msaa_rows", options, pixels);
+    std::cout << "[Autotune] MSAA每任务行数 " << best.msaaRowsPerTask << (best.msaaRowsPerTask == 0 ? "（自动）" : "")
+              << ": " << msaaMs << " ms/帧（MSAA）" << std::endl;
+    renderer.enableMSAA(msaa);
+
+    // 3. 颜色展开的任务粒度
+    const double resolveMs = tuneParameter(renderer, scene, best, &RasterTuning::resolveTileRowsPerTask,
+                                           RESOLVE_TILE_ROWS, "resolve_rows", options, pixels);
+    std::cout << "[Autotune] 展开每任务tile行数 " << best.resolveTileRowsPerTask << ": " << resolveMs << " ms/帧" << std::endl;
+
+    renderer.setRasterTuning(best);
+    renderer.enableFramePipelining(pipelining);
+    std::cout << std::defaultfloat;
+
+    const int workers = JobSystem::getInstance().getWorkerCount();
+    if (!options.profileFile.empty())
+    {
+        if (saveRasterTuning(options.profileFile, best, workers))
+        {
+            std::cout << "[Autotune] 调优配置已保存到 " << options.profileFile << "（" << workers << " 个工作者）" << std::endl;
+        }
+        else
+        {
+            std::cerr << "无法创建文件：" << options.profileFile << std::endl;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+#include "scene.h"
+
+// 自动调优参数
+struct AutotuneOptions
+{
+    int warmupFrames = 2;   // 每个候选配置计时前渲染的帧数
+    int timedFrames = 8;    // 计时的帧数，取中位数
+    std::string profileFile; // 调优配置的输出文件，为空时不保存
+    bool debugMode = false;
+};
+
+/**
+ * 在当前场景和相机下测量光栅化参数的候选组合，选出帧时间最短的配置，应用到renderer并保存到profileFile：
+ *   1. 分块大小 × 并行门限（两者相互影响，按网格搜索）
+ *   2. MSAA并行遍历每个任务的行数（临时启用MSAA测量）
+ *   3. 颜色展开每个任务的tile行数
+ * 每一步固定已选出的参数。帧时间包含光栅化和复制到平台层，测量期间关闭帧流水线，结束后恢复。
+ */
+RasterTuning runAutotune(Renderer &renderer, Scene &scene, const AutotuneOptions &options);
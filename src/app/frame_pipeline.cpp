@@ -0,0 +1,151 @@
+#include "frame_pipeline.h"
+#include "utils.hpp"
+#include <chrono>
+#include <cstring>
+
+FramePipeline::FramePipeline(Renderer &renderer, Scene &scene)
+    : renderer(renderer), scene(scene)
+{
+    renderer.enableFramePipelining(true);
+    renderThread = std::thread(&FramePipeline::renderLoop, this);
+}
+
+FramePipeline::~FramePipeline()
+{
+    waitRendered();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    renderThread.join();
+
+    // 等待最后一帧光栅化完成后恢复内部颜色存储，仍处于锁定状态的纹理由platform_cleanup解锁
+    renderer.enableFramePipelining(false);
+    renderer.setColorTarget(nullptr, 0);
+}
+
+void FramePipeline::kick(const char *screenshotFilename)
+{
+    const FrameBuffer &frameBuffer = renderer.getFrameBuffer();
+    const int width = frameBuffer.getWidth();
+    const int height = frameBuffer.getHeight();
+
+    renderSlot = (renderSlot + 1) % PLATFORM_FRAMEBUFFER_SLOTS;
+    Slot &slot = slots[renderSlot];
+
+    // 纹理只能在主线程锁定，锁定后的像素可以在任意线程写入；截图要读回像素，不使用只写的纹理
+    slot.screenshot = screenshotFilename ? screenshotFilename : "";
+    int pitch = 0;
+    void *pixels = slot.screenshot.empty() ? platform_lock_framebuffer(renderSlot, width, height, &pitch) : nullptr;
+    if (pixels)
+    {
+        slot.pixels = static_cast<uint32_t *>(pixels);
+        slot.pitch = pitch / static_cast<int>(sizeof(uint32_t));
+        slot.locked = true;
+    }
+    else
+    {
+        slot.fallback.resize(static_cast<size_t>(width) * height);
+        slot.pixels = slot.fallback.data();
+        slot.pitch = width;
+        slot.locked = false;
+    }
+    slot.pending = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        frameRequested = true;
+    }
+    condition.notify_all();
+}
+
+void FramePipeline::waitRendered()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!frameRequested && renderSlot < 0)
+    {
+        return;
+    }
+    condition.wait(lock, [this] { return !frameRequested; });
+    if (completedSlot >= 0 && completedSlot != presentSlot)
+    {
+        slots[completedSlot].pending = true;
+        presentSlot = completedSlot;
+    }
+}
+
+void FramePipeline::presentPrevious(bool debugMode)
+{
+    if (presentSlot < 0 || !slots[presentSlot].pending)
+    {
+        return;
+    }
+    Slot &slot = slots[presentSlot];
+    const FrameBuffer &frameBuffer = renderer.getFrameBuffer();
+    const int width = frameBuffer.getWidth();
+    const int height = frameBuffer.getHeight();
+
+    // 请求截图的帧渲染在槽位的内存缓冲中，可以安全读取
+    if (!slot.screenshot.empty())
+    {
+        saveToPPM(slot.screenshot, slot.pixels, width, height, slot.pitch, debugMode);
+        slot.screenshot.clear();
+    }
+
+    if (slot.locked)
+    {
+        platform_present_framebuffer(presentSlot);
+        slot.locked = false;
+    }
+    else
+    {
+        uint32_t *dst = static_cast<uint32_t *>(platform_get_framebuffer());
+        if (dst)
+        {
+            std::memcpy(dst, slot.pixels, static_cast<size_t>(width) * height * sizeof(uint32_t));
+        }
+        // 本槽位的纹理没有锁定（渲染线程锁定的是下一个槽位），用它上传和呈现
+        platform_update_framebuffer(presentSlot);
+    }
+    slot.pixels = nullptr;
+    slot.pending = false;
+}
+
+void FramePipeline::renderLoop()
+{
+    Profiler::getInstance().setThreadName("render");
+    while (true)
+    {
+        int slotIndex;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return frameRequested || stopping; });
+            if (stopping)
+            {
+                return;
+            }
+            slotIndex = renderSlot;
+        }
+
+        Slot &slot = slots[slotIndex];
+        auto startTime = std::chrono::high_resolution_clock::now();
+        // 颜色目标在上一帧光栅化完成后才生效
+        renderer.setColorTarget(slot.pixels, slot.pitch);
+        scene.render(renderer);
+        auto endTime = std::chrono::high_resolution_clock::now();
+        lastRenderTime.store(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count(),
+                             std::memory_order_relaxed);
+
+        // Scene::render返回时上一帧的光栅化已经完成，本帧的仍在进行
+        const int finishedSlot = rasterSlot;
+        rasterSlot = slotIndex;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            completedSlot = finishedSlot;
+            frameRequested = false;
+        }
+        condition.notify_all();
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "scene.h"
+#include "platform.h"
+
+/**
+ * 帧流水线：渲染线程处理第N+1帧的同时，主线程处理输入并呈现已完成的帧
+ *
+ * - SDL的纹理解锁和呈现必须在创建渲染器的线程（主线程）上进行，
+ *   因此主线程负责事件、相机、截图和呈现，场景渲染放到专用的渲染线程。
+ * - 渲染器启用帧流水线：Scene::render返回时本帧的光栅化仍在工作线程上进行，
+ *   下一帧的几何阶段与之重叠，并在修改共享状态前等待它完成。
+ * - 颜色目标在PLATFORM_FRAMEBUFFER_SLOTS个槽位间轮转：每个槽位是一张锁定的流式纹理，
+ *   锁定失败时退化为槽位自己的内存缓冲，呈现时复制到平台帧缓冲。
+ *   锁定的纹理只能写入，要截图的帧同样使用内存缓冲，呈现前从中保存截图。
+ * - 一帧在呈现、一帧在光栅化、一帧在做几何处理；主线程在渲染线程空闲时才修改场景，
+ *   光栅化只读取帧上下文中的快照，不需要额外的场景锁。
+ *
+ * 典型用法：
+ *   pipeline.kick();                    // 启动第0帧
+ *   while (...) {
+ *       pipeline.waitRendered();        // 渲染线程空闲，此前提交的帧中除最后一帧外均已光栅化完成
+ *       处理事件、更新相机
+ *       pipeline.kick(...);             // 开始处理下一帧，可请求保存该帧的截图
+ *       pipeline.presentPrevious();     // 呈现最近完成的一帧
+ *   }
+ */
+class FramePipeline
+{
+public:
+    FramePipeline(Renderer &renderer, Scene &scene);
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    // 为下一帧分配颜色目标并通知渲染线程开始渲染，调用前渲染线程必须空闲；
+    // screenshotFilename非空时该帧呈现前保存截图
+    void kick(const char *screenshotFilename = nullptr);
+    // 等待渲染线程处理完已提交的帧（该帧的光栅化可能仍在进行）
+    void waitRendered();
+    // 呈现上一帧已完成的图像，该帧请求了截图时先保存截图
+    void presentPrevious(bool debugMode = false);
+
+    // 最近一帧在渲染线程上的耗时（毫秒）
+    long long getLastRenderTime() const { return lastRenderTime.load(std::memory_order_relaxed); }
+
+private:
+    // 颜色目标槽位
+    struct Slot
+    {
+        uint32_t *pixels = nullptr;      // 本帧的颜色目标
+        int pitch = 0;                   // 每行像素数
+        bool locked = false;             // 是否为锁定的平台纹理
+        bool pending = false;            // 已渲染完成、等待呈现
+        std::string screenshot;          // 非空时呈现前保存截图
+        std::vector<uint32_t> fallback;  // 锁定失败时使用的内存缓冲
+    };
+
+    Renderer &renderer;
+    Scene &scene;
+    Slot slots[PLATFORM_FRAMEBUFFER_SLOTS];
+    int renderSlot = -1;    // 最近提交的帧使用的槽位
+    int rasterSlot = -1;    // 光栅化尚未确认完成的槽位（仅渲染线程访问）
+    int completedSlot = -1; // 渲染线程最近确认光栅化完成的槽位
+    int presentSlot = -1;   // 下一次presentPrevious要呈现的槽位
+
+    std::thread renderThread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool frameRequested = false; // 主线程已提交帧，渲染线程尚未完成
+    bool stopping = false;
+    std::atomic<long long> lastRenderTime{0};
+
+    void renderLoop();
+};
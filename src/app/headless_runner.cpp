@@ -0,0 +1,114 @@
+#include "headless_runner.h"
+#include "utils.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    // 相机路径：绕目标点在水平面上旋转，保持初始的高度和水平距离
+    class OrbitPath
+    {
+    public:
+        OrbitPath(const Camera &camera, int frameCount)
+            : target(camera.getTarget()), frameCount(std::max(frameCount, 1))
+        {
+            const Vec3f offset = camera.getPosition() - target;
+            height = offset.y;
+            radius = std::sqrt(offset.x * offset.x + offset.z * offset.z);
+            startAngle = std::atan2(offset.z, offset.x);
+        }
+
+        void apply(Camera &camera, int frame) const
+        {
+            const float angle = startAngle + 2.0f * static_cast<float>(M_PI) * frame / frameCount;
+            camera.setPosition(Vec3f(target.x + radius * std::cos(angle),
+                                     target.y + height,
+                                     target.z + radius * std::sin(angle)));
+        }
+
+    private:
+        Vec3f target;
+        int frameCount;
+        float height = 0.0f;
+        float radius = 0.0f;
+        float startAngle = 0.0f;
+    };
+
+    std::string frameFilename(const std::string &outputDir, int frame)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "frame_%04d.ppm", frame);
+        return (std::filesystem::path(outputDir) / name).string();
+    }
+}
+
+HeadlessStats runHeadless(Renderer &renderer, Scene &scene, const HeadlessOptions &options)
+{
+    HeadlessStats stats;
+    const int frameCount = std::max(options.frameCount, 0);
+    const bool saveImages = !options.outputDir.empty();
+    if (saveImages)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(options.outputDir, error);
+        if (error)
+        {
+            std::cerr << "无法创建输出目录：" << options.outputDir << std::endl;
+            return stats;
+        }
+    }
+
+    const FrameBuffer &frameBuffer = renderer.getFrameBuffer();
+    const int width = frameBuffer.getWidth();
+    const int height = frameBuffer.getHeight();
+    const OrbitPath path(scene.getCamera(), frameCount);
+
+    auto saveFrame = [&](const uint32_t *pixels, int frame) {
+        if (saveImages)
+        {
+            saveToPPM(frameFilename(options.outputDir, frame), pixels, width, height, width, options.debugMode);
+        }
+    };
+
+    // 两个颜色目标轮流使用：Scene::render返回时上一帧已光栅化完成，可以在下一帧光栅化的同时保存
+    std::vector<uint32_t> targets[2];
+    for (std::vector<uint32_t> &target : targets)
+    {
+        target.resize(static_cast<size_t>(width) * height);
+    }
+
+    renderer.enableFramePipelining(options.pipeline);
+    auto startTime = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frameCount; ++frame)
+    {
+        PROFILE_SCOPE("Frame");
+        path.apply(scene.getCamera(), frame);
+        renderer.setColorTarget(targets[frame % 2].data(), width);
+        scene.render(renderer);
+        if (!options.pipeline)
+        {
+            saveFrame(targets[frame % 2].data(), frame);
+        }
+        else if (frame > 0)
+        {
+            saveFrame(targets[(frame - 1) % 2].data(), frame - 1);
+        }
+    }
+    renderer.finishFrame();
+    if (options.pipeline && frameCount > 0)
+    {
+        saveFrame(targets[(frameCount - 1) % 2].data(), frameCount - 1);
+    }
+    auto endTime = std::chrono::steady_clock::now();
+
+    renderer.enableFramePipelining(false);
+    renderer.setColorTarget(nullptr, 0);
+
+    stats.frameCount = frameCount;
+    stats.totalMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    return stats;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include "scene.h"
+
+// 无窗口渲染参数
+struct HeadlessOptions
+{
+    int frameCount = 60;                          // 渲染帧数
+    std::string outputDir = "../output/headless"; // 输出目录，为空时不保存图像（只测吞吐量）
+    bool pipeline = true;                         // 启用帧流水线：保存第N帧的同时光栅化第N+1帧
+    bool debugMode = false;
+};
+
+// 无窗口渲染统计
+struct HeadlessStats
+{
+    int frameCount = 0;
+    double totalMs = 0.0; // 总耗时（含保存图像，流水线模式下保存与光栅化重叠）
+};
+
+/**
+ * 无窗口渲染：不初始化平台层，沿绕相机目标点水平一周的路径渲染frameCount帧，
+ * 每帧保存为outputDir/frame_XXXX.ppm。第0帧使用场景的初始相机位置。
+ * 用于没有显示设备的渲染节点和CI上测量吞吐量。
+ */
+HeadlessStats runHeadless(Renderer &renderer, Scene &scene, const HeadlessOptions &options);
@@ -2,6 +2,7 @@
 #include "texture_io.h"
 #include "platform.h"
 #include "utils.hpp"
+#include "platform_frame.h"
 #include "camera_controller.h"
 #include <iostream>
 #include <fstream>
@@ -11,7 +12,14 @@
 #include <vector>
 #include <memory>
 #include <cstring>
+#include <cstdlib>
+#include <algorithm>
 #include "scene_manager.h"
+#include "frame_pipeline.h"
+#include "headless_runner.h"
+#include "raster_check.h"
+#include "autotuner.h"
+#include "simd_dispatch.h"
 
 // 全局变量
 bool g_debugMode = false;
@@ -26,6 +34,19 @@ void printHelp()
     std::cout << "  --scene=<type>    选择场景类型 (default, spheres, cubes)" << std::endl;
     std::cout << "  --msaa=<0|1>      启用/禁用MSAA抗锯齿 (默认: 0)" << std::endl;
     std::cout << "  --shadow=<0|1>    启用/禁用阴影投射 (默认: 0)" << std::endl;
+    std::cout << "  --tiled=<0|1>     帧缓冲按8x8 tile存储 (默认: 0)" << std::endl;
+    std::cout << "  --pipeline=<0|1>  帧流水线：呈现、光栅化与下一帧几何处理重叠 (默认: 1)" << std::endl;
+    std::cout << "  --overdraw        以伪彩色热力图显示每个像素的片段着色次数" << std::endl;
+    std::cout << "  --deterministic   确定性光栅化：输出与线程数和遍历路径无关，逐位可复现" << std::endl;
+    std::cout << "  --check-raster    把初始画面分别串行和并行渲染并逐像素比较，不一致时返回1" << std::endl;
+    std::cout << "  --autotune        在初始画面上测量分块大小和并行门限的候选组合，保存调优配置后退出" << std::endl;
+    std::cout << "  --tuning=<file>   调优配置文件，启动时存在则加载 (默认: ../tuning.json)" << std::endl;
+    std::cout << "  --simd=<level>    强制kernel指令集级别 (baseline, sse4.2, avx2, avx512；默认: 按CPU自动选择)" << std::endl;
+    std::cout << "  --headless        无窗口模式：沿环绕路径渲染若干帧并保存为图像" << std::endl;
+    std::cout << "  --frames=<n>      无窗口模式渲染的帧数 (默认: 60)" << std::endl;
+    std::cout << "  --output=<dir>    无窗口模式的输出目录，为空时不保存图像 (默认: ../output/headless)" << std::endl;
+    std::cout << "  --counters        启用性能分析和硬件计数器，退出时输出IPC和每像素/三角形的缺失数" << std::endl;
+    std::cout << "  --trace=<file>    启用性能分析，退出时导出Chrome trace JSON (chrome://tracing或Perfetto)" << std::endl;
     std::cout << std::endl;
     std::cout << "控制方式：" << std::endl;
     std::cout << "  W/A/S/D         前后左右移动" << std::endl;
@@ -37,7 +58,10 @@ void printHelp()
 }
 
 // 解析命令行参数
-void parseCommandLine(int argc, char *argv[], SceneType &sceneType, bool &enableMSAA, bool &enableShadow)
+void parseCommandLine(int argc, char *argv[], SceneType &sceneType, bool &enableMSAA, bool &enableShadow,
+                      bool &enablePipeline, bool &enableTiled, bool &enableOverdraw, bool &headless,
+                      HeadlessOptions &headlessOptions, std::string &traceFile, bool &enableCounters,
+                      bool &enableDeterministic, bool &checkRaster, bool &autotune, std::string &tuningFile)
 {
     for (int i = 1; i < argc; i++)
     {
@@ -78,6 +102,81 @@ void parseCommandLine(int argc, char *argv[], SceneType &sceneType, bool &enable
             std::string shadowArg = arg.substr(9);
             enableShadow = (shadowArg == "1");
         }
+        else if (arg.find("--tiled=") == 0)
+        {
+            std::string tiledArg = arg.substr(8);
+            enableTiled = (tiledArg == "1");
+        }
+        else if (arg.find("--pipeline=") == 0)
+        {
+            std::string pipelineArg = arg.substr(11);
+            enablePipeline = (pipelineArg == "1");
+        }
+        else if (arg == "--overdraw")
+        {
+            enableOverdraw = true;
+        }
+        else if (arg == "--deterministic")
+        {
+            enableDeterministic = true;
+        }
+        else if (arg == "--check-raster")
+        {
+            checkRaster = true;
+        }
+        else if (arg == "--autotune")
+        {
+            autotune = true;
+        }
+        else if (arg.find("--tuning=") == 0)
+        {
+            tuningFile = arg.substr(9);
+        }
+        else if (arg.find("--simd=") == 0)
+        {
+            SimdLevel level;
+            if (parseSimdLevel(arg.c_str() + 7, level))
+            {
+                setSimdLevel(level);
+            }
+            else
+            {
+                std::cerr << "未知的指令集级别: " << arg.substr(7) << "，使用自动选择的级别" << std::endl;
+            }
+        }
+        else if (arg == "--headless")
+        {
+            headless = true;
+        }
+        else if (arg.find("--frames=") == 0)
+        {
+            headlessOptions.frameCount = std::max(0, std::atoi(arg.substr(9).c_str()));
+        }
+        else if (arg.find("--output=") == 0)
+        {
+            headlessOptions.outputDir = arg.substr(9);
+        }
+        else if (arg == "--counters")
+        {
+            enableCounters = true;
+        }
+        else if (arg.find("--trace=") == 0)
+        {
+            traceFile = arg.substr(8);
+        }
+    }
+}
+
+// 输出性能分析结果，调用时所有渲染线程必须空闲
+void writeProfilingResults(const Renderer &renderer, const std::string &traceFile, bool printReport)
+{
+    if (!traceFile.empty())
+    {
+        Profiler::getInstance().writeChromeTrace(traceFile);
+    }
+    if (printReport)
+    {
+        renderer.printProfilingReport();
     }
 }
 
@@ -91,12 +190,26 @@ int main(int argc, char *argv[])
     SceneType sceneType = SceneType::DEFAULT;
     bool enableMSAA = false;
     bool enableShadow = false;
+    bool enablePipeline = true;
+    bool enableTiled = false;
+    bool enableOverdraw = false;
+    bool headless = false;
+    HeadlessOptions headlessOptions;
+    std::string traceFile;
+    bool enableCounters = false;
+    bool enableDeterministic = false;
+    bool checkRaster = false;
+    bool autotune = false;
+    std::string tuningFile = "../tuning.json";
 
     // 解析命令行参数
-    parseCommandLine(argc, argv, sceneType, enableMSAA, enableShadow);
+    parseCommandLine(argc, argv, sceneType, enableMSAA, enableShadow, enablePipeline, enableTiled, enableOverdraw,
+                     headless, headlessOptions, traceFile, enableCounters, enableDeterministic, checkRaster,
+                     autotune, tuningFile);
+    Profiler::getInstance().setThreadName("main");
 
-    // 初始化平台
-    if (!platform_init(TITLE, WIDTH, HEIGHT))
+    // 初始化平台（无窗口模式不需要）
+    if (!headless && !checkRaster && !autotune && !platform_init(TITLE, WIDTH, HEIGHT))
     {
         std::cerr << "平台初始化失败!" << std::endl;
         return -1;
@@ -105,6 +218,28 @@ int main(int argc, char *argv[])
     // 创建渲染器
     Renderer renderer(WIDTH, HEIGHT);
     renderer.enableMSAA(enableMSAA);
+    renderer.setFrameBufferLayout(enableTiled ? FrameBufferLayout::TILED : FrameBufferLayout::LINEAR);
+    renderer.enableDeterministicRaster(enableDeterministic);
+    // 加载本机的调优配置（--autotune生成），没有时使用默认参数
+    RasterTuning tuning;
+    int tuningWorkers = 0;
+    if (!autotune && loadRasterTuning(tuningFile, tuning, &tuningWorkers))
+    {
+        renderer.setRasterTuning(tuning);
+        const int workers = JobSystem::getInstance().getWorkerCount();
+        if (tuningWorkers != workers)
+        {
+            std::cerr << "[Tuning] " << tuningFile << " 在 " << tuningWorkers << " 个工作者下测得，当前为 " << workers
+                      << " 个，建议重新运行 --autotune" << std::endl;
+        }
+        if (g_debugMode)
+        {
+            std::cout << "已加载调优配置：" << tuningFile << std::endl;
+        }
+    }
+    renderer.setDebugView(enableOverdraw ? DebugView::OVERDRAW : DebugView::NONE);
+    renderer.enableProfiling(!traceFile.empty() || enableCounters);
+    Profiler::getInstance().enableHardwareCounters(enableCounters);
 
     // 创建场景
     Scene scene;
@@ -126,16 +261,63 @@ int main(int argc, char *argv[])
         std::cout << "渲染设置：" << std::endl;
         std::cout << "  MSAA: " << (enableMSAA ? "启用" : "禁用") << std::endl;
         std::cout << "  阴影: " << (enableShadow ? "启用" : "禁用") << std::endl;
+        std::cout << "  分块帧缓冲: " << (enableTiled ? "启用" : "禁用") << std::endl;
+        std::cout << "  帧流水线: " << (enablePipeline ? "启用" : "禁用") << std::endl;
+        std::cout << "  确定性光栅化: " << (enableDeterministic ? "启用" : "禁用") << std::endl;
+        std::cout << "  SIMD kernel: " << getSimdLevelName(getSimdLevel()) << " (CPU最高支持 "
+                  << getSimdLevelName(getMaxSimdLevel()) << ")" << std::endl;
+    }
+
+    if (autotune)
+    {
+        AutotuneOptions autotuneOptions;
+        autotuneOptions.profileFile = tuningFile;
+        autotuneOptions.debugMode = g_debugMode;
+        runAutotune(renderer, scene, autotuneOptions);
+        return 0;
+    }
+
+    if (checkRaster)
+    {
+        const bool identical = printRasterCheckReport(checkSerialParallelRaster(scene, renderer));
+        return identical ? 0 : 1;
+    }
+
+    if (headless)
+    {
+        headlessOptions.pipeline = enablePipeline;
+        headlessOptions.debugMode = g_debugMode;
+        HeadlessStats stats = runHeadless(renderer, scene, headlessOptions);
+        const double msPerFrame = stats.frameCount > 0 ? stats.totalMs / stats.frameCount : 0.0;
+        std::cout << "无窗口渲染完成：" << stats.frameCount << " 帧，总耗时 " << stats.totalMs << " ms，"
+                  << "平均 " << msPerFrame << " ms/帧 (" << (msPerFrame > 0.0 ? 1000.0 / msPerFrame : 0.0) << " FPS)"
+                  << std::endl;
+        writeProfilingResults(renderer, traceFile, enableCounters);
+        return 0;
     }
 
-    // 主循环部分保持不变
     double lastTime = platform_get_time();
     int frameCount = 0;
     double fpsTime = lastTime;
     long long lastFrameTime = 0;
 
+    // 流水线模式下主线程呈现已完成的帧，同时渲染线程和工作线程处理后续两帧
+    std::unique_ptr<FramePipeline> pipeline;
+    if (enablePipeline)
+    {
+        pipeline = std::make_unique<FramePipeline>(renderer, scene);
+        pipeline->kick();
+    }
+
     while (!platform_should_close())
     {
+        PROFILE_SCOPE("Frame");
+        // 流水线模式：等待上一帧渲染完成，之后渲染线程空闲，可以安全修改场景
+        if (pipeline)
+        {
+            pipeline->waitRendered();
+            lastFrameTime = pipeline->getLastRenderTime();
+        }
 
         // 处理事件
         platform_process_events();
@@ -156,41 +338,44 @@ int main(int argc, char *argv[])
             fpsTime = currentTime;
         }
 
-        // if (g_debugMode)
-        // {
-        //     std::cout << "渲染耗时: " << lastFrameTime << "ms" << std::endl;
-        // }
-
-
         // 处理相机控制
         processCamera(scene.getCamera(), static_cast<float>(deltaTime));
-        // 渲染场景
-        // renderer.clear(Vec4f(0.1f, 0.1f, 0.1f, 1.0f));
+
+        if (pipeline)
+        {
+            // 先启动下一帧的渲染，再呈现刚完成的一帧（请求截图时保存下一帧）
+            const bool screenshot = platform_should_take_screenshot();
+            pipeline->kick(screenshot ? platform_get_screenshot_filename() : nullptr);
+            pipeline->presentPrevious(g_debugMode);
+            continue;
+        }
+
         // 添加简单的性能计时器
         auto startTime = std::chrono::high_resolution_clock::now();
+        // 颜色直接写入锁定的平台纹理；截图需要读回颜色，本帧改为渲染到内部存储
+        const bool screenshot = platform_should_take_screenshot();
+        beginPlatformFrame(renderer, screenshot);
         scene.render(renderer);
         auto endTime = std::chrono::high_resolution_clock::now();
         lastFrameTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
 
-        // 复制帧缓冲区到平台
-        copyFrameBufferToPlatform(renderer);
-
-        // 更新屏幕
-        platform_update_framebuffer();
-
-        // 处理截图
-        if (platform_should_take_screenshot())
+        // 处理截图：从内部存储读取，不读取锁定的纹理
+        if (screenshot)
         {
             saveToPPM(platform_get_screenshot_filename(), renderer.getFrameBuffer(),g_debugMode);
         }
 
-        // 限制帧率
-        // if (deltaTime < 1.0 / 60.0)
-        // {
-        //     platform_sleep(1.0 / 60.0 - deltaTime);
-        // }
+        // 更新屏幕
+        presentPlatformFrame(renderer);
     }
 
+    // 渲染线程必须在平台清理之前停止
+    pipeline.reset();
+
+    // 所有渲染线程空闲后才能读取各线程的事件
+    renderer.finishFrame();
+    writeProfilingResults(renderer, traceFile, enableCounters);
+
     // 清理资源
     platform_cleanup();
 
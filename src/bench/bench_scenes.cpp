@@ -0,0 +1,216 @@
+// bench_scenes.cpp
+#include "bench_scenes.h"
+#include "scene_manager.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    template <typename Key>
+    void findSegment(const std::vector<Key> &keys, float time, size_t &index, float &alpha)
+    {
+        index = 0;
+        while (index + 2 < keys.size() && time > keys[index + 1].time)
+        {
+            ++index;
+        }
+        const float span = keys[index + 1].time - keys[index].time;
+        alpha = span > 0.0f ? std::clamp((time - keys[index].time) / span, 0.0f, 1.0f) : 0.0f;
+    }
+
+    Vec3f lerp(const Vec3f &a, const Vec3f &b, float t)
+    {
+        return a + (b - a) * t;
+    }
+
+    //--------------------
+    // 合成场景（不依赖资源文件）
+    //--------------------
+    std::shared_ptr<Mesh> makeSphereMesh(int segments)
+    {
+        auto mesh = std::make_shared<Mesh>();
+        const float4 white(1.0f);
+        auto point = [segments](int ring, int slice) {
+            const float theta = static_cast<float>(M_PI) * ring / segments;
+            const float phi = 2.0f * static_cast<float>(M_PI) * slice / (segments * 2);
+            return Vec3f(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        };
+        for (int ring = 0; ring < segments; ++ring)
+        {
+            for (int slice = 0; slice < segments * 2; ++slice)
+            {
+                const Vec3f p0 = point(ring, slice), p1 = point(ring + 1, slice);
+                const Vec3f p2 = point(ring + 1, slice + 1), p3 = point(ring, slice + 1);
+                const Vec2f uv0(static_cast<float>(slice) / (segments * 2), static_cast<float>(ring) / segments);
+                const Vec2f uv2(static_cast<float>(slice + 1) / (segments * 2), static_cast<float>(ring + 1) / segments);
+                const Vec4f tangent(1.0f, 0.0f, 0.0f, 1.0f);
+                mesh->triangles.push_back(Triangle(Vertex(p0, p0, tangent, uv0, white),
+                                                   Vertex(p2, p2, tangent, uv2, white),
+                                                   Vertex(p1, p1, tangent, Vec2f(uv0.x, uv2.y), white)));
+                mesh->triangles.push_back(Triangle(Vertex(p0, p0, tangent, uv0, white),
+                                                   Vertex(p3, p3, tangent, Vec2f(uv2.x, uv0.y), white),
+                                                   Vertex(p2, p2, tangent, uv2, white)));
+                mesh->vertices.push_back(p0);
+            }
+        }
+        mesh->vertices.push_back(point(segments, 0));
+        return mesh;
+    }
+
+    // XZ平面上的单位正方形，法线朝+Y
+    std::shared_ptr<Mesh> makePlaneMesh()
+    {
+        auto mesh = std::make_shared<Mesh>();
+        const Vec3f normal(0.0f, 1.0f, 0.0f);
+        const Vec4f tangent(1.0f, 0.0f, 0.0f, 1.0f);
+        const float4 white(1.0f);
+        const Vertex a(Vec3f(-1.0f, 0.0f, -1.0f), normal, tangent, Vec2f(0.0f, 0.0f), white);
+        const Vertex b(Vec3f(1.0f, 0.0f, -1.0f), normal, tangent, Vec2f(1.0f, 0.0f), white);
+        const Vertex c(Vec3f(1.0f, 0.0f, 1.0f), normal, tangent, Vec2f(1.0f, 1.0f), white);
+        const Vertex d(Vec3f(-1.0f, 0.0f, 1.0f), normal, tangent, Vec2f(0.0f, 1.0f), white);
+        mesh->triangles.push_back(Triangle(a, c, b));
+        mesh->triangles.push_back(Triangle(a, d, c));
+        mesh->vertices = {a.position, b.position, c.position, d.position};
+        return mesh;
+    }
+
+    void setupSyntheticCamera(Scene &scene, int width, int height, const Vec3f &position)
+    {
+        Camera &camera = scene.getCamera();
+        camera.setPosition(position);
+        camera.setTarget(Vec3f(0.0f, 0.0f, 0.0f));
+        camera.setUp(Vec3f(0.0f, 1.0f, 0.0f));
+        camera.setAspect(static_cast<float>(width) / height);
+        camera.setFOV(3.14159f / 4.0f);
+    }
+
+    // 6x6个球体 + 地面：约8.3万个小三角形，测试几何阶段和小三角形光栅化
+    void initSphereGridScene(Scene &scene, int width, int height)
+    {
+        setupSyntheticCamera(scene, width, height, Vec3f(0.0f, 6.0f, 10.0f));
+        scene.setLight(Light(Vec3f(3.0f, 8.0f, 4.0f), Vec3f(1.0f), 1.0f, 0.2f));
+        scene.getResourceManager().addResource(makeSphereMesh(24), "bench_sphere");
+        scene.getResourceManager().addResource(makePlaneMesh(), "bench_plane");
+        const std::string red = scene.createMaterialWithTextures("BenchRed", "", "", float3(0.8f, 0.2f, 0.2f), 32.0f);
+        const std::string grey = scene.createMaterialWithTextures("BenchGrey", "", "", float3(0.6f, 0.6f, 0.6f), 8.0f);
+        for (int z = 0; z < 6; ++z)
+        {
+            for (int x = 0; x < 6; ++x)
+            {
+                const Matrix4x4f model = Matrix4x4f::translation(-5.0f + 2.0f * x, 0.0f, -5.0f + 2.0f * z) *
+                                         Matrix4x4f::scaling(0.7f, 0.7f, 0.7f);
+                scene.addObject(SceneObject("sphere_" + std::to_string(z * 6 + x), "bench_sphere", red, model));
+            }
+        }
+        scene.addObject(SceneObject("ground", "bench_plane", grey,
+                                    Matrix4x4f::translation(0.0f, -0.7f, 0.0f) * Matrix4x4f::scaling(7.0f, 1.0f, 7.0f)));
+    }
+
+    // 16层面向相机的大平面：少量三角形、大量片段和深度测试，测试填充率
+    void initOverdrawScene(Scene &scene, int width, int height)
+    {
+        setupSyntheticCamera(scene, width, height, Vec3f(0.0f, 1.0f, 8.0f));
+        scene.setLight(Light(Vec3f(2.0f, 6.0f, 6.0f), Vec3f(1.0f), 1.0f, 0.2f));
+        scene.getResourceManager().addResource(makePlaneMesh(), "bench_plane");
+        const std::string material = scene.createMaterialWithTextures("BenchBlue", "", "", float3(0.3f, 0.4f, 0.8f), 16.0f);
+        for (int layer = 0; layer < 16; ++layer)
+        {
+            // 平面绕X轴转到面向+Z，由远到近排列
+            const Matrix4x4f model = Matrix4x4f::translation(0.0f, 0.0f, -4.0f + 0.5f * layer) *
+                                     Matrix4x4f::rotationX(static_cast<float>(M_PI) / 2.0f) *
+                                     Matrix4x4f::scaling(4.0f, 1.0f, 3.0f);
+            scene.addObject(SceneObject("layer_" + std::to_string(layer), "bench_plane", material, model));
+        }
+    }
+
+    // 球体网格 + 64个点光源：测试分块光源剔除和多光源着色
+    void initPointLightScene(Scene &scene, int width, int height)
+    {
+        initSphereGridScene(scene, width, height);
+        uint32_t seed = 12345u; // 固定种子，保证每次运行的光源一致
+        auto random = [&seed]() {
+            seed = seed * 1664525u + 1013904223u;
+            return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+        };
+        for (int i = 0; i < 64; ++i)
+        {
+            scene.addPointLight(PointLight(Vec3f(random() * 12.0f - 6.0f, -0.5f + random(), random() * 12.0f - 6.0f),
+                                           Vec3f(random(), random(), random()), 2.0f, 1.0f + random() * 1.5f));
+        }
+    }
+}
+
+void BenchPath::apply(Scene &scene, float time) const
+{
+    size_t index;
+    float alpha;
+    if (camera.size() >= 2)
+    {
+        findSegment(camera, time, index, alpha);
+        scene.getCamera().setPosition(lerp(camera[index].position, camera[index + 1].position, alpha));
+        scene.getCamera().setTarget(lerp(camera[index].target, camera[index + 1].target, alpha));
+    }
+    if (light.size() >= 2)
+    {
+        findSegment(light, time, index, alpha);
+        Light sceneLight = scene.getLight();
+        sceneLight.position = lerp(light[index].position, light[index + 1].position, alpha);
+        scene.setLight(sceneLight);
+    }
+}
+
+BenchPath makeOrbitPath(const Scene &scene)
+{
+    constexpr int KEY_COUNT = 8;
+    BenchPath path;
+    const Vec3f target = scene.getCamera().getTarget();
+    const Vec3f offset = scene.getCamera().getPosition() - target;
+    const float radius = std::sqrt(offset.x * offset.x + offset.z * offset.z);
+    const float startAngle = std::atan2(offset.z, offset.x);
+
+    const Vec3f lightPosition = scene.getLight().position;
+    const float lightRadius = std::sqrt(lightPosition.x * lightPosition.x + lightPosition.z * lightPosition.z);
+    const float lightAngle = std::atan2(lightPosition.z, lightPosition.x);
+
+    for (int i = 0; i <= KEY_COUNT; ++i)
+    {
+        const float time = static_cast<float>(i) / KEY_COUNT;
+        const float angle = startAngle + 2.0f * static_cast<float>(M_PI) * time;
+        const float dolly = 1.0f - 0.3f * std::sin(static_cast<float>(M_PI) * time);
+        path.camera.push_back({time,
+                               Vec3f(target.x + radius * dolly * std::cos(angle),
+                                     target.y + offset.y * dolly,
+                                     target.z + radius * dolly * std::sin(angle)),
+                               target});
+
+        const float angleL = lightAngle + static_cast<float>(M_PI) * time;
+        path.light.push_back({time, Vec3f(lightRadius * std::cos(angleL), lightPosition.y, lightRadius * std::sin(angleL))});
+    }
+    return path;
+}
+
+const std::vector<BenchSceneDesc> &benchScenes()
+{
+    static const std::vector<BenchSceneDesc> scenes = {
+        {"sphere_grid", initSphereGridScene},
+        {"overdraw", initOverdrawScene},
+        {"point_lights", initPointLightScene},
+        // 以下场景需要 ../assets 下的模型和纹理
+        {"default", [](Scene &scene, int w, int h) { SceneManager().initializeScene(SceneType::DEFAULT, scene, w, h); }},
+        {"spheres", [](Scene &scene, int w, int h) { SceneManager().initializeScene(SceneType::SPHERES, scene, w, h); }},
+        {"cubes", [](Scene &scene, int w, int h) { SceneManager().initializeScene(SceneType::CUBES, scene, w, h); }},
+    };
+    return scenes;
+}
+
+const BenchSceneDesc *findBenchScene(const std::string &name)
+{
+    for (const BenchSceneDesc &desc : benchScenes())
+    {
+        if (name == desc.name)
+        {
+            return &desc;
+        }
+    }
+    return nullptr;
+}
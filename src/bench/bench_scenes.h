@@ -0,0 +1,51 @@
+#pragma once
+// bench_scenes.h
+// 基准测试和回归检查共用的命名场景与相机/光源关键帧路径
+
+#include "scene.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+//--------------------
+// 关键帧路径
+//--------------------
+struct CameraKey
+{
+    float time; // 归一化时间[0, 1]
+    Vec3f position;
+    Vec3f target;
+};
+
+struct LightKey
+{
+    float time;
+    Vec3f position;
+};
+
+// 场景的相机和光源动画，关键帧之间线性插值
+struct BenchPath
+{
+    std::vector<CameraKey> camera;
+    std::vector<LightKey> light;
+
+    void apply(Scene &scene, float time) const;
+};
+
+// 由场景的初始相机和光源生成路径：相机绕目标点环绕一周并在中途拉近，光源绕竖直轴转半周
+BenchPath makeOrbitPath(const Scene &scene);
+
+//--------------------
+// 命名场景
+//--------------------
+struct BenchSceneDesc
+{
+    const char *name;
+    std::function<void(Scene &, int, int)> init;
+};
+
+// 所有命名场景：合成场景（sphere_grid, overdraw, point_lights）不依赖资源文件，
+// 资源场景（default, spheres, cubes）需要 ../assets 下的模型和纹理
+const std::vector<BenchSceneDesc> &benchScenes();
+// 按名称查找场景，不存在时返回nullptr
+const BenchSceneDesc *findBenchScene(const std::string &name);
@@ -0,0 +1,728 @@
+// kernel_bench.cpp
+// 热点kernel的微基准测试：固定的合成输入，逐kernel报告吞吐量，不受整帧噪声影响
+
+#include "renderer.h"
+#include "simd_dispatch.h"
+#include "texture.h"
+#include "texture_sampler.h"
+#include "shader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // 阻止编译器把基准循环的结果优化掉
+    template <typename T>
+    inline void doNotOptimize(const T &value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T *sink;
+        sink = &value;
+#endif
+    }
+
+    // 固定种子的线性同余随机数，保证每次运行的输入相同
+    class Random
+    {
+    public:
+        explicit Random(uint32_t seed) : state(seed) {}
+        float next()
+        {
+            state = state * 1664525u + 1013904223u;
+            return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+        }
+        float range(float low, float high) { return low + (high - low) * next(); }
+
+    private:
+        uint32_t state;
+    };
+
+    struct KernelResult
+    {
+        std::string name;
+        std::string params;
+        long long iterations = 0; // 调用batch的次数
+        double nsPerOp = 0.0;     // 每个操作的耗时
+        double opsPerSecond = 0.0;
+        const char *unit = "op";  // 操作单位（像素、采样、调用等）
+        const char *simd = "";    // 测量时的kernel指令集级别
+    };
+
+    struct BenchOptions
+    {
+        std::string filter;     // 只运行名称包含该子串的kernel
+        double minTimeMs = 200; // 每次测量的最短时间
+        int repetitions = 3;    // 取最快的一次
+        std::string output;     // JSON结果文件，为空时只打印表格
+        std::vector<SimdLevel> simdLevels; // 依次测量的指令集级别，为空时使用自动选择的级别
+    };
+
+    /**
+     * 重复调用batch直到累计时间超过minTimeMs，重复repetitions次取最快的结果
+     * batch每次调用执行opsPerBatch个操作
+     */
+    KernelResult measure(const BenchOptions &options, const std::string &name, const std::string &params,
+                         const char *unit, double opsPerBatch, const std::function<void()> &batch)
+    {
+        using clock = std::chrono::steady_clock;
+        batch(); // 预热
+
+        KernelResult result;
+        result.name = name;
+        result.params = params;
+        result.unit = unit;
+        result.simd = getSimdLevelName(getSimdLevel());
+        double best = 0.0;
+        for (int rep = 0; rep < options.repetitions; ++rep)
+        {
+            long long iterations = 0;
+            const auto start = clock::now();
+            double elapsedMs = 0.0;
+            do
+            {
+                batch();
+                ++iterations;
+                elapsedMs = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+            } while (elapsedMs < options.minTimeMs);
+
+            const double nsPerOp = elapsedMs * 1.0e6 / (iterations * opsPerBatch);
+            if (rep == 0 || nsPerOp < best)
+            {
+                best = nsPerOp;
+                result.iterations = iterations;
+            }
+        }
+        result.nsPerOp = best;
+        result.opsPerSecond = best > 0.0 ? 1.0e9 / best : 0.0;
+        return result;
+    }
+}
+
+/**
+ * 直接调用渲染器内部kernel（Renderer中声明为友元）
+ */
+class KernelBench
+{
+public:
+    explicit KernelBench(const BenchOptions &options) : options(options) {}
+
+    void run()
+    {
+        benchTraverseTriangleBlock();
+        benchCoverageRow();
+        benchDepthRow();
+        benchTransformPositions();
+        benchFillFloat();
+        benchComputeBarycentric2D();
+        benchInterpolateVaryings();
+        benchSampleBilinear();
+        benchMatrixMultiply();
+        benchFrameBufferClear();
+        benchCopyToPlatform();
+    }
+
+    const std::vector<KernelResult> &getResults() const { return results; }
+
+private:
+    const BenchOptions &options;
+    std::vector<KernelResult> results;
+
+    bool enabled(const std::string &name) const
+    {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    void add(const KernelResult &result)
+    {
+        std::cout << std::left << std::setw(28) << result.name << std::setw(34) << result.params
+                  << std::right << std::fixed << std::setprecision(2) << std::setw(12) << result.nsPerOp << " ns/"
+                  << std::left << std::setw(8) << result.unit
+                  << std::right << std::setw(12) << result.opsPerSecond / 1.0e6 << " M" << result.unit << "/s"
+                  << std::endl;
+        results.push_back(result);
+    }
+
+    // 单位矩阵MVP：顶点位置即NDC坐标
+    static ShaderUniforms identityUniforms()
+    {
+        ShaderUniforms uniforms;
+        uniforms.modelMatrix = Matrix4x4f::identity();
+        uniforms.viewMatrix = Matrix4x4f::identity();
+        uniforms.projMatrix = Matrix4x4f::identity();
+        uniforms.mvpMatrix = Matrix4x4f::identity();
+        uniforms.normalMatrix = Matrix4x4f::identity();
+        return uniforms;
+    }
+
+    // 随机生成屏幕面积约为targetArea像素的三角形
+    static std::vector<Triangle> makeTriangles(int count, float targetArea, int width, int height, uint32_t seed)
+    {
+        Random random(seed);
+        std::vector<Triangle> triangles;
+        triangles.reserve(count);
+        const float4 color(0.8f, 0.5f, 0.2f, 1.0f);
+        const Vec3f normal(0.0f, 0.0f, 1.0f);
+        // 等腰直角三角形的面积为 edge^2 / 2
+        const float edge = std::sqrt(2.0f * targetArea);
+        for (int i = 0; i < count; ++i)
+        {
+            const float cx = random.range(edge, std::max(edge, width - edge));
+            const float cy = random.range(edge, std::max(edge, height - edge));
+            const float angle = random.range(0.0f, 2.0f * static_cast<float>(M_PI));
+            const float depth = random.range(-0.9f, 0.9f);
+            auto toNdc = [&](float dx, float dy) {
+                const float x = cx + dx * std::cos(angle) - dy * std::sin(angle);
+                const float y = cy + dx * std::sin(angle) + dy * std::cos(angle);
+                return Vec3f(2.0f * x / width - 1.0f, 1.0f - 2.0f * y / height, depth);
+            };
+            triangles.push_back(Triangle(Vertex(toNdc(0.0f, 0.0f), normal, Vec2f(0.0f, 0.0f), color),
+                                         Vertex(toNdc(edge, 0.0f), normal, Vec2f(1.0f, 0.0f), color),
+                                         Vertex(toNdc(0.0f, edge), normal, Vec2f(0.0f, 1.0f), color)));
+        }
+        return triangles;
+    }
+
+    // 三角形遍历：按16x16的块调用traverseTriangleBlock（与并行遍历路径相同的块划分，但在单线程上执行）
+    void benchTraverseTriangleBlock()
+    {
+        if (!enabled("traverseTriangleBlock"))
+        {
+            return;
+        }
+        constexpr int WIDTH = 800, HEIGHT = 450, BLOCK_SIZE = 16;
+        const struct
+        {
+            const char *label;
+            float area;
+            int count;
+        } distributions[] = {{"tiny(8px)", 8.0f, 4096}, {"small(64px)", 64.0f, 2048},
+                             {"medium(1k px)", 1024.0f, 256}, {"large(32k px)", 32768.0f, 16}};
+
+        Renderer renderer(WIDTH, HEIGHT);
+        std::shared_ptr<IShader> shader = createBasicShader();
+        const ShaderUniforms uniforms = identityUniforms();
+        shader->setUniforms(uniforms);
+
+        for (const auto &distribution : distributions)
+        {
+            std::vector<TriangleSetupData> setups;
+            for (Triangle triangle : makeTriangles(distribution.count, distribution.area, WIDTH, HEIGHT, 7u))
+            {
+                TriangleSetupData setup = renderer.setupTriangle(triangle, shader);
+                if (!setup.valid)
+                {
+                    // 被背面剔除时交换顶点顺序
+                    std::swap(triangle.vertices[1], triangle.vertices[2]);
+                    setup = renderer.setupTriangle(triangle, shader);
+                }
+                if (setup.valid)
+                {
+                    setups.push_back(setup);
+                }
+            }
+
+            double pixels = 0.0;
+            for (const TriangleSetupData &setup : setups)
+            {
+                pixels += static_cast<double>(setup.maxX - setup.minX + 1) * (setup.maxY - setup.minY + 1);
+            }
+
+            // 每个batch先清除（延迟清除只标记tile），深度测试结果在各次迭代间保持一致
+            add(measure(options, "traverseTriangleBlock", distribution.label, "px", pixels, [&]() {
+                renderer.frameBuffer->clear();
+                for (const TriangleSetupData &setup : setups)
+                {
+                    for (int blockY = setup.minY; blockY <= setup.maxY; blockY += BLOCK_SIZE)
+                    {
+                        for (int blockX = setup.minX; blockX <= setup.maxX; blockX += BLOCK_SIZE)
+                        {
+                            renderer.traverseTriangleBlock(setup, blockX, blockY,
+                                                           std::min(blockX + BLOCK_SIZE - 1, setup.maxX),
+                                                           std::min(blockY + BLOCK_SIZE - 1, setup.maxY), shader);
+                        }
+                    }
+                }
+            }));
+        }
+    }
+
+    // 以下四个直接调用当前指令集级别的SIMD kernel（simd_dispatch.h）
+    // 覆盖测试：一行边函数值的覆盖掩码，边与行斜交，约一半像素被覆盖
+    void benchCoverageRow()
+    {
+        if (!enabled("coverageRow"))
+        {
+            return;
+        }
+        constexpr int ROWS = 64;
+        const SimdKernels &kernels = simdKernels();
+        const float dx[3] = {0.7f, -0.4f, -0.3f};
+        const float dy[3] = {-0.5f, 0.8f, -0.3f};
+        const float c[3] = {8.0f, -2.0f, 120.0f};
+        for (int width : {16, 256})
+        {
+            std::vector<uint8_t> mask(width);
+            const std::string params = std::to_string(width) + " px rows";
+            add(measure(options, "coverageRow", params + " incremental", "px", static_cast<double>(width) * ROWS, [&]() {
+                int covered = 0;
+                for (int y = 0; y < ROWS; ++y)
+                {
+                    const float start[3] = {dx[0] * y + c[0], dx[1] * y + c[1], dx[2] * y + c[2]};
+                    covered += kernels.coverageRow(start, dy, 0, width, mask.data());
+                }
+                doNotOptimize(covered);
+            }));
+            add(measure(options, "coverageRow", params + " direct", "px", static_cast<double>(width) * ROWS, [&]() {
+                int covered = 0;
+                for (int y = 0; y < ROWS; ++y)
+                {
+                    covered += kernels.coverageRowDirect(dx, dy, c, 0, y, width, mask.data());
+                }
+                doNotOptimize(covered);
+            }));
+        }
+    }
+
+    // 仅深度光栅化的行：覆盖测试 + 深度比较和写入
+    void benchDepthRow()
+    {
+        if (!enabled("depthRow"))
+        {
+            return;
+        }
+        constexpr int ROWS = 64;
+        const SimdKernels &kernels = simdKernels();
+        const float dy[3] = {-0.5f, 0.8f, -0.3f};
+        for (int width : {16, 256, 1024})
+        {
+            std::vector<float> depth(static_cast<size_t>(width) * ROWS, 1.0f);
+            add(measure(options, "depthRow", std::to_string(width) + " px rows", "px", static_cast<double>(width) * ROWS, [&]() {
+                for (int y = 0; y < ROWS; ++y)
+                {
+                    const float start[3] = {0.7f * y + 8.0f, -0.4f * y + 0.25f * width, 120.0f};
+                    kernels.depthRow(start, dy, 0.5f - 0.001f * y, 1.0e-4f, width, depth.data() + static_cast<size_t>(y) * width);
+                }
+                doNotOptimize(depth.front());
+            }));
+        }
+    }
+
+    // 顶点位置变换：Triangle中的顶点按sizeof(Vertex)的步长读取
+    void benchTransformPositions()
+    {
+        if (!enabled("transformPositions"))
+        {
+            return;
+        }
+        constexpr int TRIANGLES = 1024;
+        const SimdKernels &kernels = simdKernels();
+        const std::vector<Triangle> triangles = makeTriangles(TRIANGLES, 64.0f, 800, 450, 23u);
+        const Matrix4x4f matrix = Matrix4x4f::perspective(1.0f, 16.0f / 9.0f, 0.1f, 100.0f) *
+                                  Matrix4x4f::translation(0.1f, -0.2f, -3.0f);
+        std::vector<float> out(static_cast<size_t>(TRIANGLES) * 3 * 4);
+        add(measure(options, "transformPositions", "mat4 x vertex, 3072 vertices", "vertex", TRIANGLES * 3.0, [&]() {
+            kernels.transformPositions(matrix.m, &triangles[0].vertices[0].position.x, sizeof(Vertex) / sizeof(float),
+                                       triangles.size() * 3, out.data());
+            doNotOptimize(out.front());
+        }));
+    }
+
+    // 深度目标清除
+    void benchFillFloat()
+    {
+        if (!enabled("fillFloat"))
+        {
+            return;
+        }
+        const SimdKernels &kernels = simdKernels();
+        for (int size : {512, 2048})
+        {
+            std::vector<float> target(static_cast<size_t>(size) * size);
+            add(measure(options, "fillFloat", std::to_string(size) + "x" + std::to_string(size) + " depth", "px",
+                        static_cast<double>(target.size()), [&]() {
+                kernels.fillFloat(target.data(), target.size(), 1.0f);
+                doNotOptimize(target.front());
+            }));
+        }
+    }
+
+    void benchComputeBarycentric2D()
+    {
+        if (!enabled("computeBarycentric2D"))
+        {
+            return;
+        }
+        constexpr int COUNT = 4096;
+        Renderer renderer(64, 64);
+        Random random(11u);
+        const std::array<Vec3f, 3> triangle = {Vec3f(3.0f, 5.0f, 0.1f), Vec3f(60.0f, 9.0f, 0.2f), Vec3f(20.0f, 58.0f, 0.3f)};
+        std::vector<Vec2f> points(COUNT);
+        for (Vec2f &point : points)
+        {
+            point = Vec2f(random.range(0.0f, 64.0f), random.range(0.0f, 64.0f));
+        }
+
+        add(measure(options, "computeBarycentric2D", "4096 points", "call", COUNT, [&]() {
+            Vec3f sum(0.0f);
+            for (const Vec2f &point : points)
+            {
+                sum = sum + renderer.computeBarycentric2D(point.x, point.y, triangle);
+            }
+            doNotOptimize(sum);
+        }));
+    }
+
+    void benchInterpolateVaryings()
+    {
+        if (!enabled("interpolateVaryings"))
+        {
+            return;
+        }
+        constexpr int COUNT = 4096;
+        Renderer renderer(64, 64);
+        Random random(13u);
+
+        std::array<ProcessedVertex, 3> vertices;
+        for (ProcessedVertex &vertex : vertices)
+        {
+            vertex.clipPosition = Vec4f(random.next(), random.next(), random.next(), 0.5f + random.next());
+            vertex.screenPosition = Vec3f(random.range(0.0f, 64.0f), random.range(0.0f, 64.0f), random.next());
+            vertex.varying.position = float3(random.next(), random.next(), random.next());
+            vertex.varying.normal = float3(random.next(), random.next(), random.next());
+            vertex.varying.tangent = float4(random.next(), random.next(), random.next(), 1.0f);
+            vertex.varying.texCoord = Vec2f(random.next(), random.next());
+            vertex.varying.color = float4(random.next(), random.next(), random.next(), 1.0f);
+            vertex.varying.positionLightSpace = float4(random.next(), random.next(), random.next(), 1.0f);
+        }
+        const std::array<Varyings, 3> varyings = {vertices[0].varying, vertices[1].varying, vertices[2].varying};
+
+        std::vector<Vec3f> barycentrics(COUNT);
+        for (Vec3f &barycentric : barycentrics)
+        {
+            const float a = random.next(), b = random.next() * (1.0f - a);
+            barycentric = Vec3f(a, b, 1.0f - a - b);
+        }
+
+        add(measure(options, "interpolateVaryings", "perspective, 4096 frags", "call", COUNT, [&]() {
+            Varyings output;
+            float sum = 0.0f;
+            for (const Vec3f &barycentric : barycentrics)
+            {
+                const Vec4f weights = renderer.calculatePerspectiveWeights(barycentric, vertices);
+                renderer.interpolateVaryings(output, varyings, barycentric, weights, 0.5f);
+                sum += output.texCoord.x;
+            }
+            doNotOptimize(sum);
+        }));
+    }
+
+    // 双线性采样：通过sampleLevel的整数级别进入sampleBilinear，扫描线顺序（相干）和随机顺序两种访问模式
+    void benchSampleBilinear()
+    {
+        if (!enabled("sampleBilinear"))
+        {
+            return;
+        }
+        constexpr int COUNT = 4096;
+        const struct
+        {
+            const char *label;
+            TextureFormat format;
+        } formats[] = {{"RGBA8", TextureFormat::R8G8B8A8_UNORM}, {"RGB8", TextureFormat::R8G8B8_UNORM},
+                       {"RGBA32F", TextureFormat::R32G32B32A32_FLOAT}};
+        const int sizes[] = {64, 512, 2048};
+        const struct
+        {
+            const char *label;
+            const SamplerState *state;
+        } samplers[] = {{"repeat", &SamplerState::LINEAR_REPEAT}, {"clamp", &SamplerState::LINEAR_CLAMP}};
+
+        Random random(17u);
+        std::vector<float2> coherent(COUNT), scattered(COUNT);
+        for (int i = 0; i < COUNT; ++i)
+        {
+            // 相干：64x64的一块连续像素，相邻采样落在相邻纹素附近
+            coherent[i] = float2((i % 64) / 256.0f, (i / 64) / 256.0f);
+            scattered[i] = float2(random.range(-1.0f, 2.0f), random.range(-1.0f, 2.0f));
+        }
+
+        for (const auto &format : formats)
+        {
+            for (int size : sizes)
+            {
+                auto texture = textures::createTexture(size, size, format.format);
+                if (!texture)
+                {
+                    continue;
+                }
+                for (int y = 0; y < size; ++y)
+                {
+                    for (int x = 0; x < size; ++x)
+                    {
+                        texture->write(x, y, float4((x & 255) / 255.0f, (y & 255) / 255.0f, ((x ^ y) & 255) / 255.0f, 1.0f));
+                    }
+                }
+
+                for (const auto &sampler : samplers)
+                {
+                    for (int pattern = 0; pattern < 2; ++pattern)
+                    {
+                        const std::vector<float2> &uvs = pattern == 0 ? coherent : scattered;
+                        const std::string params = std::string(format.label) + " " + std::to_string(size) + " " +
+                                                   sampler.label + (pattern == 0 ? " coherent" : " random");
+                        add(measure(options, "sampleBilinear", params, "sample", COUNT, [&]() {
+                            float4 sum(0.0f);
+                            for (const float2 &uv : uvs)
+                            {
+                                sum = sum + TextureSampler::sampleLevel(texture.get(), uv, 0.0f, *sampler.state);
+                            }
+                            doNotOptimize(sum);
+                        }));
+                    }
+                }
+            }
+        }
+    }
+
+    void benchMatrixMultiply()
+    {
+        if (!enabled("Matrix4x4::operator*"))
+        {
+            return;
+        }
+        constexpr int COUNT = 1024;
+        Random random(19u);
+        std::vector<Matrix4x4f> matrices(COUNT);
+        std::vector<Vec4f> vectors(COUNT);
+        for (int i = 0; i < COUNT; ++i)
+        {
+            matrices[i] = Matrix4x4f::translation(random.next(), random.next(), random.next()) *
+                          Matrix4x4f::rotationY(random.range(0.0f, 6.28f)) *
+                          Matrix4x4f::scaling(0.5f + random.next(), 0.5f + random.next(), 0.5f + random.next());
+            vectors[i] = Vec4f(random.next(), random.next(), random.next(), 1.0f);
+        }
+
+        add(measure(options, "Matrix4x4::operator*", "mat4 x mat4", "call", COUNT, [&]() {
+            Matrix4x4f product = Matrix4x4f::identity();
+            for (const Matrix4x4f &matrix : matrices)
+            {
+                product = matrix * product;
+            }
+            doNotOptimize(product);
+        }));
+        add(measure(options, "Matrix4x4::operator*", "mat4 x vec4", "call", COUNT, [&]() {
+            Vec4f sum(0.0f);
+            for (int i = 0; i < COUNT; ++i)
+            {
+                sum = sum + matrices[i] * vectors[i];
+            }
+            doNotOptimize(sum);
+        }));
+    }
+
+    static const char *layoutName(FrameBufferLayout layout)
+    {
+        return layout == FrameBufferLayout::TILED ? "tiled" : "linear";
+    }
+
+    // 清除：延迟清除只标记tile；clear+touch在每个tile写入一个像素，计入tile的实际初始化
+    void benchFrameBufferClear()
+    {
+        if (!enabled("FrameBuffer::clear"))
+        {
+            return;
+        }
+        const int sizes[][2] = {{800, 450}, {1920, 1080}};
+        for (const auto &size : sizes)
+        {
+            for (FrameBufferLayout layout : {FrameBufferLayout::LINEAR, FrameBufferLayout::TILED})
+            {
+                for (bool msaa : {false, true})
+                {
+                    FrameBuffer frameBuffer(size[0], size[1], layout);
+                    frameBuffer.enableMSAA(msaa);
+                    const double pixels = static_cast<double>(size[0]) * size[1];
+                    const std::string params = std::to_string(size[0]) + "x" + std::to_string(size[1]) + " " +
+                                               layoutName(layout) + (msaa ? " msaa" : "");
+                    add(measure(options, "FrameBuffer::clear", params, "px", pixels, [&]() {
+                        frameBuffer.clear(Vec4f(0.1f, 0.2f, 0.3f, 1.0f));
+                    }));
+                    add(measure(options, "FrameBuffer::clear+touch", params, "px", pixels, [&]() {
+                        frameBuffer.clear(Vec4f(0.1f, 0.2f, 0.3f, 1.0f));
+                        for (int y = 0; y < size[1]; y += FrameBuffer::TILE_SIZE)
+                        {
+                            for (int x = 0; x < size[0]; x += FrameBuffer::TILE_SIZE)
+                            {
+                                frameBuffer.setPixel(x, y, 0.5f, Vec4f(1.0f));
+                            }
+                        }
+                    }));
+                }
+            }
+        }
+    }
+
+    // 复制到平台格式：所有tile已写入（纯复制/展开）和所有tile待清除（直接填充清除色）两种情况
+    void benchCopyToPlatform()
+    {
+        if (!enabled("copyToPlatform"))
+        {
+            return;
+        }
+        const int sizes[][2] = {{800, 450}, {1920, 1080}};
+        for (const auto &size : sizes)
+        {
+            std::vector<uint32_t> destination(static_cast<size_t>(size[0]) * size[1]);
+            for (FrameBufferLayout layout : {FrameBufferLayout::LINEAR, FrameBufferLayout::TILED})
+            {
+                FrameBuffer frameBuffer(size[0], size[1], layout);
+                const double pixels = static_cast<double>(size[0]) * size[1];
+                const std::string base = std::to_string(size[0]) + "x" + std::to_string(size[1]) + " " + layoutName(layout);
+
+                frameBuffer.clear(Vec4f(0.1f, 0.2f, 0.3f, 1.0f));
+                for (int y = 0; y < size[1]; y += FrameBuffer::TILE_SIZE)
+                {
+                    for (int x = 0; x < size[0]; x += FrameBuffer::TILE_SIZE)
+                    {
+                        frameBuffer.setPixel(x, y, 0.5f, Vec4f(1.0f));
+                    }
+                }
+                add(measure(options, "copyToPlatform", base + " written", "px", pixels, [&]() {
+                    frameBuffer.copyToPlatform(destination.data());
+                    doNotOptimize(destination.front());
+                }));
+
+                frameBuffer.clear(Vec4f(0.1f, 0.2f, 0.3f, 1.0f));
+                add(measure(options, "copyToPlatform", base + " cleared", "px", pixels, [&]() {
+                    frameBuffer.copyToPlatform(destination.data());
+                    doNotOptimize(destination.front());
+                }));
+            }
+        }
+    }
+};
+
+namespace
+{
+    void printHelp()
+    {
+        std::cout << "kernel_bench 热点kernel微基准测试" << std::endl;
+        std::cout << "  --filter=<name>   只运行名称包含该子串的kernel" << std::endl;
+        std::cout << "  --min-time=<ms>   每次测量的最短时间 (默认: 200)" << std::endl;
+        std::cout << "  --repetitions=<n> 重复测量次数，取最快的一次 (默认: 3)" << std::endl;
+        std::cout << "  --output=<file>   同时保存JSON结果" << std::endl;
+        std::cout << "  --simd=<levels>   依次使用的kernel指令集级别，逗号分隔或all (baseline, sse4.2, avx2, avx512；默认: 自动选择)" << std::endl;
+    }
+
+    void writeJson(std::ostream &out, const std::vector<KernelResult> &results)
+    {
+        out << std::fixed << std::setprecision(4);
+        out << "{\n  \"benchmark\": \"kernel_bench\",\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const KernelResult &result = results[i];
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    {\"kernel\": \"" << result.name << "\", \"params\": \"" << result.params
+                << "\", \"simd\": \"" << result.simd
+                << "\", \"unit\": \"" << result.unit << "\", \"iterations\": " << result.iterations
+                << ", \"ns_per_op\": " << result.nsPerOp << ", \"ops_per_second\": " << result.opsPerSecond << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help")
+        {
+            printHelp();
+            return 0;
+        }
+        else if (arg.find("--filter=") == 0)
+        {
+            options.filter = arg.substr(9);
+        }
+        else if (arg.find("--min-time=") == 0)
+        {
+            options.minTimeMs = std::max(1.0, std::atof(arg.substr(11).c_str()));
+        }
+        else if (arg.find("--repetitions=") == 0)
+        {
+            options.repetitions = std::max(1, std::atoi(arg.substr(14).c_str()));
+        }
+        else if (arg.find("--output=") == 0)
+        {
+            options.output = arg.substr(9);
+        }
+        else if (arg.find("--simd=") == 0)
+        {
+            // 只保留CPU支持的级别，用于比较同一台机器上各级别的kernel
+            std::stringstream list(arg.substr(7));
+            std::string name;
+            while (std::getline(list, name, ','))
+            {
+                SimdLevel level;
+                if (name == "all")
+                {
+                    for (int i = 0; i <= static_cast<int>(getMaxSimdLevel()); ++i)
+                    {
+                        options.simdLevels.push_back(static_cast<SimdLevel>(i));
+                    }
+                }
+                else if (parseSimdLevel(name.c_str(), level))
+                {
+                    options.simdLevels.push_back(level);
+                }
+                else
+                {
+                    std::cerr << "未知的指令集级别: " << name << std::endl;
+                    return 1;
+                }
+            }
+        }
+        else
+        {
+            std::cerr << "未知参数: " << arg << std::endl;
+            printHelp();
+            return 1;
+        }
+    }
+
+    if (options.simdLevels.empty())
+    {
+        options.simdLevels.push_back(getSimdLevel());
+    }
+    KernelBench bench(options);
+    for (SimdLevel level : options.simdLevels)
+    {
+        std::cout << "[SIMD] " << getSimdLevelName(setSimdLevel(level)) << std::endl;
+        bench.run();
+    }
+
+    if (!options.output.empty())
+    {
+        std::ofstream file(options.output);
+        if (!file)
+        {
+            std::cerr << "无法创建文件：" << options.output << std::endl;
+            return 1;
+        }
+        writeJson(file, bench.getResults());
+    }
+    return 0;
+}
@@ -0,0 +1,354 @@
+// render_bench.cpp
+// 确定性基准测试：按固定的相机和光源关键帧路径渲染命名场景，扫描MSAA/阴影/线程数，输出JSON结果
+
+#include "bench_scenes.h"
+#include "job_system.h"
+#include "simd_dispatch.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    //--------------------
+    // 参数与结果
+    //--------------------
+    struct BenchOptions
+    {
+        std::vector<std::string> scenes = {"sphere_grid", "overdraw", "point_lights"};
+        std::vector<int> msaa = {0, 1};
+        std::vector<int> shadow = {0, 1};
+        std::vector<int> threads; // 为空时使用当前工作者数
+        int width = 800;
+        int height = 450;
+        int frames = 120;
+        int warmup = 5;
+        bool pipeline = false;
+        std::string output; // 为空时输出到标准输出
+    };
+
+    struct BenchResult
+    {
+        std::string scene;
+        bool msaa = false;
+        bool shadow = false;
+        int threads = 0;
+        std::vector<double> frameMs;
+        std::vector<FrameStats> stats;
+        double totalMs = 0.0;
+    };
+
+    std::vector<std::string> splitList(const std::string &value)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream(value);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    std::vector<int> splitIntList(const std::string &value)
+    {
+        std::vector<int> items;
+        for (const std::string &item : splitList(value))
+        {
+            items.push_back(std::atoi(item.c_str()));
+        }
+        return items;
+    }
+
+    void printHelp()
+    {
+        std::cout << "render_bench 确定性渲染基准测试" << std::endl;
+        std::cout << "  --scenes=<a,b>    场景列表 (默认: sphere_grid,overdraw,point_lights)" << std::endl;
+        std::cout << "                    可选: sphere_grid, overdraw, point_lights, default, spheres, cubes" << std::endl;
+        std::cout << "  --msaa=<0,1>      扫描的MSAA设置 (默认: 0,1)" << std::endl;
+        std::cout << "  --shadow=<0,1>    扫描的阴影设置 (默认: 0,1)" << std::endl;
+        std::cout << "  --threads=<n,..>  扫描的工作者数 (默认: SR_WORKER_THREADS或硬件线程数)" << std::endl;
+        std::cout << "  --frames=<n>      每个配置计时的帧数 (默认: 120)" << std::endl;
+        std::cout << "  --warmup=<n>      每个配置的预热帧数 (默认: 5)" << std::endl;
+        std::cout << "  --size=<WxH>      渲染分辨率 (默认: 800x450)" << std::endl;
+        std::cout << "  --pipeline=<0|1>  启用帧流水线 (默认: 0)" << std::endl;
+        std::cout << "  --simd=<level>    kernel指令集级别 (baseline, sse4.2, avx2, avx512；默认: CPU支持的最高级别)" << std::endl;
+        std::cout << "  --output=<file>   JSON结果文件 (默认: 标准输出，加载和进度日志输出到标准错误)" << std::endl;
+    }
+
+    bool parseCommandLine(int argc, char *argv[], BenchOptions &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help")
+            {
+                printHelp();
+                std::exit(0);
+            }
+            else if (arg.find("--scenes=") == 0)
+            {
+                options.scenes = splitList(arg.substr(9));
+            }
+            else if (arg.find("--msaa=") == 0)
+            {
+                options.msaa = splitIntList(arg.substr(7));
+            }
+            else if (arg.find("--shadow=") == 0)
+            {
+                options.shadow = splitIntList(arg.substr(9));
+            }
+            else if (arg.find("--threads=") == 0)
+            {
+                options.threads = splitIntList(arg.substr(10));
+            }
+            else if (arg.find("--frames=") == 0)
+            {
+                options.frames = std::max(1, std::atoi(arg.substr(9).c_str()));
+            }
+            else if (arg.find("--warmup=") == 0)
+            {
+                options.warmup = std::max(0, std::atoi(arg.substr(9).c_str()));
+            }
+            else if (arg.find("--size=") == 0)
+            {
+                if (std::sscanf(arg.c_str() + 7, "%dx%d", &options.width, &options.height) != 2 ||
+                    options.width <= 0 || options.height <= 0)
+                {
+                    std::cerr << "无效的分辨率: " << arg << std::endl;
+                    return false;
+                }
+            }
+            else if (arg.find("--pipeline=") == 0)
+            {
+                options.pipeline = arg.substr(11) == "1";
+            }
+            else if (arg.find("--output=") == 0)
+            {
+                options.output = arg.substr(9);
+            }
+            else if (arg.find("--simd=") == 0)
+            {
+                SimdLevel level;
+                if (!parseSimdLevel(arg.c_str() + 7, level))
+                {
+                    std::cerr << "未知的指令集级别: " << arg << std::endl;
+                    return false;
+                }
+                setSimdLevel(level);
+            }
+            else
+            {
+                std::cerr << "未知参数: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 渲染一个配置：场景每次重新创建，保证各配置从相同的初始状态开始
+    BenchResult runConfiguration(const BenchSceneDesc &desc, bool msaa, bool shadow, int threads,
+                                 const BenchOptions &options)
+    {
+        BenchResult result;
+        result.scene = desc.name;
+        result.msaa = msaa;
+        result.shadow = shadow;
+
+        JobSystem::getInstance().setWorkerCount(threads);
+        result.threads = JobSystem::getInstance().getWorkerCount();
+
+        Renderer renderer(options.width, options.height);
+        renderer.enableMSAA(msaa);
+        renderer.enableStatistics(true);
+        renderer.enableFramePipelining(options.pipeline);
+
+        Scene scene;
+        desc.init(scene, options.width, options.height);
+        scene.setupShadowMapping(shadow);
+        const BenchPath path = makeOrbitPath(scene);
+
+        // 预热：相机停在路径起点，填充缓存和工作线程
+        for (int frame = 0; frame < options.warmup; ++frame)
+        {
+            path.apply(scene, 0.0f);
+            scene.render(renderer);
+        }
+        renderer.finishFrame();
+
+        using clock = std::chrono::steady_clock;
+        result.frameMs.reserve(options.frames);
+        result.stats.reserve(options.frames);
+        const auto startTime = clock::now();
+        for (int frame = 0; frame < options.frames; ++frame)
+        {
+            const float time = options.frames > 1 ? static_cast<float>(frame) / (options.frames - 1) : 0.0f;
+            path.apply(scene, time);
+            const auto frameStart = clock::now();
+            scene.render(renderer);
+            result.frameMs.push_back(std::chrono::duration<double, std::milli>(clock::now() - frameStart).count());
+
+            // 流水线模式下Scene::render返回时上一帧才完成光栅化，统计数据滞后一帧
+            if (!options.pipeline || frame > 0)
+            {
+                result.stats.push_back(renderer.getLastFrameStats());
+            }
+        }
+        renderer.finishFrame();
+        if (options.pipeline)
+        {
+            result.stats.push_back(renderer.getLastFrameStats());
+        }
+        result.totalMs = std::chrono::duration<double, std::milli>(clock::now() - startTime).count();
+        return result;
+    }
+
+    // 最近秩百分位数
+    double percentile(std::vector<double> sorted, double p)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    void writeJson(std::ostream &out, const BenchOptions &options, const std::vector<BenchResult> &results)
+    {
+        out << std::fixed << std::setprecision(4);
+        out << "{\n";
+        out << "  \"benchmark\": \"render_bench\",\n";
+        out << "  \"width\": " << options.width << ",\n";
+        out << "  \"height\": " << options.height << ",\n";
+        out << "  \"frames\": " << options.frames << ",\n";
+        out << "  \"warmup\": " << options.warmup << ",\n";
+        out << "  \"pipeline\": " << (options.pipeline ? "true" : "false") << ",\n";
+        out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+        out << "  \"simd\": \"" << getSimdLevelName(getSimdLevel()) << "\",\n";
+        out << "  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchResult &result = results[i];
+            double meanMs = 0.0;
+            for (double ms : result.frameMs)
+            {
+                meanMs += ms;
+            }
+            meanMs /= std::max<size_t>(result.frameMs.size(), 1);
+
+            FrameStats total;
+            for (const FrameStats &stats : result.stats)
+            {
+                total.geometryMs += stats.geometryMs;
+                total.shadowMs += stats.shadowMs;
+                total.rasterMs += stats.rasterMs;
+                total.pipeline += stats.pipeline;
+            }
+            const PipelineStatistics &counts = total.pipeline;
+            const double statFrames = static_cast<double>(std::max<size_t>(result.stats.size(), 1));
+            const double seconds = result.totalMs / 1000.0;
+
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    {\n";
+            out << "      \"scene\": \"" << result.scene << "\",\n";
+            out << "      \"msaa\": " << (result.msaa ? "true" : "false") << ",\n";
+            out << "      \"shadow\": " << (result.shadow ? "true" : "false") << ",\n";
+            out << "      \"threads\": " << result.threads << ",\n";
+            out << "      \"frame_ms\": {\"mean\": " << meanMs
+                << ", \"p50\": " << percentile(result.frameMs, 50.0)
+                << ", \"p95\": " << percentile(result.frameMs, 95.0)
+                << ", \"p99\": " << percentile(result.frameMs, 99.0)
+                << ", \"min\": " << percentile(result.frameMs, 0.0)
+                << ", \"max\": " << percentile(result.frameMs, 100.0) << "},\n";
+            out << "      \"stage_ms\": {\"geometry\": " << total.geometryMs / statFrames
+                << ", \"shadow\": " << total.shadowMs / statFrames
+                << ", \"raster\": " << total.rasterMs / statFrames << "},\n";
+            out << "      \"triangles_per_frame\": " << counts.trianglesSubmitted / statFrames << ",\n";
+            out << "      \"triangles_rasterized_per_frame\": " << counts.trianglesRasterized / statFrames << ",\n";
+            out << "      \"fragments_per_frame\": " << counts.fragmentsShaded / statFrames << ",\n";
+            out << "      \"pipeline_per_frame\": {\"culled_backface\": " << counts.trianglesCulledBackface / statFrames
+                << ", \"culled_offscreen\": " << counts.trianglesCulledOffscreen / statFrames
+                << ", \"clipped\": " << counts.trianglesClipped / statFrames
+                << ", \"pixels_tested\": " << counts.pixelsTested / statFrames
+                << ", \"depth_passed\": " << counts.depthTestsPassed / statFrames
+                << ", \"depth_failed\": " << counts.depthTestsFailed / statFrames
+                << ", \"fragments_discarded\": " << counts.fragmentsDiscarded / statFrames << "},\n";
+            // 平均每个像素（MSAA下为采样点）的着色次数
+            const double samplesPerFrame = static_cast<double>(options.width) * options.height * (result.msaa ? 4 : 1);
+            out << "      \"overdraw\": " << counts.fragmentsShaded / statFrames / samplesPerFrame << ",\n";
+            out << "      \"triangles_per_second\": " << (seconds > 0.0 ? counts.trianglesSubmitted / seconds : 0.0) << ",\n";
+            out << "      \"fragments_per_second\": " << (seconds > 0.0 ? counts.fragmentsShaded / seconds : 0.0) << "\n";
+            out << "    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    if (!parseCommandLine(argc, argv, options))
+    {
+        printHelp();
+        return 1;
+    }
+    if (options.threads.empty())
+    {
+        options.threads.push_back(JobSystem::getInstance().getWorkerCount());
+    }
+
+    std::vector<BenchResult> results;
+    for (const std::string &name : options.scenes)
+    {
+        const BenchSceneDesc *desc = findBenchScene(name);
+        if (!desc)
+        {
+            std::cerr << "未知场景: " << name << std::endl;
+            return 1;
+        }
+        for (int threads : options.threads)
+        {
+            for (int msaa : options.msaa)
+            {
+                for (int shadow : options.shadow)
+                {
+                    std::cerr << "[render_bench] " << name << " msaa=" << msaa << " shadow=" << shadow
+                              << " threads=" << threads << std::endl;
+                    results.push_back(runConfiguration(*desc, msaa != 0, shadow != 0, threads, options));
+                }
+            }
+        }
+    }
+
+    if (options.output.empty())
+    {
+        writeJson(std::cout, options, results);
+    }
+    else
+    {
+        std::ofstream file(options.output);
+        if (!file)
+        {
+            std::cerr << "无法创建文件：" << options.output << std::endl;
+            return 1;
+        }
+        writeJson(file, options, results);
+        std::cerr << "[render_bench] 结果已保存到 " << options.output << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,555 @@
+// render_regress.cpp
+// 渲染回归检查：在固定配置下无窗口渲染命名场景，与基准图像逐像素和按SSIM比较，
+// 并把帧时间与保存的性能基线比较。任一检查失败时返回非零，可直接用于CI。
+// 基准图像随源码提交在regress/目录（确定性模式、默认320x180生成）；性能基线与机器相关，
+// 只在生成它的机器上比较，其他机器上用--update-perf生成本地基线。
+
+#include "bench_scenes.h"
+#include "job_system.h"
+#include "raster_check.h"
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // SSIM的窗口大小和稳定常数（按8位亮度）
+    constexpr int SSIM_WINDOW = 8;
+    constexpr double SSIM_C1 = (0.01 * 255.0) * (0.01 * 255.0);
+    constexpr double SSIM_C2 = (0.03 * 255.0) * (0.03 * 255.0);
+
+    // 图像检查全部通过、但要求的帧时间检查无法进行（没有本机性能基线）时的返回值，
+    // 与CMake中render_regress_perf测试的SKIP_RETURN_CODE一致，CTest将其报告为跳过
+    constexpr int EXIT_PERF_SKIPPED = 77;
+
+    struct RegressOptions
+    {
+        std::vector<std::string> scenes = {"sphere_grid", "overdraw", "point_lights"};
+        std::vector<int> threads; // 为空时使用1和当前工作者数
+        int width = 320;
+        int height = 180;
+        int frames = 4;       // 沿路径渲染的帧数，比较最后一帧（前面的帧覆盖跨帧状态）
+        int timedFrames = 20; // 计时的帧数，取中位数
+        std::string dataDir = "../regress";
+        bool update = false;
+        bool updatePerf = false;      // 只重新生成性能基线
+        int pixelTolerance = 2;       // 单个通道允许的差值
+        double maxBadPixels = 0.001;  // 超出容差的像素比例上限
+        double minSsim = 0.99;        // 平均SSIM下限
+        double perfThreshold = 25.0;  // 帧时间相对基线允许增加的百分比，0表示不检查
+        bool deterministic = false;   // 确定性光栅化，并要求串行和并行渲染逐位一致
+    };
+
+    struct ImageCompare
+    {
+        double badPixelRatio = 0.0;
+        int maxDifference = 0;
+        double ssim = 1.0;
+    };
+
+    void printHelp()
+    {
+        std::cout << "render_regress 渲染回归检查" << std::endl;
+        std::cout << "  --scenes=<a,b>         场景列表 (默认: sphere_grid,overdraw,point_lights)" << std::endl;
+        std::cout << "  --threads=<n,..>       工作者数 (默认: 1和SR_WORKER_THREADS或硬件线程数)" << std::endl;
+        std::cout << "  --size=<WxH>           渲染分辨率 (默认: 320x180)" << std::endl;
+        std::cout << "  --frames=<n>           沿路径渲染的帧数，比较最后一帧 (默认: 4)" << std::endl;
+        std::cout << "  --timed-frames=<n>     计时的帧数 (默认: 20)" << std::endl;
+        std::cout << "  --data=<dir>           基准图像和性能基线目录 (默认: ../regress)" << std::endl;
+        std::cout << "  --update               重新生成基准图像和性能基线（应与--deterministic一起在参考版本上运行）" << std::endl;
+        std::cout << "  --update-perf          只重新生成本机的性能基线，基准图像保持不变" << std::endl;
+        std::cout << "  --tolerance=<n>        单通道容差 (默认: 2)" << std::endl;
+        std::cout << "  --max-bad-pixels=<f>   超出容差的像素比例上限 (默认: 0.001)" << std::endl;
+        std::cout << "  --min-ssim=<f>         平均SSIM下限 (默认: 0.99)" << std::endl;
+        std::cout << "  --perf-threshold=<pct> 帧时间相对基线允许增加的百分比，0为不检查 (默认: 25)" << std::endl;
+        std::cout << "                         没有本机性能基线时图像检查照常进行，全部通过则返回" << EXIT_PERF_SKIPPED
+                  << "表示帧时间检查被跳过" << std::endl;
+        std::cout << "  --deterministic        启用确定性光栅化，并检查每个配置的串行和并行渲染逐位一致" << std::endl;
+    }
+
+    std::vector<std::string> splitList(const std::string &value)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream(value);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    bool parseCommandLine(int argc, char *argv[], RegressOptions &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help")
+            {
+                printHelp();
+                std::exit(0);
+            }
+            else if (arg.find("--scenes=") == 0)
+            {
+                options.scenes = splitList(arg.substr(9));
+            }
+            else if (arg.find("--threads=") == 0)
+            {
+                options.threads.clear();
+                for (const std::string &item : splitList(arg.substr(10)))
+                {
+                    options.threads.push_back(std::atoi(item.c_str()));
+                }
+            }
+            else if (arg.find("--size=") == 0)
+            {
+                if (std::sscanf(arg.c_str() + 7, "%dx%d", &options.width, &options.height) != 2 ||
+                    options.width <= 0 || options.height <= 0)
+                {
+                    std::cerr << "无效的分辨率: " << arg << std::endl;
+                    return false;
+                }
+            }
+            else if (arg.find("--frames=") == 0)
+            {
+                options.frames = std::max(1, std::atoi(arg.substr(9).c_str()));
+            }
+            else if (arg.find("--timed-frames=") == 0)
+            {
+                options.timedFrames = std::max(1, std::atoi(arg.substr(15).c_str()));
+            }
+            else if (arg.find("--data=") == 0)
+            {
+                options.dataDir = arg.substr(7);
+            }
+            else if (arg == "--update")
+            {
+                options.update = true;
+            }
+            else if (arg == "--update-perf")
+            {
+                options.updatePerf = true;
+            }
+            else if (arg.find("--tolerance=") == 0)
+            {
+                options.pixelTolerance = std::max(0, std::atoi(arg.substr(12).c_str()));
+            }
+            else if (arg.find("--max-bad-pixels=") == 0)
+            {
+                options.maxBadPixels = std::atof(arg.substr(17).c_str());
+            }
+            else if (arg.find("--min-ssim=") == 0)
+            {
+                options.minSsim = std::atof(arg.substr(11).c_str());
+            }
+            else if (arg == "--deterministic")
+            {
+                options.deterministic = true;
+            }
+            else if (arg.find("--perf-threshold=") == 0)
+            {
+                options.perfThreshold = std::max(0.0, std::atof(arg.substr(17).c_str()));
+            }
+            else
+            {
+                std::cerr << "未知参数: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //--------------------
+    // 图像比较
+    //--------------------
+    int channel(uint32_t pixel, int shift)
+    {
+        return static_cast<int>((pixel >> shift) & 0xFF);
+    }
+
+    double luminance(uint32_t pixel)
+    {
+        return 0.299 * channel(pixel, 16) + 0.587 * channel(pixel, 8) + 0.114 * channel(pixel, 0);
+    }
+
+    // 亮度通道上按不重叠窗口计算的平均SSIM
+    double computeSsim(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b, int width, int height)
+    {
+        double total = 0.0;
+        int windows = 0;
+        for (int wy = 0; wy + SSIM_WINDOW <= height; wy += SSIM_WINDOW)
+        {
+            for (int wx = 0; wx + SSIM_WINDOW <= width; wx += SSIM_WINDOW)
+            {
+                double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+                for (int y = wy; y < wy + SSIM_WINDOW; ++y)
+                {
+                    for (int x = wx; x < wx + SSIM_WINDOW; ++x)
+                    {
+                        const size_t index = static_cast<size_t>(y) * width + x;
+                        const double la = luminance(a[index]);
+                        const double lb = luminance(b[index]);
+                        sumA += la;
+                        sumB += lb;
+                        sumAA += la * la;
+                        sumBB += lb * lb;
+                        sumAB += la * lb;
+                    }
+                }
+                const double n = SSIM_WINDOW * SSIM_WINDOW;
+                const double meanA = sumA / n, meanB = sumB / n;
+                const double varA = sumAA / n - meanA * meanA;
+                const double varB = sumBB / n - meanB * meanB;
+                const double covariance = sumAB / n - meanA * meanB;
+                total += ((2.0 * meanA * meanB + SSIM_C1) * (2.0 * covariance + SSIM_C2)) /
+                         ((meanA * meanA + meanB * meanB + SSIM_C1) * (varA + varB + SSIM_C2));
+                ++windows;
+            }
+        }
+        return windows > 0 ? total / windows : 1.0;
+    }
+
+    // 比较两幅图像，diff输出差异图（差值放大8倍后的灰度）
+    ImageCompare compareImages(const std::vector<uint32_t> &actual, const std::vector<uint32_t> &expected,
+                               int width, int height, int tolerance, std::vector<uint32_t> &diff)
+    {
+        ImageCompare result;
+        diff.resize(actual.size());
+        size_t badPixels = 0;
+        for (size_t i = 0; i < actual.size(); ++i)
+        {
+            int difference = 0;
+            for (int shift : {16, 8, 0})
+            {
+                difference = std::max(difference, std::abs(channel(actual[i], shift) - channel(expected[i], shift)));
+            }
+            result.maxDifference = std::max(result.maxDifference, difference);
+            badPixels += difference > tolerance;
+            const uint32_t gray = static_cast<uint32_t>(std::min(255, difference * 8));
+            diff[i] = 0xFF000000u | (gray << 16) | (gray << 8) | gray;
+        }
+        result.badPixelRatio = actual.empty() ? 0.0 : static_cast<double>(badPixels) / actual.size();
+        result.ssim = computeSsim(actual, expected, width, height);
+        return result;
+    }
+
+    //--------------------
+    // 性能基线：每行一个 "配置": 毫秒数 的JSON对象，"machine"为生成基线的机器
+    //--------------------
+    struct PerfBaseline
+    {
+        std::string machine;
+        std::map<std::string, double> frameMs;
+    };
+
+    // 机器标识：CPU型号和硬件线程数，帧时间只与同一台机器上的基线比较
+    std::string machineSignature()
+    {
+        std::string model = "unknown";
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+        {
+            const size_t colon = line.find(':');
+            if (line.find("model name") == 0 && colon != std::string::npos)
+            {
+                model = line.substr(line.find_first_not_of(" \t", colon + 1));
+                break;
+            }
+        }
+        return model + " / " + std::to_string(std::thread::hardware_concurrency()) + " threads";
+    }
+
+    PerfBaseline loadBaseline(const std::string &filename)
+    {
+        PerfBaseline baseline;
+        std::ifstream file(filename);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            const size_t keyBegin = line.find('"');
+            const size_t keyEnd = keyBegin == std::string::npos ? keyBegin : line.find('"', keyBegin + 1);
+            const size_t colon = keyEnd == std::string::npos ? keyEnd : line.find(':', keyEnd);
+            if (colon == std::string::npos)
+            {
+                continue;
+            }
+            const std::string key = line.substr(keyBegin + 1, keyEnd - keyBegin - 1);
+            if (key == "machine")
+            {
+                const size_t valueBegin = line.find('"', colon);
+                const size_t valueEnd = line.rfind('"');
+                if (valueBegin != std::string::npos && valueEnd > valueBegin)
+                {
+                    baseline.machine = line.substr(valueBegin + 1, valueEnd - valueBegin - 1);
+                }
+                continue;
+            }
+            baseline.frameMs[key] = std::atof(line.c_str() + colon + 1);
+        }
+        return baseline;
+    }
+
+    bool saveBaseline(const std::string &filename, const PerfBaseline &baseline)
+    {
+        std::ofstream file(filename);
+        if (!file)
+        {
+            return false;
+        }
+        file << std::fixed << std::setprecision(4) << "{\n";
+        file << "  \"machine\": \"" << baseline.machine << "\"" << (baseline.frameMs.empty() ? "\n" : ",\n");
+        size_t index = 0;
+        for (const auto &[key, ms] : baseline.frameMs)
+        {
+            file << "  \"" << key << "\": " << ms << (++index < baseline.frameMs.size() ? ",\n" : "\n");
+        }
+        file << "}\n";
+        return static_cast<bool>(file);
+    }
+
+    //--------------------
+    // 渲染
+    //--------------------
+    struct RenderResult
+    {
+        std::vector<uint32_t> pixels; // 最后一帧
+        double medianMs = 0.0;
+        RasterCheckReport rasterCheck; // 确定性模式下最后一帧的串行/并行比较
+    };
+
+    RenderResult renderConfiguration(const BenchSceneDesc &desc, bool msaa, bool shadow, int threads,
+                                     const RegressOptions &options)
+    {
+        JobSystem::getInstance().setWorkerCount(threads);
+
+        Renderer renderer(options.width, options.height);
+        renderer.enableMSAA(msaa);
+        renderer.enableDeterministicRaster(options.deterministic);
+
+        Scene scene;
+        desc.init(scene, options.width, options.height);
+        scene.setupShadowMapping(shadow);
+        const BenchPath path = makeOrbitPath(scene);
+
+        RenderResult result;
+        for (int frame = 0; frame < options.frames; ++frame)
+        {
+            path.apply(scene, options.frames > 1 ? 0.5f * frame / (options.frames - 1) : 0.0f);
+            scene.render(renderer);
+        }
+        const FrameBuffer &frameBuffer = renderer.getFrameBuffer();
+        result.pixels.resize(static_cast<size_t>(options.width) * options.height);
+        frameBuffer.copyToPlatform(result.pixels.data());
+        if (options.deterministic)
+        {
+            result.rasterCheck = checkSerialParallelRaster(scene, renderer, threads);
+        }
+
+        // 计时：沿整条路径渲染，取中位数以减少偶发抖动的影响
+        std::vector<double> frameMs;
+        for (int frame = 0; frame < options.timedFrames; ++frame)
+        {
+            path.apply(scene, options.timedFrames > 1 ? static_cast<float>(frame) / (options.timedFrames - 1) : 0.0f);
+            const auto startTime = std::chrono::steady_clock::now();
+            scene.render(renderer);
+            frameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+        }
+        std::sort(frameMs.begin(), frameMs.end());
+        result.medianMs = frameMs[frameMs.size() / 2];
+        return result;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    RegressOptions options;
+    if (!parseCommandLine(argc, argv, options))
+    {
+        printHelp();
+        return 1;
+    }
+    if (options.threads.empty())
+    {
+        options.threads = {1};
+        const int workers = JobSystem::getInstance().getWorkerCount();
+        if (workers > 1)
+        {
+            options.threads.push_back(workers);
+        }
+    }
+
+    namespace fs = std::filesystem;
+    const fs::path dataDir(options.dataDir);
+    const fs::path failureDir = dataDir / "failed";
+    const std::string baselineFile = (dataDir / "baseline.json").string();
+    std::error_code error;
+    fs::create_directories(dataDir, error);
+
+    const bool updating = options.update || options.updatePerf;
+    const std::string machine = machineSignature();
+    PerfBaseline baseline = loadBaseline(baselineFile);
+    if (updating)
+    {
+        baseline.machine = machine;
+        baseline.frameMs.clear();
+    }
+    else if (options.perfThreshold > 0.0 && baseline.machine != machine)
+    {
+        // 不同机器的帧时间没有可比性：只检查图像，结束时以EXIT_PERF_SKIPPED报告跳过
+        baseline.frameMs.clear();
+    }
+    const bool perfSkipped = !updating && options.perfThreshold > 0.0 && baseline.frameMs.empty();
+
+    int failures = 0;
+    int imageFailures = 0;
+    int checks = 0;
+    for (const std::string &name : options.scenes)
+    {
+        const BenchSceneDesc *desc = findBenchScene(name);
+        if (!desc)
+        {
+            std::cerr << "未知场景: " << name << std::endl;
+            return 1;
+        }
+        for (int msaa = 0; msaa <= 1; ++msaa)
+        {
+            for (int shadow = 0; shadow <= 1; ++shadow)
+            {
+                // 基准图像与线程数无关：不同线程数的输出都必须与同一幅图像一致
+                const std::string imageKey = name + "_msaa" + std::to_string(msaa) + "_shadow" + std::to_string(shadow);
+                const std::string goldenFile = (dataDir / (imageKey + ".ppm")).string();
+                bool goldenWritten = false;
+
+                for (int threads : options.threads)
+                {
+                    RenderResult result = renderConfiguration(*desc, msaa != 0, shadow != 0, threads, options);
+                    const int workers = JobSystem::getInstance().getWorkerCount();
+                    const std::string key = imageKey + "_t" + std::to_string(workers);
+                    std::ostringstream line;
+                    line << std::fixed << name << " msaa=" << msaa << " shadow=" << shadow << " threads=" << workers;
+
+                    if (updating)
+                    {
+                        if (options.update && !goldenWritten)
+                        {
+                            saveToPPM(goldenFile, result.pixels.data(), options.width, options.height, options.width, false);
+                            goldenWritten = true;
+                        }
+                        baseline.frameMs[key] = result.medianMs;
+                        std::cout << "[UPDATE] " << line.str() << std::setprecision(3) << "  " << result.medianMs << " ms" << std::endl;
+                        continue;
+                    }
+
+                    ++checks;
+                    bool passed = true;
+                    std::vector<uint32_t> expected;
+                    int goldenWidth = 0, goldenHeight = 0;
+                    if (!loadPPM(goldenFile, expected, goldenWidth, goldenHeight) ||
+                        goldenWidth != options.width || goldenHeight != options.height)
+                    {
+                        line << "  缺少基准图像或尺寸不符: " << goldenFile
+                             << "（基准图像随源码提交；有意修改渲染结果时用 --update --deterministic 重新生成并一起提交）";
+                        passed = false;
+                        ++imageFailures;
+                    }
+                    else
+                    {
+                        std::vector<uint32_t> diff;
+                        const ImageCompare compare = compareImages(result.pixels, expected, options.width, options.height,
+                                                                   options.pixelTolerance, diff);
+                        line << std::setprecision(4) << "  bad=" << compare.badPixelRatio * 100.0 << "%"
+                             << " maxdiff=" << compare.maxDifference << " ssim=" << compare.ssim;
+                        if (compare.badPixelRatio > options.maxBadPixels || compare.ssim < options.minSsim)
+                        {
+                            passed = false;
+                            ++imageFailures;
+                            fs::create_directories(failureDir, error);
+                            saveToPPM((failureDir / (key + "_actual.ppm")).string(), result.pixels.data(),
+                                      options.width, options.height, options.width, false);
+                            saveToPPM((failureDir / (key + "_diff.ppm")).string(), diff.data(),
+                                      options.width, options.height, options.width, false);
+                        }
+                    }
+
+                    if (options.deterministic)
+                    {
+                        line << "  serial/parallel=";
+                        if (result.rasterCheck.identical())
+                        {
+                            line << "identical";
+                        }
+                        else
+                        {
+                            line << result.rasterCheck.colorMismatches << "/" << result.rasterCheck.depthMismatches
+                                 << " 像素不一致(颜色/深度)";
+                            passed = false;
+                        }
+                    }
+
+                    line << std::setprecision(3) << "  " << result.medianMs << " ms";
+                    const auto base = baseline.frameMs.find(key);
+                    if (options.perfThreshold > 0.0 && base != baseline.frameMs.end())
+                    {
+                        const double change = (result.medianMs / base->second - 1.0) * 100.0;
+                        line << " (基线 " << base->second << " ms, " << std::showpos << std::setprecision(1) << change
+                             << std::noshowpos << "%)";
+                        if (change > options.perfThreshold)
+                        {
+                            line << " 性能回退";
+                            passed = false;
+                        }
+                    }
+
+                    failures += !passed;
+                    std::cout << (passed ? "[PASS] " : "[FAIL] ") << line.str() << std::endl;
+                }
+            }
+        }
+    }
+
+    if (updating)
+    {
+        if (!saveBaseline(baselineFile, baseline))
+        {
+            std::cerr << "无法创建文件：" << baselineFile << std::endl;
+            return 1;
+        }
+        std::cout << "[render_regress] " << (options.update ? "基准图像和性能基线" : "性能基线") << "已保存到 "
+                  << dataDir.string() << std::endl;
+        return 0;
+    }
+
+    std::cout << "[render_regress] " << checks - failures << "/" << checks << " 通过";
+    if (imageFailures > 0)
+    {
+        std::cout << "，图像不一致的输出和差异图保存在 " << failureDir.string();
+    }
+    std::cout << std::endl;
+    if (failures > 0)
+    {
+        return 1;
+    }
+    if (perfSkipped)
+    {
+        std::cout << "[render_regress] 跳过帧时间检查：" << baselineFile << " 中没有本机（" << machine
+                  << "）的性能基线，用 --update-perf 生成；只比较图像时使用 --perf-threshold=0" << std::endl;
+        return EXIT_PERF_SKIPPED;
+    }
+    return 0;
+}
@@ -1,7 +1,8 @@
 #include "renderer.h"
+#include "job_system.h"
 #include <algorithm>
 #include <cstring> // 为memset添加
-#include <thread>
+#include <new>
 // 定义 MSAA 常量
 constexpr int MSAA_SAMPLES = 4;
 constexpr float EPSILON = 1e-6f;
@@ -10,29 +11,125 @@ const Vec2f MSAA_OFFSETS[MSAA_SAMPLES] = {
     {0.25f, 0.75f}, {0.75f, 0.75f}
 };
 
-FrameBuffer::FrameBuffer(int width, int height)
-    : width(width), height(height), msaaEnabled(false)
+namespace
+{
+    // 颜色值限制在[0,1]范围内，然后映射到[0,255]
+    inline uint32_t toChannel(float value)
+    {
+        return static_cast<uint32_t>(static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255));
+    }
+
+    // 打包为ARGB8888（与SDL_PIXELFORMAT_ARGB8888一致）
+    inline uint32_t packARGB(float r, float g, float b, float a)
+    {
+        return (toChannel(a) << 24) | (toChannel(r) << 16) | (toChannel(g) << 8) | toChannel(b);
+    }
+
+    // 缓冲区按缓存行对齐，分块布局下每个tile从缓存行起始处开始
+    constexpr size_t CACHE_LINE_SIZE = 64;
+
+    template <typename T>
+    T *allocateAligned(size_t count)
+    {
+        return static_cast<T *>(::operator new[](count * sizeof(T), std::align_val_t(CACHE_LINE_SIZE)));
+    }
+
+    template <typename T>
+    void freeAligned(T *buffer)
+    {
+        ::operator delete[](buffer, std::align_val_t(CACHE_LINE_SIZE));
+    }
+}
+
+FrameBuffer::FrameBuffer(int width, int height, FrameBufferLayout layout)
+    : width(width), height(height), layout(layout),
+      tilesX((width + TILE_SIZE - 1) / TILE_SIZE), tilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+      colorPitch(width), msaaEnabled(false)
 {
-    // 直接分配内存
-    colorBuffer = new uint8_t[width * height * 4];
-    depthBuffer = new float[width * height];
-    
-    // 初始化缓冲区
-    std::memset(colorBuffer, 0, width * height * 4);
-    std::fill_n(depthBuffer, width * height, 1.0f);
-    
     // MSAA缓冲区初始为nullptr
     msaaDepthBuffer = nullptr;
     msaaSampleCount = nullptr;
+
+    tileStates = std::make_unique<std::atomic<uint8_t>[]>(static_cast<size_t>(tilesX) * tilesY);
+    allocateBuffers();
 }
 
 FrameBuffer::~FrameBuffer() {
-    delete[] colorBuffer;
-    delete[] depthBuffer;
-    
+    releaseBuffers();
+}
+
+size_t FrameBuffer::bufferPixelCount() const
+{
+    if (layout == FrameBufferLayout::TILED) {
+        return static_cast<size_t>(tilesX) * tilesY * TILE_PIXELS;
+    }
+    return static_cast<size_t>(width) * height;
+}
+
+void FrameBuffer::allocateBuffers()
+{
+    const size_t pixelCount = bufferPixelCount();
+    ownedColorBuffer = allocateAligned<uint32_t>(pixelCount);
+    depthBuffer = allocateAligned<float>(pixelCount);
+
+    // 初始化缓冲区
+    std::memset(ownedColorBuffer, 0, pixelCount * sizeof(uint32_t));
+    std::fill_n(depthBuffer, pixelCount, 1.0f);
+    for (int tile = 0; tile < tilesX * tilesY; ++tile) {
+        tileStates[tile].store(TILE_READY, std::memory_order_relaxed);
+    }
+
+    selectColorBuffer();
+
+    if (msaaEnabled) {
+        msaaDepthBuffer = allocateAligned<float>(pixelCount * MSAA_SAMPLES);
+        msaaSampleCount = allocateAligned<int>(pixelCount);
+        std::fill_n(msaaDepthBuffer, pixelCount * MSAA_SAMPLES, 1.0f);
+        std::memset(msaaSampleCount, 0, pixelCount * sizeof(int));
+    }
+}
+
+void FrameBuffer::releaseBuffers()
+{
+    freeAligned(ownedColorBuffer);
+    freeAligned(depthBuffer);
+    ownedColorBuffer = nullptr;
+    depthBuffer = nullptr;
+
     if (msaaDepthBuffer) {
-        delete[] msaaDepthBuffer;
-        delete[] msaaSampleCount;
+        freeAligned(msaaDepthBuffer);
+        freeAligned(msaaSampleCount);
+        msaaDepthBuffer = nullptr;
+        msaaSampleCount = nullptr;
+    }
+}
+
+void FrameBuffer::setLayout(FrameBufferLayout layout)
+{
+    if (this->layout == layout) return;
+
+    releaseBuffers();
+    this->layout = layout;
+    allocateBuffers();
+}
+
+void FrameBuffer::setColorTarget(uint32_t *target, int pitch, bool readback)
+{
+    externalColorTarget = target;
+    externalColorPitch = target ? pitch : 0;
+    colorReadback = target && readback;
+    selectColorBuffer();
+}
+
+void FrameBuffer::selectColorBuffer()
+{
+    // MSAA的颜色累积是读-改-写，外部目标只能写入，因此同样渲染到内部存储
+    if (layout == FrameBufferLayout::LINEAR && externalColorTarget && !msaaEnabled && !colorReadback) {
+        colorBuffer = externalColorTarget;
+        colorPitch = externalColorPitch;
+    } else {
+        colorBuffer = ownedColorBuffer;
+        colorPitch = width;
     }
 }
 
@@ -42,33 +139,36 @@ void FrameBuffer::enableMSAA(bool enable)
     
     msaaEnabled = enable;
     
+    const size_t pixelCount = bufferPixelCount();
     if (msaaEnabled) {
         // 分配 MSAA 缓冲区
-        msaaDepthBuffer = new float[width * height * MSAA_SAMPLES];
-        msaaSampleCount = new int[width * height];
+        msaaDepthBuffer = allocateAligned<float>(pixelCount * MSAA_SAMPLES);
+        msaaSampleCount = allocateAligned<int>(pixelCount);
         
         // 初始化
-        std::fill_n(msaaDepthBuffer, width * height * MSAA_SAMPLES, 1.0f);
-        std::memset(msaaSampleCount, 0, width * height * sizeof(int));
+        std::fill_n(msaaDepthBuffer, pixelCount * MSAA_SAMPLES, 1.0f);
+        std::memset(msaaSampleCount, 0, pixelCount * sizeof(int));
     } else {
         // 释放 MSAA 缓冲区内存
         if (msaaDepthBuffer) {
-            delete[] msaaDepthBuffer;
-            delete[] msaaSampleCount;
+            freeAligned(msaaDepthBuffer);
+            freeAligned(msaaSampleCount);
             msaaDepthBuffer = nullptr;
             msaaSampleCount = nullptr;
         }
     }
+    selectColorBuffer();
 }
 
 int FrameBuffer::calcMSAAIndex(int x, int y, int sampleIndex) const
 {
-    return (y * width + x) * MSAA_SAMPLES + sampleIndex;
+    return calcIndex(x, y) * MSAA_SAMPLES + sampleIndex;
 }
 
 void FrameBuffer::setPixel(int x, int y, float depth, const Vec4f &color)
 {
     if (!isValidCoord(x, y)) return;
+    ensureTile(x, y);
     
     int index = calcIndex(x, y);
     
@@ -76,42 +176,49 @@ void FrameBuffer::setPixel(int x, int y, float depth, const Vec4f &color)
     depthBuffer[index] = depth;
     
     // 更新颜色缓冲区
-    int colorIndex = index * 4;
-    
-    // 颜色值限制在[0,1]范围内，然后映射到[0,255]
-    colorBuffer[colorIndex]     = static_cast<uint8_t>(std::min(std::max(color.x, 0.0f), 1.0f) * 255);
-    colorBuffer[colorIndex + 1] = static_cast<uint8_t>(std::min(std::max(color.y, 0.0f), 1.0f) * 255);
-    colorBuffer[colorIndex + 2] = static_cast<uint8_t>(std::min(std::max(color.z, 0.0f), 1.0f) * 255);
-    colorBuffer[colorIndex + 3] = static_cast<uint8_t>(std::min(std::max(color.w, 0.0f), 1.0f) * 255);
+    colorBuffer[calcColorIndex(x, y)] = packARGB(color.x, color.y, color.z, color.w);
+}
+
+void FrameBuffer::setColor(int x, int y, const Vec4f &color)
+{
+    if (!isValidCoord(x, y)) return;
+    ensureTile(x, y);
+    colorBuffer[calcColorIndex(x, y)] = packARGB(color.x, color.y, color.z, color.w);
 }
 
 float FrameBuffer::getDepth(int x, int y) const
 {
     if (!isValidCoord(x, y)) return 1.0f;
+    if (isTileCleared(x, y)) return clearDepth;
     return depthBuffer[calcIndex(x, y)];
 }
 
 float FrameBuffer::getMSAADepth(int x, int y, int sampleIndex) const
 {
     if (!isValidCoord(x, y) || !msaaEnabled) return 1.0f;
+    if (isTileCleared(x, y)) return clearDepth;
     return msaaDepthBuffer[calcMSAAIndex(x, y, sampleIndex)];
 }
 
 bool FrameBuffer::depthTest(int x, int y, float depth) const
 {
     if (!isValidCoord(x, y)) return false;
+    // 待清除的tile不读取过期数据，直接与清除深度比较
+    if (isTileCleared(x, y)) return depth < clearDepth;
     return depth < depthBuffer[calcIndex(x, y)];
 }
 
 bool FrameBuffer::msaaDepthTest(int x, int y, int sampleIndex, float depth) const
 {
     if (!isValidCoord(x, y) || !msaaEnabled) return false;
+    if (isTileCleared(x, y)) return depth < clearDepth;
     return depth < msaaDepthBuffer[calcMSAAIndex(x, y, sampleIndex)];
 }
 //TODO 需要深度排序，如果先渲染深度大的物体，后渲染深度小的物体，可能会导致半透明重叠渲染
 void FrameBuffer::accumulateMSAAColor(int x, int y, int sampleIndex, float depth, const Vec4f& color)
 {
     if (!isValidCoord(x, y) || !msaaEnabled) return;
+    ensureTile(x, y);
     
     int pixelIndex = calcIndex(x, y);
     int msaaIndex = calcMSAAIndex(x, y, sampleIndex);
@@ -120,7 +227,7 @@ void FrameBuffer::accumulateMSAAColor(int x, int y, int sampleIndex, float depth
     msaaDepthBuffer[msaaIndex] = depth;
     
     // 累积颜色
-    int colorIndex = pixelIndex * 4;
+    uint32_t &pixel = colorBuffer[calcColorIndex(x, y)];
     
     // 限制颜色值
     float r = std::min(std::max(color.x, 0.0f), 1.0f);
@@ -129,10 +236,10 @@ void FrameBuffer::accumulateMSAAColor(int x, int y, int sampleIndex, float depth
     float a = std::min(std::max(color.w, 0.0f), 1.0f);
     
     // 获取当前颜色
-    float current_r = colorBuffer[colorIndex] / 255.0f;
-    float current_g = colorBuffer[colorIndex + 1] / 255.0f;
-    float current_b = colorBuffer[colorIndex + 2] / 255.0f;
-    float current_a = colorBuffer[colorIndex + 3] / 255.0f;
+    float current_r = ((pixel >> 16) & 0xFF) / 255.0f;
+    float current_g = ((pixel >> 8) & 0xFF) / 255.0f;
+    float current_b = (pixel & 0xFF) / 255.0f;
+    float current_a = (pixel >> 24) / 255.0f;
     
     // 增加样本计数
     msaaSampleCount[pixelIndex]++;
@@ -145,10 +252,10 @@ void FrameBuffer::accumulateMSAAColor(int x, int y, int sampleIndex, float depth
     float blended_a = current_a * (1.0f - blendFactor) + a * blendFactor;
     
     // 更新颜色缓冲区
-    colorBuffer[colorIndex]     = static_cast<uint8_t>(blended_r * 255);
-    colorBuffer[colorIndex + 1] = static_cast<uint8_t>(blended_g * 255);
-    colorBuffer[colorIndex + 2] = static_cast<uint8_t>(blended_b * 255);
-    colorBuffer[colorIndex + 3] = static_cast<uint8_t>(blended_a * 255);
+    pixel = (static_cast<uint32_t>(static_cast<uint8_t>(blended_a * 255)) << 24) |
+            (static_cast<uint32_t>(static_cast<uint8_t>(blended_r * 255)) << 16) |
+            (static_cast<uint32_t>(static_cast<uint8_t>(blended_g * 255)) << 8) |
+            static_cast<uint32_t>(static_cast<uint8_t>(blended_b * 255));
     
     // 更新主深度缓冲区（取最小深度）
     if (depth < depthBuffer[pixelIndex]) {
@@ -158,78 +265,123 @@ void FrameBuffer::accumulateMSAAColor(int x, int y, int sampleIndex, float depth
 
 void FrameBuffer::clear(const Vec4f &color, float depth)
 {
-    // 预计算颜色值
-    uint8_t r = static_cast<uint8_t>(std::min(std::max(color.x, 0.0f), 1.0f) * 255);
-    uint8_t g = static_cast<uint8_t>(std::min(std::max(color.y, 0.0f), 1.0f) * 255);
-    uint8_t b = static_cast<uint8_t>(std::min(std::max(color.z, 0.0f), 1.0f) * 255);
-    uint8_t a = static_cast<uint8_t>(std::min(std::max(color.w, 0.0f), 1.0f) * 255);
-
-    // 清除颜色缓冲区
-    int totalPixels = width * height;
-    for (int i = 0; i < totalPixels; ++i) {
-        int offset = i * 4;
-        colorBuffer[offset]     = r;
-        colorBuffer[offset + 1] = g;
-        colorBuffer[offset + 2] = b;
-        colorBuffer[offset + 3] = a;
+    // 只记录清除值，像素在tile首次写入或帧结束时才填充
+    clearColor = packARGB(color.x, color.y, color.z, color.w);
+    clearDepth = depth;
+    for (int tile = 0; tile < tilesX * tilesY; ++tile) {
+        tileStates[tile].store(TILE_CLEAR_PENDING, std::memory_order_relaxed);
     }
-    
-    // 清除深度缓冲区
-    std::fill_n(depthBuffer, totalPixels, depth);
-    
-    // 清除 MSAA 相关缓冲区（如果启用）
-    if (msaaEnabled) {
-        std::fill_n(msaaDepthBuffer, totalPixels * MSAA_SAMPLES, depth);
-        std::memset(msaaSampleCount, 0, totalPixels * sizeof(int));
+}
+
+void FrameBuffer::fillTileColor(int tileX, int tileY)
+{
+    if (layout == FrameBufferLayout::TILED) {
+        std::fill_n(colorBuffer + (static_cast<size_t>(tileY) * tilesX + tileX) * TILE_PIXELS, TILE_PIXELS, clearColor);
+        return;
+    }
+
+    const int x0 = tileX * TILE_SIZE, x1 = std::min(x0 + TILE_SIZE, width);
+    const int y0 = tileY * TILE_SIZE, y1 = std::min(y0 + TILE_SIZE, height);
+    for (int y = y0; y < y1; ++y) {
+        std::fill_n(colorBuffer + static_cast<size_t>(y) * colorPitch + x0, x1 - x0, clearColor);
     }
 }
 
-// 获取帧缓冲区数据
-const uint8_t* FrameBuffer::getData() const {
-    return colorBuffer;
+void FrameBuffer::initializeTile(int tile)
+{
+    std::atomic<uint8_t> &state = tileStates[tile];
+    uint8_t expected = TILE_CLEAR_PENDING;
+    if (!state.compare_exchange_strong(expected, TILE_CLEARING, std::memory_order_acquire)) {
+        // 其他线程正在初始化
+        while (state.load(std::memory_order_acquire) != TILE_READY) {
+        }
+        return;
+    }
+
+    const int tileX = tile % tilesX, tileY = tile / tilesX;
+    fillTileColor(tileX, tileY);
+
+    if (layout == FrameBufferLayout::TILED) {
+        const size_t base = static_cast<size_t>(tile) * TILE_PIXELS;
+        std::fill_n(depthBuffer + base, TILE_PIXELS, clearDepth);
+        if (msaaEnabled) {
+            std::fill_n(msaaDepthBuffer + base * MSAA_SAMPLES, TILE_PIXELS * MSAA_SAMPLES, clearDepth);
+            std::memset(msaaSampleCount + base, 0, TILE_PIXELS * sizeof(int));
+        }
+    } else {
+        const int x0 = tileX * TILE_SIZE, x1 = std::min(x0 + TILE_SIZE, width);
+        const int y0 = tileY * TILE_SIZE, y1 = std::min(y0 + TILE_SIZE, height);
+        for (int y = y0; y < y1; ++y) {
+            const size_t rowStart = static_cast<size_t>(y) * width + x0;
+            std::fill_n(depthBuffer + rowStart, x1 - x0, clearDepth);
+            if (msaaEnabled) {
+                std::fill_n(msaaDepthBuffer + rowStart * MSAA_SAMPLES, (x1 - x0) * MSAA_SAMPLES, clearDepth);
+                std::memset(msaaSampleCount + rowStart, 0, (x1 - x0) * sizeof(int));
+            }
+        }
+    }
+
+    state.store(TILE_READY, std::memory_order_release);
 }
 
-// 将帧缓冲区复制到平台层
-void FrameBuffer::copyToPlatform(uint32_t* dst) const
+// 按tile行并行展开内部存储的颜色：已写入的tile复制（按行布局时连续的tile合并复制），待清除的tile填充清除色。
+// 不读取外部目标
+void FrameBuffer::linearizeColor(uint32_t *dst, int dstPitch) const
 {
-    // 使用多线程并行处理
-    const int numThreads = std::thread::hardware_concurrency();
-    std::vector<std::thread> threads(numThreads);
-    
-    // 按块处理以提高缓存命中率
-    const int BLOCK_SIZE = 32; // 可以根据实际缓存大小调整
-    
-    auto processChunk = [&](int startRow, int endRow) {
-        for (int blockY = startRow; blockY < endRow; blockY += BLOCK_SIZE) {
-            for (int blockX = 0; blockX < width; blockX += BLOCK_SIZE) {
-                // 处理当前块
-                for (int y = blockY; y < std::min(blockY + BLOCK_SIZE, endRow); ++y) {
-                    for (int x = blockX; x < std::min(blockX + BLOCK_SIZE, width); ++x) {
-                        int i = y * width + x;
-                        int srcIndex = i * 4; // RGBA 格式
-                        
-                        // 转换为 ARGB 格式 (SDL 使用)
-                        dst[i] = 
-                            (static_cast<uint32_t>(colorBuffer[srcIndex + 3]) << 24) | // A
-                            (static_cast<uint32_t>(colorBuffer[srcIndex + 0]) << 16) | // R
-                            (static_cast<uint32_t>(colorBuffer[srcIndex + 1]) << 8) |  // G
-                            (static_cast<uint32_t>(colorBuffer[srcIndex + 2]));        // B
+    JobSystem::getInstance().parallelFor(0, tilesY, resolveGrain, [&](int tileY) {
+        const int y0 = tileY * TILE_SIZE;
+        const int y1 = std::min(y0 + TILE_SIZE, height);
+        const std::atomic<uint8_t> *states = tileStates.get() + static_cast<size_t>(tileY) * tilesX;
+        for (int y = y0; y < y1; ++y) {
+            uint32_t *dstRow = dst + static_cast<size_t>(y) * dstPitch;
+            int tileX = 0;
+            while (tileX < tilesX) {
+                const int x0 = tileX * TILE_SIZE;
+                if (states[tileX].load(std::memory_order_acquire) != TILE_READY) {
+                    std::fill_n(dstRow + x0, std::min(TILE_SIZE, width - x0), clearColor);
+                    ++tileX;
+                } else if (layout == FrameBufferLayout::TILED) {
+                    const uint32_t *src = ownedColorBuffer + (static_cast<size_t>(tileY) * tilesX + tileX) * TILE_PIXELS + (y - y0) * TILE_SIZE;
+                    std::memcpy(dstRow + x0, src, std::min(TILE_SIZE, width - x0) * sizeof(uint32_t));
+                    ++tileX;
+                } else {
+                    int runEnd = tileX + 1;
+                    while (runEnd < tilesX && states[runEnd].load(std::memory_order_acquire) == TILE_READY) {
+                        ++runEnd;
                     }
+                    const int x1 = std::min(runEnd * TILE_SIZE, width);
+                    const uint32_t *src = ownedColorBuffer + static_cast<size_t>(y) * width + x0;
+                    std::memcpy(dstRow + x0, src, (x1 - x0) * sizeof(uint32_t));
+                    tileX = runEnd;
                 }
             }
         }
-    };
-    
-    // 划分工作区域
-    int rowsPerThread = height / numThreads;
-    for (int i = 0; i < numThreads; ++i) {
-        int startRow = i * rowsPerThread;
-        int endRow = (i == numThreads - 1) ? height : (i + 1) * rowsPerThread;
-        threads[i] = std::thread(processChunk, startRow, endRow);
+    });
+}
+
+void FrameBuffer::resolveColorTarget()
+{
+    // 渲染到内部存储时整帧写入外部目标（只写，不读回外部目标）
+    if (externalColorTarget && colorBuffer != externalColorTarget) {
+        linearizeColor(externalColorTarget, externalColorPitch);
+        return;
     }
-    
-    // 等待所有线程完成
-    for (auto& thread : threads) {
-        thread.join();
+    if (layout == FrameBufferLayout::TILED) {
+        return;
     }
-}
\ No newline at end of file
+
+    // 按行布局：颜色目标中未写入的tile仍是过期内容，填充清除色（tile状态不变，深度保持待清除）
+    JobSystem::getInstance().parallelFor(0, tilesY, resolveGrain, [&](int tileY) {
+        for (int tileX = 0; tileX < tilesX; ++tileX) {
+            if (tileStates[tileY * tilesX + tileX].load(std::memory_order_acquire) != TILE_READY) {
+                fillTileColor(tileX, tileY);
+            }
+        }
+    });
+}
+
+// 将帧缓冲区复制到平台层（颜色目标已是平台使用的ARGB格式时无需调用）
+void FrameBuffer::copyToPlatform(uint32_t* dst) const
+{
+    linearizeColor(dst, width);
+}
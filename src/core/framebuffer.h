@@ -1,18 +1,53 @@
 #pragma once
 
 #include "maths.h"
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+
+// 帧缓冲的内存布局
+enum class FrameBufferLayout
+{
+    LINEAR, // 按行存储
+    TILED   // 按8x8的tile存储：每个tile的颜色、深度和MSAA数据各自连续且按缓存行对齐，
+            // 块状光栅化只触及少量缓存行，相邻线程写入的块也不共享缓存行
+};
 
 class FrameBuffer
 {
 public:
-    FrameBuffer(int width, int height);
+    static constexpr int TILE_SIZE = 8;
+    static constexpr int TILE_PIXELS = TILE_SIZE * TILE_SIZE;
+
+    FrameBuffer(int width, int height, FrameBufferLayout layout = FrameBufferLayout::LINEAR);
     ~FrameBuffer();
 
+    FrameBuffer(const FrameBuffer &) = delete;
+    FrameBuffer &operator=(const FrameBuffer &) = delete;
+
+    // 切换内存布局，缓冲区内容被重置
+    void setLayout(FrameBufferLayout layout);
+    FrameBufferLayout getLayout() const { return layout; }
+
     // 核心操作
     void setPixel(int x, int y, float depth, const Vec4f &color);
+    // 只写颜色，保留深度（调试视图覆盖输出时使用）
+    void setColor(int x, int y, const Vec4f &color);
+    // 延迟清除：只记录清除值并把所有tile标记为待清除，tile在首次写入时才初始化，
+    // 一帧结束时仍未写入的tile由resolveColorTarget只填充颜色
     void clear(const Vec4f &color = Vec4f(0.0f), float depth = 1.0f);
 
+    // 颜色目标：默认使用内部存储；可切换为外部持有的ARGB8888表面（如锁定的SDL流式纹理）。
+    // pitch以像素为单位，传入nullptr恢复内部存储。切换后颜色内容未定义，需要先clear。
+    // 外部目标按只写内存对待（锁定的纹理内存可能是写合并或不缓存的）：只有按行布局、未启用MSAA
+    // 且不需要读回（readback为false）时才直接渲染进去，省去呈现前的整帧复制；
+    // 分块布局、MSAA的样本累积和需要读回颜色（如截图）时渲染到内部存储，由resolveColorTarget写入外部目标。
+    void setColorTarget(uint32_t *target, int pitch, bool readback = false);
+    bool hasExternalColorTarget() const { return externalColorTarget != nullptr; }
+    // 一帧光栅化结束后调用：为未写入的tile填充清除色，渲染到内部存储时再展开到外部目标
+    void resolveColorTarget();
+
     // MSAA 相关
     void enableMSAA(bool enable);
     void accumulateMSAAColor(int x, int y, int sampleIndex, float depth, const Vec4f &color);
@@ -24,18 +59,44 @@ public:
     // Getters
     float getDepth(int x, int y) const;
     float getMSAADepth(int x, int y, int sampleIndex) const;
-    const uint8_t *getData() const;
+    uint32_t getPixel(int x, int y) const // ARGB8888
+    {
+        return isTileCleared(x, y) ? clearColor : colorBuffer[calcColorIndex(x, y)];
+    }
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     bool isMSAAEnabled() const { return msaaEnabled; }
+    // 按行展开颜色到dst（每行width个像素），待清除的tile写入清除色。
+    // 只读取内部存储：直接渲染到外部目标时内部存储不含本帧内容，需要读回时应以readback设置颜色目标
     void copyToPlatform(uint32_t* dst) const;
+    // 颜色展开、复制和未写入tile的填充中每个任务处理的tile行数
+    void setResolveGrain(int tileRows) { resolveGrain = tileRows > 0 ? tileRows : 1; }
 
 private:
     // 核心数据
     int width, height;
-    uint8_t* colorBuffer;  // 颜色缓冲区
+    FrameBufferLayout layout;
+    int tilesX, tilesY;         // 分块布局的tile数（边缘tile补齐为完整tile）
+    uint32_t* colorBuffer;      // 当前颜色目标（ARGB8888，0xAARRGGBB）
+    uint32_t* ownedColorBuffer; // 内部颜色存储
+    int colorPitch;             // 颜色目标每行的像素数（仅按行布局）
+    uint32_t* externalColorTarget = nullptr; // 外部颜色目标（按行布局，只写）
+    int externalColorPitch = 0;
+    bool colorReadback = false; // 帧结束后需要读回颜色，不直接渲染到外部目标
     float* depthBuffer;    // 深度缓冲区
 
+    // 延迟清除的tile状态（与分块布局共用TILE_SIZE的tile划分，两种布局都使用）
+    enum TileState : uint8_t
+    {
+        TILE_READY = 0,     // 内容有效
+        TILE_CLEAR_PENDING, // 内容过期，读取时视为清除值
+        TILE_CLEARING       // 某个线程正在初始化
+    };
+    std::unique_ptr<std::atomic<uint8_t>[]> tileStates;
+    uint32_t clearColor = 0;
+    int resolveGrain = 1; // 展开任务的tile行数
+    float clearDepth = 1.0f;
+
     // MSAA 相关
     bool msaaEnabled;
     float* msaaDepthBuffer; // MSAA深度缓冲区
@@ -43,6 +104,42 @@ private:
 
     // 辅助方法
     bool isValidCoord(int x, int y) const { return x >= 0 && x < width && y >= 0 && y < height; }
-    int calcIndex(int x, int y) const { return y * width + x; }
+    // 分块布局：tile按行排列，tile内按行存储
+    int calcTiledIndex(int x, int y) const
+    {
+        return ((y / TILE_SIZE) * tilesX + x / TILE_SIZE) * TILE_PIXELS + (y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE;
+    }
+    int calcIndex(int x, int y) const
+    {
+        return layout == FrameBufferLayout::TILED ? calcTiledIndex(x, y) : y * width + x;
+    }
+    int calcColorIndex(int x, int y) const
+    {
+        return layout == FrameBufferLayout::TILED ? calcTiledIndex(x, y) : y * colorPitch + x;
+    }
     int calcMSAAIndex(int x, int y, int sampleIndex) const;
+    int calcTileIndex(int x, int y) const { return (y / TILE_SIZE) * tilesX + x / TILE_SIZE; }
+    bool isTileCleared(int x, int y) const
+    {
+        return tileStates[calcTileIndex(x, y)].load(std::memory_order_acquire) != TILE_READY;
+    }
+    // 写入前确保像素所在tile已初始化
+    void ensureTile(int x, int y)
+    {
+        const int tile = calcTileIndex(x, y);
+        if (tileStates[tile].load(std::memory_order_acquire) != TILE_READY) {
+            initializeTile(tile);
+        }
+    }
+    // 用清除值填充tile，多个线程同时首次写入时只有一个执行填充，其余等待
+    void initializeTile(int tile);
+    void fillTileColor(int tileX, int tileY);
+    // 每个缓冲区的元素数（分块布局包含补齐部分）
+    size_t bufferPixelCount() const;
+    void allocateBuffers();
+    void releaseBuffers();
+    // 根据布局、MSAA和读回需求选择渲染到外部目标还是内部存储
+    void selectColorBuffer();
+    // 内部存储按行展开到dst
+    void linearizeColor(uint32_t *dst, int dstPitch) const;
 };
@@ -0,0 +1,315 @@
+// job_system.cpp
+#include "job_system.h"
+#include "profiler.h"
+#include <cassert>
+#include <cstdlib>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    // 空闲工作线程休眠前的自旋轮数
+    constexpr int IDLE_SPIN_COUNT = 64;
+
+    // 进程允许运行的逻辑CPU列表。taskset、容器和cgroup的cpuset都会限制亲和性掩码，
+    // 因此不能假设可以使用0..hardware_concurrency-1
+    std::vector<int> queryAllowedCpus()
+    {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &cpuset))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+        if (cpus.empty())
+        {
+            const int coreCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            for (int cpu = 0; cpu < coreCount; ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    // 将线程绑定到指定核心，避免被迁移导致缓存失效（仅Linux支持）
+    void pinThreadToCore(std::thread &thread, int core)
+    {
+#ifdef __linux__
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(core, &cpuset);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset);
+#else
+        (void)thread;
+        (void)core;
+#endif
+    }
+}
+
+JobSystem::JobSystem()
+{
+    // 工作者数量默认等于进程可用的CPU数，可用环境变量SR_WORKER_THREADS覆盖（取代原来的OMP_NUM_THREADS）
+    allowedCpus = queryAllowedCpus();
+    int workerCount = static_cast<int>(allowedCpus.size());
+    if (const char *env = std::getenv("SR_WORKER_THREADS"))
+    {
+        workerCount = std::max(1, std::atoi(env));
+    }
+    startWorkers(workerCount);
+}
+
+JobSystem::~JobSystem()
+{
+    stopWorkers();
+}
+
+void JobSystem::setWorkerCount(int workerCount)
+{
+    workerCount = std::max(1, workerCount);
+    if (workerCount == getWorkerCount())
+    {
+        return;
+    }
+    assert(currentWorkerIndex() == 0 && pendingJobs.load() == 0);
+    stopWorkers();
+    startWorkers(workerCount);
+}
+
+void JobSystem::startWorkers(int workerCount)
+{
+    stopping.store(false);
+    queues.clear();
+    queues.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i)
+    {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    // 第0号工作者是调用线程，其余为常驻线程；只在每个工作者都能独占一个可用CPU时绑定，
+    // 第0个可用CPU留给调用线程
+    threads.reserve(workerCount - 1);
+    const bool pinWorkers = workerCount <= static_cast<int>(allowedCpus.size());
+    for (int i = 1; i < workerCount; ++i)
+    {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+        if (pinWorkers)
+        {
+            pinThreadToCore(threads.back(), allowedCpus[i]);
+        }
+    }
+}
+
+void JobSystem::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    sleepCondition.notify_all();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    threads.clear();
+}
+
+std::vector<Job> &JobSystem::scratchJobs(int count)
+{
+    static thread_local std::vector<Job> jobs;
+    if (static_cast<int>(jobs.size()) < count)
+    {
+        jobs.resize(count);
+    }
+    return jobs;
+}
+
+void JobSystem::submit(const Job *jobs, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    WorkerQueue &queue = *queues[currentWorkerIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.insert(queue.jobs.end(), jobs, jobs + count);
+    }
+    pendingJobs.fetch_add(static_cast<int>(count), std::memory_order_release);
+
+    // 先获取休眠锁再通知，避免工作线程在检查条件和进入等待之间错过唤醒
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    if (count == 1)
+    {
+        sleepCondition.notify_one();
+    }
+    else
+    {
+        sleepCondition.notify_all();
+    }
+}
+
+bool JobSystem::tryGetJob(int workerIndex, Job &job)
+{
+    if (pendingJobs.load(std::memory_order_acquire) <= 0)
+    {
+        return false;
+    }
+
+    // 本队列：从尾部取最近提交的任务
+    {
+        WorkerQueue &queue = *queues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+            pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // 窃取：从相邻的队列开始轮询，取头部最早提交的任务
+    const int workerCount = getWorkerCount();
+    for (int offset = 1; offset < workerCount; ++offset)
+    {
+        WorkerQueue &victim = *queues[(workerIndex + offset) % workerCount];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (lock.owns_lock() && !victim.jobs.empty())
+        {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(const Job &job)
+{
+    job.function(job.data, job.begin, job.end);
+    job.counter->fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::wait(const JobCounter &counter)
+{
+    const int workerIndex = currentWorkerIndex();
+    Job job;
+    while (counter.load(std::memory_order_acquire) > 0)
+    {
+        if (tryGetJob(workerIndex, job))
+        {
+            execute(job);
+        }
+        else
+        {
+            // 剩余任务正在其他线程上执行
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(int workerIndex)
+{
+    currentWorkerIndex() = workerIndex;
+    Profiler::getInstance().setThreadName("worker " + std::to_string(workerIndex));
+    Job job;
+    int idleSpins = 0;
+    while (!stopping.load(std::memory_order_relaxed))
+    {
+        if (tryGetJob(workerIndex, job))
+        {
+            execute(job);
+            idleSpins = 0;
+            continue;
+        }
+
+        if (++idleSpins < IDLE_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // 长时间没有任务时休眠，直到有新任务提交
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this] {
+            return stopping.load(std::memory_order_relaxed) || pendingJobs.load(std::memory_order_acquire) > 0;
+        });
+        idleSpins = 0;
+    }
+}
+
+TaskGraph::TaskId TaskGraph::addTask(std::function<void()> function, std::initializer_list<TaskId> dependencies)
+{
+    const TaskId id = static_cast<TaskId>(nodes.size());
+    auto node = std::make_unique<Node>();
+    node->function = std::move(function);
+    for (TaskId dependency : dependencies)
+    {
+        // 只能依赖已添加的任务，因此图中不会有环
+        assert(dependency >= 0 && dependency < id);
+        nodes[dependency]->dependents.push_back(id);
+        ++node->dependencyCount;
+    }
+    nodes.push_back(std::move(node));
+    return id;
+}
+
+void TaskGraph::submitNode(TaskId id)
+{
+    const Job job{&TaskGraph::runNode, this, id, id + 1, &counter};
+    JobSystem::getInstance().submit(&job, 1);
+}
+
+void TaskGraph::runNode(const void *data, int begin, int /*end*/)
+{
+    TaskGraph &graph = *const_cast<TaskGraph *>(static_cast<const TaskGraph *>(data));
+    Node &node = *graph.nodes[begin];
+    node.function();
+
+    // 依赖者在本任务计数之前入队，计数器不会提前归零
+    for (TaskId dependent : node.dependents)
+    {
+        if (graph.nodes[dependent]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            graph.submitNode(dependent);
+        }
+    }
+}
+
+void TaskGraph::run()
+{
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    counter.store(static_cast<int>(nodes.size()), std::memory_order_relaxed);
+    for (const auto &node : nodes)
+    {
+        node->remaining.store(node->dependencyCount, std::memory_order_relaxed);
+    }
+    for (TaskId id = 0; id < static_cast<TaskId>(nodes.size()); ++id)
+    {
+        if (nodes[id]->dependencyCount == 0)
+        {
+            submitNode(id);
+        }
+    }
+    JobSystem::getInstance().wait(counter);
+}
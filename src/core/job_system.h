@@ -0,0 +1,193 @@
+// job_system.h
+// 常驻工作线程 + 每线程双端队列的work-stealing任务调度器，渲染各阶段的并行循环和任务图共用
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 任务计数器：提交时递增，任务完成时递减，归零表示该批任务全部完成
+using JobCounter = std::atomic<int>;
+
+// 单个任务：函数指针 + 闭包指针 + 区间，避免std::function的堆分配
+struct Job
+{
+    void (*function)(const void *data, int begin, int end);
+    const void *data;
+    int begin;
+    int end;
+    JobCounter *counter;
+};
+
+/**
+ * 任务调度器
+ *
+ * - 启动时按进程的CPU亲和性掩码（sched_getaffinity）创建 可用CPU数 - 1 个常驻工作线程
+ *   （Linux下绑定到掩码内各自的核心，环境变量SR_WORKER_THREADS可指定工作者总数），
+ *   调用线程作为第0号工作者参与执行，不再每帧创建线程。
+ * - 每个工作者有自己的双端队列：拥有者从尾部取（后进先出，缓存友好），
+ *   空闲工作者从其他队列头部窃取（先进先出，取到较大的剩余任务）。
+ * - 等待计数器时调用线程持续执行任务而不是阻塞，嵌套的parallelFor不会超额订阅线程。
+ * - 非工作线程提交的任务进入第0号队列。
+ */
+class JobSystem
+{
+public:
+    // 单例模式获取实例，首次调用时启动工作线程
+    static JobSystem &getInstance()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // 工作者总数（包含调用线程）
+    int getWorkerCount() const { return static_cast<int>(queues.size()); }
+    // 当前线程的工作者索引：工作线程为1..N-1，其他线程为0
+    int getCurrentWorkerIndex() const { return currentWorkerIndex(); }
+    // 重新设置工作者总数（包含调用线程）并重启工作线程，用于基准测试扫描线程数
+    // 调用时不能有未完成的任务，只能在非工作线程上调用
+    void setWorkerCount(int workerCount);
+
+    // 提交一批任务，counter在任务完成时递减
+    void submit(const Job *jobs, size_t count);
+    // 等待计数器归零，期间执行队列中的任务
+    void wait(const JobCounter &counter);
+
+    /**
+     * 并行遍历[begin, end)，按grain大小切分为任务，func(chunkBegin, chunkEnd)
+     * 区间不超过一个grain或只有一个工作者时直接在调用线程执行
+     */
+    template <typename Func>
+    void parallelForRange(int begin, int end, int grain, const Func &func)
+    {
+        const int count = end - begin;
+        if (count <= 0)
+        {
+            return;
+        }
+        grain = std::max(grain, 1);
+        if (count <= grain || getWorkerCount() == 1)
+        {
+            func(begin, end);
+            return;
+        }
+
+        const int jobCount = (count + grain - 1) / grain;
+        JobCounter counter(jobCount);
+        std::vector<Job> &jobs = scratchJobs(jobCount);
+        for (int i = 0; i < jobCount; ++i)
+        {
+            const int chunkBegin = begin + i * grain;
+            jobs[i] = {&invokeRange<Func>, &func, chunkBegin, std::min(end, chunkBegin + grain), &counter};
+        }
+        submit(jobs.data(), jobCount);
+        wait(counter);
+    }
+
+    // 并行遍历[begin, end)，func(i)
+    template <typename Func>
+    void parallelFor(int begin, int end, int grain, const Func &func)
+    {
+        parallelForRange(begin, end, grain, [&func](int chunkBegin, int chunkEnd) {
+            for (int i = chunkBegin; i < chunkEnd; ++i)
+            {
+                func(i);
+            }
+        });
+    }
+
+    // 按工作者数量自动选择grain：每个工作者约taskPerWorker个任务，用于负载不均的循环
+    int autoGrain(int count, int taskPerWorker = 4) const
+    {
+        return std::max(1, count / (getWorkerCount() * taskPerWorker));
+    }
+
+private:
+    JobSystem();
+    ~JobSystem();
+
+    // 每个工作者的任务队列
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    std::vector<int> allowedCpus;    // 进程允许运行的逻辑CPU，工作线程只绑定到其中的核心
+    std::atomic<int> pendingJobs{0}; // 已提交未取走的任务数，空闲线程据此决定是否休眠
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+
+    static int &currentWorkerIndex()
+    {
+        static thread_local int index = 0;
+        return index;
+    }
+
+    // 每个线程复用的任务数组（提交时已复制进队列，嵌套调用可安全复用）
+    static std::vector<Job> &scratchJobs(int count);
+
+    template <typename Func>
+    static void invokeRange(const void *data, int begin, int end)
+    {
+        (*static_cast<const Func *>(data))(begin, end);
+    }
+
+    void startWorkers(int workerCount);
+    void stopWorkers();
+    void workerLoop(int workerIndex);
+    // 先取本队列尾部，再按顺序窃取其他队列头部
+    bool tryGetJob(int workerIndex, Job &job);
+    static void execute(const Job &job);
+};
+
+/**
+ * 任务图：按依赖关系调度一组任务，依赖全部完成后任务才进入队列
+ *
+ *   TaskGraph graph;
+ *   auto a = graph.addTask(fa);
+ *   auto b = graph.addTask(fb, {a});
+ *   graph.run(); // 返回时全部完成
+ */
+class TaskGraph
+{
+public:
+    using TaskId = int;
+
+    TaskId addTask(std::function<void()> function, std::initializer_list<TaskId> dependencies = {});
+    // 执行全部任务并等待完成，可重复调用
+    void run();
+    void clear() { nodes.clear(); }
+    size_t size() const { return nodes.size(); }
+
+private:
+    struct Node
+    {
+        std::function<void()> function;
+        std::vector<TaskId> dependents;
+        int dependencyCount = 0;
+        std::atomic<int> remaining{0};
+    };
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    JobCounter counter{0};
+
+    static void runNode(const void *data, int begin, int end);
+    void submitNode(TaskId id);
+};
@@ -0,0 +1,444 @@
+/**
+ * @file renderer_depth.cpp
+ * @brief 仅深度光栅化实现：只插值z，不运行片段着色器，直接写入深度目标
+ */
+#include "maths.h"
+#include "renderer.h"
+#include "mesh.h"
+#include "job_system.h"
+#include "simd_dispatch.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr float EPSILON = 1e-6f;
+
+    // 每个并行任务负责的行带高度，行带之间互不重叠因此无需同步
+    constexpr int DEPTH_BAND_HEIGHT = 32;
+
+    // 三角形设置阶段每个任务处理的三角形数
+    constexpr int DEPTH_SETUP_GRAIN = 256;
+
+    // 顶点位置按固定步长连续存放，可以整块交给transformPositions
+    static_assert(sizeof(Triangle) == 3 * sizeof(Vertex), "Triangle的顶点必须连续存放");
+    static_assert(sizeof(Vertex) % sizeof(float) == 0, "Vertex必须由float组成");
+    constexpr size_t VERTEX_STRIDE = sizeof(Vertex) / sizeof(float);
+
+    // 按顺序访问的三角形顶点位置，每次用transformPositions变换DEPTH_SETUP_GRAIN个三角形。
+    // 只有一个工作者时parallelForRange把整个区间交给一次调用，因此不能按区间大小分配缓冲区
+    class TransformedTriangles
+    {
+    public:
+        TransformedTriangles(const SimdKernels &kernels, const Matrix4x4f &matrix,
+                             const std::vector<Triangle> &triangles, int end)
+            : kernels(kernels), matrix(matrix), triangles(triangles), end(end) {}
+
+        // 三角形的三个顶点变换后的齐次坐标，共12个float
+        const float *get(int triangle)
+        {
+            if (triangle < batchBegin || triangle >= batchEnd)
+            {
+                batchBegin = triangle;
+                batchEnd = std::min(end, triangle + DEPTH_SETUP_GRAIN);
+                kernels.transformPositions(matrix.m, &triangles[triangle].vertices[0].position.x, VERTEX_STRIDE,
+                                           static_cast<size_t>(batchEnd - batchBegin) * 3, positions);
+            }
+            return positions + (triangle - batchBegin) * 12;
+        }
+
+    private:
+        const SimdKernels &kernels;
+        const Matrix4x4f &matrix;
+        const std::vector<Triangle> &triangles;
+        int end;
+        int batchBegin = 0;
+        int batchEnd = 0;
+        float positions[DEPTH_SETUP_GRAIN * 3 * 4];
+    };
+}
+
+// 仅深度三角形设置：透视除法、剔除、边界框、边缘函数和深度平面
+static bool setupDepthTriangle(
+    DepthTriangle &tri,
+    const Vec4f &clip0, const Vec4f &clip1, const Vec4f &clip2,
+    float cullSign,
+    int width, int height)
+{
+    tri.valid = false;
+
+    const Vec4f *clips[3] = {&clip0, &clip1, &clip2};
+    std::array<Vec3f, 3> screen;
+    for (int i = 0; i < 3; ++i)
+    {
+        const Vec4f &clip = *clips[i];
+        if (clip.w <= EPSILON)
+        {
+            return false;
+        }
+        const float invW = 1.0f / clip.w;
+        screen[i] = Vec3f(
+            (clip.x * invW + 1.0f) * 0.5f * width,
+            (1.0f - clip.y * invW) * 0.5f * height,
+            clip.z * invW);
+    }
+
+    // 背面剔除（与Renderer::faceCull一致）
+    const float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) -
+                       (screen[1].y - screen[0].y) * (screen[2].x - screen[0].x);
+    if (area * cullSign <= EPSILON)
+    {
+        return false;
+    }
+
+    tri.minX = std::max(0, static_cast<int>(std::floor(std::min({screen[0].x, screen[1].x, screen[2].x}))));
+    tri.minY = std::max(0, static_cast<int>(std::floor(std::min({screen[0].y, screen[1].y, screen[2].y}))));
+    tri.maxX = std::min(width - 1, static_cast<int>(std::ceil(std::max({screen[0].x, screen[1].x, screen[2].x}))));
+    tri.maxY = std::min(height - 1, static_cast<int>(std::ceil(std::max({screen[0].y, screen[1].y, screen[2].y}))));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+    {
+        return false;
+    }
+
+    // 边缘函数 e(x, y) = dx * y + dy * x + c，与Renderer::setupEdgeFunctions相同
+    for (int i = 0; i < 3; ++i)
+    {
+        const Vec3f &a = screen[i];
+        const Vec3f &b = screen[(i + 1) % 3];
+        EdgeFunction &edge = tri.edges[i];
+        edge.dy = b.y - a.y;
+        edge.dx = a.x - b.x;
+        edge.c = -(edge.dx * a.y + edge.dy * a.x);
+        edge.rowIncrement = edge.dx;
+        edge.colIncrement = edge.dy;
+    }
+
+    // 内部点的边缘函数值符号为-area，统一翻转为非负
+    if (area > 0.0f)
+    {
+        for (EdgeFunction &edge : tri.edges)
+        {
+            edge.dx = -edge.dx;
+            edge.dy = -edge.dy;
+            edge.c = -edge.c;
+            edge.rowIncrement = edge.dx;
+            edge.colIncrement = edge.dy;
+        }
+    }
+
+    // 屏幕空间深度是仿射的：z = (e1 * z0 + e2 * z1 + e0 * z2) / |area|
+    const float invArea = 1.0f / std::abs(area);
+    const auto &e = tri.edges;
+    tri.zdx = (e[1].dy * screen[0].z + e[2].dy * screen[1].z + e[0].dy * screen[2].z) * invArea;
+    tri.zdy = (e[1].dx * screen[0].z + e[2].dx * screen[1].z + e[0].dx * screen[2].z) * invArea;
+    tri.zc = (e[1].c * screen[0].z + e[2].c * screen[1].z + e[0].c * screen[2].z) * invArea;
+    tri.valid = true;
+    return true;
+}
+
+// 在行带[bandMinY, bandMaxY]内光栅化一个仅深度三角形
+static void rasterizeDepthBand(
+    const DepthTriangle &tri,
+    int bandMinY, int bandMaxY,
+    float *depthTarget, int width)
+{
+    const int minY = std::max(tri.minY, bandMinY);
+    const int maxY = std::min(tri.maxY, bandMaxY);
+    const auto &edges = tri.edges;
+    const SimdKernels &kernels = simdKernels();
+    const float steps[3] = {edges[0].colIncrement, edges[1].colIncrement, edges[2].colIncrement};
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        const float pixelY = y + 0.5f;
+        const float startX = tri.minX + 0.5f;
+
+        // 行内的边函数和深度为起始值加列增量的倍数，可以整行向量化
+        const float start[3] = {
+            edges[0].dx * pixelY + edges[0].dy * startX + edges[0].c,
+            edges[1].dx * pixelY + edges[1].dy * startX + edges[1].c,
+            edges[2].dx * pixelY + edges[2].dy * startX + edges[2].c};
+        const float z = tri.zdx * startX + tri.zdy * pixelY + tri.zc;
+
+        float *row = depthTarget + static_cast<size_t>(y) * width;
+        kernels.depthRow(start, steps, z, tri.zdx, tri.maxX - tri.minX + 1, row + tri.minX);
+    }
+}
+
+// 按近平面（z >= -w）裁剪后设置，输出0~2个三角形到out，返回有效三角形数量
+static int setupClippedDepthTriangles(
+    DepthTriangle *out,
+    const std::array<Vec4f, 3> &clip,
+    float cullSign,
+    int width, int height)
+{
+    float dist[3];
+    int insideCount = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        dist[i] = clip[i].z + clip[i].w;
+        insideCount += dist[i] >= 0.0f ? 1 : 0;
+    }
+
+    if (insideCount == 3)
+    {
+        return setupDepthTriangle(out[0], clip[0], clip[1], clip[2], cullSign, width, height) ? 1 : 0;
+    }
+    if (insideCount == 0)
+    {
+        return 0;
+    }
+
+    // Sutherland-Hodgman：与单个平面裁剪后最多得到四边形，保持原绕序
+    Vec4f polygon[4];
+    int vertexCount = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const int j = (i + 1) % 3;
+        if (dist[i] >= 0.0f)
+        {
+            polygon[vertexCount++] = clip[i];
+        }
+        if ((dist[i] >= 0.0f) != (dist[j] >= 0.0f))
+        {
+            const float t = dist[i] / (dist[i] - dist[j]);
+            polygon[vertexCount++] = clip[i] + (clip[j] - clip[i]) * t;
+        }
+    }
+
+    int count = 0;
+    for (int k = 1; k + 1 < vertexCount; ++k)
+    {
+        if (setupDepthTriangle(out[count], polygon[0], polygon[k], polygon[k + 1], cullSign, width, height))
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// 按行带并行光栅化一组目标（每个目标width * height），带内按提交顺序处理三角形
+static void rasterizeDepthTargets(
+    const std::vector<DepthTriangle> *triangleLists,
+    float *const *depthTargets,
+    int targetCount, int width, int height)
+{
+    const int bandCount = (height + DEPTH_BAND_HEIGHT - 1) / DEPTH_BAND_HEIGHT;
+    const int taskCount = targetCount * bandCount;
+
+    JobSystem::getInstance().parallelFor(0, taskCount, 1, [&](int task) {
+        PROFILE_SCOPE("Depth::band");
+        const int target = task / bandCount;
+        const int band = task % bandCount;
+        const int bandMinY = band * DEPTH_BAND_HEIGHT;
+        const int bandMaxY = std::min(height - 1, bandMinY + DEPTH_BAND_HEIGHT - 1);
+        for (const DepthTriangle &tri : triangleLists[target])
+        {
+            if (tri.valid && tri.minY <= bandMaxY && tri.maxY >= bandMinY)
+            {
+                rasterizeDepthBand(tri, bandMinY, bandMaxY, depthTargets[target], width);
+            }
+        }
+    });
+}
+
+// 仅深度渲染：使用当前视图/投影矩阵，结果写入depthTarget（width * height个float）
+void Renderer::renderDepthOnly(
+    const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &meshes,
+    float *depthTarget, int width, int height, bool clearTarget)
+{
+    if (!depthTarget || width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    const SimdKernels &kernels = simdKernels();
+    if (clearTarget)
+    {
+        kernels.fillFloat(depthTarget, static_cast<size_t>(width) * height, 1.0f);
+    }
+
+    // 1. 三角形设置（按三角形并行），每个输入三角形近平面裁剪后最多产生两个三角形
+    size_t triangleCount = 0;
+    for (const auto &[mesh, modelMatrix] : meshes)
+    {
+        triangleCount += mesh ? mesh->getTriangles().size() : 0;
+    }
+    depthTriangles.resize(triangleCount * 2);
+
+    const Matrix4x4f viewProj = projMatrix * viewMatrix;
+    const float cullSign = (projMatrix.m11 < 0) ? 1.0f : -1.0f;
+    // 正交投影下w恒为1，近平面之前的三角形不需要裁剪，深度值小于-1照常写入
+    // （方向光阴影中位于光源和级联区域之间的投射者因此不必扩展近平面）
+    const bool orthographic = projMatrix.m30 == 0.0f && projMatrix.m31 == 0.0f && projMatrix.m32 == 0.0f;
+    size_t base = 0;
+    for (const auto &[mesh, modelMatrix] : meshes)
+    {
+        if (!mesh)
+        {
+            continue;
+        }
+        const std::vector<Triangle> &triangles = mesh->getTriangles();
+        const Matrix4x4f mvp = viewProj * modelMatrix;
+        const int count = static_cast<int>(triangles.size());
+
+        JobSystem::getInstance().parallelForRange(0, count, DEPTH_SETUP_GRAIN, [&](int chunkBegin, int chunkEnd) {
+            TransformedTriangles clipPositions(kernels, mvp, triangles, chunkEnd);
+            for (int i = chunkBegin; i < chunkEnd; ++i)
+            {
+                const float *p = clipPositions.get(i);
+                const std::array<Vec4f, 3> clip = {
+                    Vec4f(p[0], p[1], p[2], p[3]),
+                    Vec4f(p[4], p[5], p[6], p[7]),
+                    Vec4f(p[8], p[9], p[10], p[11])};
+                DepthTriangle *slots = &depthTriangles[(base + i) * 2];
+                const int produced = orthographic
+                                         ? (setupDepthTriangle(slots[0], clip[0], clip[1], clip[2], cullSign, width, height) ? 1 : 0)
+                                         : setupClippedDepthTriangles(slots, clip, cullSign, width, height);
+                for (int k = produced; k < 2; ++k)
+                {
+                    slots[k].valid = false;
+                }
+            }
+        });
+        base += triangles.size();
+    }
+
+    // 2. 按行带并行光栅化
+    rasterizeDepthTargets(&depthTriangles, &depthTarget, 1, width, height);
+}
+
+// 立方体阴影各面的视图投影矩阵，面顺序为 +X, -X, +Y, -Y, +Z, -Z
+std::array<Matrix4x4f, 6> computeCubeFaceViewProj(const Vec3f &center, float zNear, float zFar)
+{
+    static const Vec3f directions[6] = {
+        Vec3f(1.0f, 0.0f, 0.0f), Vec3f(-1.0f, 0.0f, 0.0f),
+        Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, -1.0f, 0.0f),
+        Vec3f(0.0f, 0.0f, 1.0f), Vec3f(0.0f, 0.0f, -1.0f)};
+    static const Vec3f ups[6] = {
+        Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f),
+        Vec3f(0.0f, 0.0f, -1.0f), Vec3f(0.0f, 0.0f, 1.0f),
+        Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f)};
+
+    const Matrix4x4f proj = Matrix4x4f::perspective(3.14159265f * 0.5f, 1.0f, zNear, zFar);
+    std::array<Matrix4x4f, 6> result;
+    for (int face = 0; face < 6; ++face)
+    {
+        result[face] = proj * Matrix4x4f::lookAt(center, center + directions[face], ups[face]);
+    }
+    return result;
+}
+
+// 单遍立方体深度渲染：每个顶点只做一次模型变换，三角形只分箱到与其相交的面
+void Renderer::renderDepthCube(
+    const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &meshes,
+    const Vec3f &center, float zNear, float zFar,
+    float *depthTarget, int faceSize, bool clearTarget)
+{
+    if (!depthTarget || faceSize <= 0)
+    {
+        return;
+    }
+
+    const size_t faceTexels = static_cast<size_t>(faceSize) * faceSize;
+    const SimdKernels &kernels = simdKernels();
+    if (clearTarget)
+    {
+        kernels.fillFloat(depthTarget, faceTexels * 6, 1.0f);
+    }
+
+    const std::array<Matrix4x4f, 6> faceViewProj = computeCubeFaceViewProj(center, zNear, zFar);
+    const float cullSign = -1.0f; // 透视投影的m11为正
+
+    // 1. 分箱与三角形设置：每个任务块写入自己的分面列表，最后按块顺序合并，结果与调度无关
+    size_t chunkCount = 0;
+    for (const auto &[mesh, modelMatrix] : meshes)
+    {
+        chunkCount += mesh ? (mesh->getTriangles().size() + DEPTH_SETUP_GRAIN - 1) / DEPTH_SETUP_GRAIN : 0;
+    }
+    std::vector<std::array<std::vector<DepthTriangle>, 6>> chunkBins(chunkCount);
+    size_t chunkBase = 0;
+    for (const auto &[mesh, modelMatrix] : meshes)
+    {
+        if (!mesh)
+        {
+            continue;
+        }
+        const std::vector<Triangle> &triangles = mesh->getTriangles();
+        const int count = static_cast<int>(triangles.size());
+
+        JobSystem::getInstance().parallelForRange(0, count, DEPTH_SETUP_GRAIN, [&](int chunkBegin, int chunkEnd) {
+            std::array<std::vector<DepthTriangle>, 6> &bins = chunkBins[chunkBase + chunkBegin / DEPTH_SETUP_GRAIN];
+            TransformedTriangles worldPositions(kernels, modelMatrix, triangles, chunkEnd);
+            for (int i = chunkBegin; i < chunkEnd; ++i)
+            {
+                // 世界空间位置及相对光源的位置
+                const float *positions = worldPositions.get(i);
+                std::array<Vec3f, 3> world;
+                float rel[3][3];
+                for (int v = 0; v < 3; ++v)
+                {
+                    const float *p = positions + v * 4;
+                    world[v] = Vec3f(p[0], p[1], p[2]);
+                    rel[v][0] = world[v].x - center.x;
+                    rel[v][1] = world[v].y - center.y;
+                    rel[v][2] = world[v].z - center.z;
+                }
+
+                for (int face = 0; face < 6; ++face)
+                {
+                    // 该面的视锥为 m >= |b| 且 m >= |c|（m为主轴坐标），三个顶点都在同一平面外侧时剔除
+                    const int axis = face / 2;
+                    const float sign = (face & 1) ? -1.0f : 1.0f;
+                    const int axisB = (axis + 1) % 3;
+                    const int axisC = (axis + 2) % 3;
+                    bool outside[5] = {true, true, true, true, true};
+                    for (int v = 0; v < 3; ++v)
+                    {
+                        const float m = sign * rel[v][axis];
+                        const float b = rel[v][axisB];
+                        const float c = rel[v][axisC];
+                        outside[0] = outside[0] && (m < zNear);
+                        outside[1] = outside[1] && (m - b < 0.0f);
+                        outside[2] = outside[2] && (m + b < 0.0f);
+                        outside[3] = outside[3] && (m - c < 0.0f);
+                        outside[4] = outside[4] && (m + c < 0.0f);
+                    }
+                    if (outside[0] || outside[1] || outside[2] || outside[3] || outside[4])
+                    {
+                        continue;
+                    }
+
+                    const std::array<Vec4f, 3> clip = {
+                        faceViewProj[face] * Vec4f(world[0], 1.0f),
+                        faceViewProj[face] * Vec4f(world[1], 1.0f),
+                        faceViewProj[face] * Vec4f(world[2], 1.0f)};
+                    DepthTriangle produced[2];
+                    const int producedCount = setupClippedDepthTriangles(produced, clip, cullSign, faceSize, faceSize);
+                    for (int k = 0; k < producedCount; ++k)
+                    {
+                        bins[face].push_back(produced[k]);
+                    }
+                }
+            }
+        });
+        chunkBase += (triangles.size() + DEPTH_SETUP_GRAIN - 1) / DEPTH_SETUP_GRAIN;
+    }
+
+    for (int face = 0; face < 6; ++face)
+    {
+        std::vector<DepthTriangle> &faceTriangles = cubeFaceTriangles[face];
+        faceTriangles.clear();
+        for (auto &bins : chunkBins)
+        {
+            faceTriangles.insert(faceTriangles.end(), bins[face].begin(), bins[face].end());
+        }
+    }
+
+    // 2. 六个面的所有行带一起并行光栅化
+    float *faceTargets[6];
+    for (int face = 0; face < 6; ++face)
+    {
+        faceTargets[face] = depthTarget + face * faceTexels;
+    }
+    rasterizeDepthTargets(cubeFaceTriangles.data(), faceTargets, 6, faceSize, faceSize);
+}
@@ -5,7 +5,6 @@
 
  #include "maths.h"
  #include "renderer.h"
- #include <omp.h>
  
  // 全局常量
  constexpr float EPSILON = 1e-6f;
@@ -53,15 +52,14 @@
  }
  
  // 计算片段深度
+ // 透视除法后的z在屏幕空间是仿射的，直接用屏幕空间重心坐标插值，不做透视校正
  float Renderer::calculateFragmentDepth(
      const Vec3f &barycentric,
-     const Vec4f &weights,
      const std::array<ProcessedVertex, 3> &vertices)
  {
-     return (barycentric.x * vertices[0].screenPosition.z * weights.x +
-             barycentric.y * vertices[1].screenPosition.z * weights.y +
-             barycentric.z * vertices[2].screenPosition.z * weights.z) *
-            weights.w;
+     return barycentric.x * vertices[0].screenPosition.z +
+            barycentric.y * vertices[1].screenPosition.z +
+            barycentric.z * vertices[2].screenPosition.z;
  }
  
  // 插值顶点属性
@@ -111,7 +109,20 @@
      const Varyings &interpolatedVaryings,
      std::shared_ptr<IShader> shader)
  {
-     return shader->fragmentShader(interpolatedVaryings);
+     if (overdrawCounts)
+     {
+         // 同一像素的片段不会被两个线程同时处理，直接累加
+         const int x = static_cast<int>(interpolatedVaryings.fragCoord.x);
+         const int y = static_cast<int>(interpolatedVaryings.fragCoord.y);
+         ++overdrawCounts[static_cast<size_t>(y) * frameBuffer->getWidth() + x];
+     }
+     const FragmentOutput output = shader->fragmentShader(interpolatedVaryings);
+     if (PipelineStatistics *stats = currentWorkerStatistics())
+     {
+         ++stats->fragmentsShaded;
+         stats->fragmentsDiscarded += output.discard;
+     }
+     return output;
  }
  
  // 处理标准模式下的单个像素
@@ -137,10 +148,13 @@
      const Vec4f weights = calculatePerspectiveWeights(barycentric, vertices);
  
      // 计算深度值
-     const float depth = calculateFragmentDepth(barycentric, weights, vertices);
+     const float depth = calculateFragmentDepth(barycentric, vertices);
  
      // 深度测试
-     if (!frameBuffer->depthTest(x, y, depth))
+     const bool depthPassed = frameBuffer->depthTest(x, y, depth);
+     if (PipelineStatistics *stats = currentWorkerStatistics())
+         ++(depthPassed ? stats->depthTestsPassed : stats->depthTestsFailed);
+     if (!depthPassed)
          return;
  
      // 计算插值的顶点属性
@@ -149,6 +163,7 @@
          interpolatedVaryings,
          {vertices[0].varying, vertices[1].varying, vertices[2].varying},
          barycentric, weights, depth);
+     interpolatedVaryings.fragCoord = Vec2f(pixelCenterX, pixelCenterY);
  
      // 执行片段着色器
      const FragmentOutput output = processFragment(interpolatedVaryings, shader);
@@ -169,6 +184,9 @@
  {
      // 使用边缘函数优化
      auto edges = setupEdgeFunctions(vertices);
+     PipelineStatistics *stats = currentWorkerStatistics();
+     if (stats)
+         stats->pixelsTested += 4;
      
      std::array<Vec3f, 3> screenPos = {
          vertices[0].screenPosition,
@@ -189,16 +207,20 @@
              const Vec4f weights = calculatePerspectiveWeights(barycentric, vertices);
              
              // 计算深度值
-             const float depth = calculateFragmentDepth(barycentric, weights, vertices);
+             const float depth = calculateFragmentDepth(barycentric, vertices);
              
              // 深度测试
-             if (frameBuffer->msaaDepthTest(x, y, i, depth)) {
+             const bool depthPassed = frameBuffer->msaaDepthTest(x, y, i, depth);
+             if (stats)
+                 ++(depthPassed ? stats->depthTestsPassed : stats->depthTestsFailed);
+             if (depthPassed) {
                  // 插值顶点属性
                  Varyings interpolatedVaryings;
                  interpolateVaryings(
                      interpolatedVaryings,
                      {vertices[0].varying, vertices[1].varying, vertices[2].varying},
                      barycentric, weights, depth);
+                 interpolatedVaryings.fragCoord = Vec2f(sampleX, sampleY);
                  
                  // 执行片段着色器
                  const FragmentOutput output = processFragment(interpolatedVaryings, shader);
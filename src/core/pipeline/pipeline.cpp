@@ -4,39 +4,24 @@
  */
 #include "maths.h"
 #include "renderer.h"
-#include <omp.h>
+#include "job_system.h"
+#include "simd_dispatch.h"
 
 // 全局常量定义
 constexpr int MSAA_SAMPLES = 4;
 constexpr float EPSILON = 1e-6f;
+constexpr int COVERAGE_CHUNK = 256; // 一次覆盖测试的最大像素数（栈上的掩码）
 
 // MSAA 采样偏移
 const Vec2f MSAA_OFFSETS[MSAA_SAMPLES] = {
     {0.25f, 0.25f}, {0.75f, 0.25f}, {0.25f, 0.75f}, {0.75f, 0.75f}};
 
-// 光栅化三角形 - 主入口
-void Renderer::rasterizeTriangle(const Triangle &triangle, std::shared_ptr<IShader> shader) {
-    if (!shader) {
-        std::cerr << "Error: No valid shader provided for triangle rendering.\n";
-        return;
-    }
-    
-    // 使用封装的三角形设置阶段
-    TriangleSetupData setup = setupTriangle(triangle, shader);
-    
-    // 如果三角形无效，直接返回
-    if (!setup.valid) {
-        return;
-    }
-    
-    // 使用封装的三角形遍历阶段
-    traverseTriangle(setup, shader);
-}
-
 // 三角形设置阶段封装
 TriangleSetupData Renderer::setupTriangle(const Triangle &triangle, std::shared_ptr<IShader> shader) {
     TriangleSetupData setup;
     setup.valid = false;
+    setup.cull = TriangleCull::BACKFACE;
+    setup.clipped = false;
     
     // 处理三角形顶点
     processTriangleVertices(triangle, shader, setup.vertices);
@@ -46,6 +31,7 @@ TriangleSetupData Renderer::setupTriangle(const Triangle &triangle, std::shared_
     if (faceCull(setup.vertices, sign)) {
         return setup; // 返回无效的设置数据
     }
+    setup.cull = TriangleCull::OFFSCREEN;
     
     // 计算边界框
     auto [minX, minY, maxX, maxY] = calculateBoundingBox(
@@ -57,6 +43,14 @@ TriangleSetupData Renderer::setupTriangle(const Triangle &triangle, std::shared_
         return setup; // 返回无效的设置数据
     }
     
+    // 部分在屏幕外的三角形只按屏幕裁剪包围盒
+    const float width = static_cast<float>(frameBuffer->getWidth());
+    const float height = static_cast<float>(frameBuffer->getHeight());
+    for (const ProcessedVertex &vertex : setup.vertices) {
+        const Vec3f &p = vertex.screenPosition;
+        setup.clipped |= p.x < 0.0f || p.y < 0.0f || p.x > width || p.y > height;
+    }
+    
     // 设置边界框
     setup.minX = minX;
     setup.minY = minY;
@@ -68,6 +62,7 @@ TriangleSetupData Renderer::setupTriangle(const Triangle &triangle, std::shared_
     
     // 标记为有效
     setup.valid = true;
+    setup.cull = TriangleCull::NONE;
     
     return setup;
 }
@@ -78,7 +73,9 @@ void Renderer::traverseTriangle(const TriangleSetupData &setup, std::shared_ptr<
     int pixelCount = (setup.maxX - setup.minX + 1) * (setup.maxY - setup.minY + 1);
     
     // 根据三角形大小决定是并行还是串行处理
-    if (pixelCount > 1024) {
+    const bool parallel = rasterPath == RasterPath::AUTO ? pixelCount > rasterTuning.parallelPixelThreshold
+                                                         : rasterPath == RasterPath::PARALLEL;
+    if (parallel) {
         // 并行处理较大的三角形
         traverseTriangleParallel(setup, shader);
     } else {
@@ -89,25 +86,30 @@ void Renderer::traverseTriangle(const TriangleSetupData &setup, std::shared_ptr<
 
 // 并行遍历三角形
 void Renderer::traverseTriangleParallel(const TriangleSetupData &setup, std::shared_ptr<IShader> shader) {
+    JobSystem &jobs = JobSystem::getInstance();
     if (msaaEnabled) {
-        #pragma omp parallel for collapse(2) schedule(guided)
-        for (int y = setup.minY; y <= setup.maxY; ++y) 
+        const int rows = setup.maxY - setup.minY + 1;
+        const int grain = rasterTuning.msaaRowsPerTask > 0 ? rasterTuning.msaaRowsPerTask : jobs.autoGrain(rows);
+        jobs.parallelFor(setup.minY, setup.maxY + 1, grain, [&](int y) {
             for (int x = setup.minX; x <= setup.maxX; ++x)
                 rasterizeMSAAPixel(x, y, setup.vertices, shader);
+        });
     } else {
         // 使用块状处理提高缓存命中率
-        const int BLOCK_SIZE = 16; // 可以根据实际缓存大小调整
+        const int blockSize = rasterTuning.blockSize; // 按机器调优，见RasterTuning
+        const int blocksX = (setup.maxX - setup.minX + blockSize) / blockSize;
+        const int blocksY = (setup.maxY - setup.minY + blockSize) / blockSize;
         
-        #pragma omp parallel for collapse(2) schedule(guided)
-        for (int blockY = setup.minY; blockY <= setup.maxY; blockY += BLOCK_SIZE) {
-            for (int blockX = setup.minX; blockX <= setup.maxX; blockX += BLOCK_SIZE) {
-                // 处理当前块
-                int maxBlockY = std::min(blockY + BLOCK_SIZE - 1, setup.maxY);
-                int maxBlockX = std::min(blockX + BLOCK_SIZE - 1, setup.maxX);
-                
-                traverseTriangleBlock(setup, blockX, blockY, maxBlockX, maxBlockY, shader);
-            }
-        }
+        jobs.parallelFor(0, blocksX * blocksY, 1, [&](int block) {
+            // 处理当前块
+            const int blockX = setup.minX + (block % blocksX) * blockSize;
+            const int blockY = setup.minY + (block / blocksX) * blockSize;
+            int maxBlockY = std::min(blockY + blockSize - 1, setup.maxY);
+            int maxBlockX = std::min(blockX + blockSize - 1, setup.maxX);
+            PROFILE_COUNTERS_SCOPE("Raster::block", "pixel", (maxBlockX - blockX + 1) * (maxBlockY - blockY + 1));
+            
+            traverseTriangleBlock(setup, blockX, blockY, maxBlockX, maxBlockY, shader);
+        });
     }
 }
 
@@ -117,27 +119,37 @@ void Renderer::traverseTriangleSerial(const TriangleSetupData &setup, std::share
         for (int y = setup.minY; y <= setup.maxY; ++y) 
             for (int x = setup.minX; x <= setup.maxX; ++x)
                 rasterizeMSAAPixel(x, y, setup.vertices, shader);
+    } else if (deterministicRaster) {
+        // 整个包围盒作为一个块处理，与并行路径使用同一个逐像素求值的kernel
+        traverseTriangleBlock(setup, setup.minX, setup.minY, setup.maxX, setup.maxY, shader);
     } else {
         const auto &edges = setup.edges;
+        if (PipelineStatistics *stats = currentWorkerStatistics()) {
+            stats->pixelsTested += static_cast<uint64_t>(setup.maxX - setup.minX + 1) * (setup.maxY - setup.minY + 1);
+        }
         
         // 对于小三角形，使用更简单的扫描线方法
+        const SimdKernels &kernels = simdKernels();
+        const float steps[3] = {edges[0].dy, edges[1].dy, edges[2].dy};
+        uint8_t mask[COVERAGE_CHUNK];
         for (int y = setup.minY; y <= setup.maxY; ++y) {
             // 计算当前扫描线的起始边函数值
             float pixelY = y + 0.5f;
             float startX = setup.minX + 0.5f;
             
-            float e1_start = edges[0].dx * pixelY + edges[0].dy * startX + edges[0].c;
-            float e2_start = edges[1].dx * pixelY + edges[1].dy * startX + edges[1].c;
-            float e3_start = edges[2].dx * pixelY + edges[2].dy * startX + edges[2].c;
+            const float rowStart[3] = {
+                edges[0].dx * pixelY + edges[0].dy * startX + edges[0].c,
+                edges[1].dx * pixelY + edges[1].dy * startX + edges[1].c,
+                edges[2].dx * pixelY + edges[2].dy * startX + edges[2].c};
             
-            for (int x = setup.minX; x <= setup.maxX; ++x) {
-                // 使用增量更新边函数值
-                float e1 = e1_start + edges[0].dy * (x - setup.minX);
-                float e2 = e2_start + edges[1].dy * (x - setup.minX);
-                float e3 = e3_start + edges[2].dy * (x - setup.minX);
-                
-                if (e1 >= 0 && e2 >= 0 && e3 >= 0) {
-                    rasterizeStandardPixel(x, y, setup.vertices, shader);
+            // 按行求覆盖掩码（边函数值为起始值加增量），再逐个处理覆盖的像素
+            for (int chunkX = setup.minX; chunkX <= setup.maxX; chunkX += COVERAGE_CHUNK) {
+                const int count = std::min(COVERAGE_CHUNK, setup.maxX - chunkX + 1);
+                if (kernels.coverageRow(rowStart, steps, chunkX - setup.minX, count, mask) == 0)
+                    continue;
+                for (int k = 0; k < count; ++k) {
+                    if (mask[k])
+                        rasterizeStandardPixel(chunkX + k, y, setup.vertices, shader);
                 }
             }
         }
@@ -153,6 +165,10 @@ void Renderer::traverseTriangleBlock(
 {
     const auto &edges = setup.edges;
     const auto &vertices = setup.vertices;
+    PipelineStatistics *stats = currentWorkerStatistics();
+    if (stats) {
+        stats->pixelsTested += static_cast<uint64_t>(maxBlockX - blockX + 1) * (maxBlockY - blockY + 1);
+    }
     
     // 计算块的起始点的边函数值
     float startX = blockX + 0.5f;
@@ -196,41 +212,58 @@ void Renderer::traverseTriangleBlock(
         // 这个检查可以进一步优化
     }
     
-    // 处理块内的像素
+    // 处理块内的像素：按行求覆盖掩码，再逐个处理覆盖的像素
+    const SimdKernels &kernels = simdKernels();
+    const float rowSteps[3] = {edges[0].dx, edges[1].dx, edges[2].dx};
+    const float colSteps[3] = {edges[0].dy, edges[1].dy, edges[2].dy};
+    const float constants[3] = {edges[0].c, edges[1].c, edges[2].c};
+    uint8_t mask[COVERAGE_CHUNK];
     for (int y = blockY; y <= maxBlockY; ++y) {
         // 计算当前行的起始边函数值
-        float e1_row = e1_start + edges[0].dx * (y - blockY);
-        float e2_row = e2_start + edges[1].dx * (y - blockY);
-        float e3_row = e3_start + edges[2].dx * (y - blockY);
+        const float rowStart[3] = {
+            e1_start + edges[0].dx * (y - blockY),
+            e2_start + edges[1].dx * (y - blockY),
+            e3_start + edges[2].dx * (y - blockY)};
         
-        for (int x = blockX; x <= maxBlockX; ++x) {
-            // 增量更新边函数值
-            float e1 = e1_row + edges[0].dy * (x - blockX);
-            float e2 = e2_row + edges[1].dy * (x - blockX);
-            float e3 = e3_row + edges[2].dy * (x - blockX);
+        for (int chunkX = blockX; chunkX <= maxBlockX; chunkX += COVERAGE_CHUNK) {
+            const int count = std::min(COVERAGE_CHUNK, maxBlockX - chunkX + 1);
+            // 增量更新边函数值；确定性模式下在像素中心直接求值，结果与块原点无关
+            const int covered = deterministicRaster
+                ? kernels.coverageRowDirect(rowSteps, colSteps, constants, chunkX, y, count, mask)
+                : kernels.coverageRow(rowStart, colSteps, chunkX - blockX, count, mask);
+            if (covered == 0)
+                continue;
             
-            // 如果所有边函数值都大于等于0，则点在三角形内
-            if (e1 >= 0 && e2 >= 0 && e3 >= 0) {
-                // 计算重心坐标（仅在需要时）
-                float pixelX = x + 0.5f;
-                float pixelY = y + 0.5f;
-                Vec3f barycentric = computeBarycentric2D(pixelX, pixelY, 
-                    {vertices[0].screenPosition, vertices[1].screenPosition, vertices[2].screenPosition});
+            for (int k = 0; k < count; ++k) {
+                // 覆盖的像素（三条边函数值都大于等于0）
+                if (mask[k]) {
+                    const int x = chunkX + k;
+                    // 计算重心坐标（仅在需要时）
+                    float pixelX = x + 0.5f;
+                    float pixelY = y + 0.5f;
+                    Vec3f barycentric = computeBarycentric2D(pixelX, pixelY, 
+                        {vertices[0].screenPosition, vertices[1].screenPosition, vertices[2].screenPosition});
                 
-                // 后续处理与原来相同
-                const Vec4f weights = calculatePerspectiveWeights(barycentric, vertices);
-                const float depth = calculateFragmentDepth(barycentric, weights, vertices);
+                    // 后续处理与原来相同
+                    const Vec4f weights = calculatePerspectiveWeights(barycentric, vertices);
+                    const float depth = calculateFragmentDepth(barycentric, vertices);
                 
-                if (frameBuffer->depthTest(x, y, depth)) {
-                    Varyings interpolatedVaryings;
-                    interpolateVaryings(
-                        interpolatedVaryings,
-                        {vertices[0].varying, vertices[1].varying, vertices[2].varying},
-                        barycentric, weights, depth);
+                    const bool depthPassed = frameBuffer->depthTest(x, y, depth);
+                    if (stats) {
+                        ++(depthPassed ? stats->depthTestsPassed : stats->depthTestsFailed);
+                    }
+                    if (depthPassed) {
+                        Varyings interpolatedVaryings;
+                        interpolateVaryings(
+                            interpolatedVaryings,
+                            {vertices[0].varying, vertices[1].varying, vertices[2].varying},
+                            barycentric, weights, depth);
+                        interpolatedVaryings.fragCoord = Vec2f(pixelX, pixelY);
                     
-                    const FragmentOutput output = processFragment(interpolatedVaryings, shader);
-                    if (!output.discard) {
-                        frameBuffer->setPixel(x, y, depth, output.color);
+                        const FragmentOutput output = processFragment(interpolatedVaryings, shader);
+                        if (!output.discard) {
+                            frameBuffer->setPixel(x, y, depth, output.color);
+                        }
                     }
                 }
             }
@@ -248,57 +281,3 @@ bool Renderer::isSampleInTriangle(
     float sampleY = y + msaaSampleOffsets[sampleIndex].y;
     return isPointInTriangle(edges, sampleX, sampleY);
 }
-
-// 保留其他处理函数
-void Renderer::processMSAATriangleParallel(
-    const std::array<ProcessedVertex, 3> &vertices,
-    int minX, int minY, int maxX, int maxY,
-    std::shared_ptr<IShader> shader)
-{
-    // 每块像素的尺寸
-    static const int BLOCK_SIZE = 8;
-    
-    // 设置边缘函数
-    auto edges = setupEdgeFunctions(vertices);
-    
-    // 计算块的边界
-    int startBlockX = minX / BLOCK_SIZE;
-    int startBlockY = minY / BLOCK_SIZE;
-    int endBlockX = (maxX + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    int endBlockY = (maxY + BLOCK_SIZE - 1) / BLOCK_SIZE;
-    
-    // 预计算边缘函数参数（类似扫描线优化）
-    float edgeParams[3 * 4]; // 存储三条边的四个角点的参数
-    
-    // 块级并行处理
-    #pragma omp parallel for collapse(2)
-    for (int blockY = startBlockY; blockY < endBlockY; blockY++) {
-        for (int blockX = startBlockX; blockX < endBlockX; blockX++) {
-            processMSAABlockPixels(vertices, blockX, blockY, endBlockX, endBlockY, edgeParams, shader);
-        }
-    }
-}
-
-// 处理MSAA像素块
-void Renderer::processMSAABlockPixels(
-    const std::array<ProcessedVertex, 3> &vertices,
-    int blockX, int blockY, int maxBlockX, int maxBlockY,
-    const float* edgeParams, std::shared_ptr<IShader> shader)
-{
-    static const int BLOCK_SIZE = 8;
-    int startX = blockX * BLOCK_SIZE;
-    int startY = blockY * BLOCK_SIZE;
-    int endX = std::min(startX + BLOCK_SIZE, frameBuffer->getWidth());
-    int endY = std::min(startY + BLOCK_SIZE, frameBuffer->getHeight());
-    
-    auto edges = setupEdgeFunctions(vertices);
-    
-    // 对块内每个像素进行MSAA处理
-    for (int y = startY; y < endY; y++) {
-        for (int x = startX; x < endX; x++) {
-            // 使用优化的MSAA像素光栅化函数
-            rasterizeMSAAPixel(x, y, vertices, shader);
-        }
-    }
-}
-
@@ -5,7 +5,6 @@
 #include "maths.h"
 #include "renderer.h"
 #include "mesh.h"
-#include <omp.h>
 
 // 全局常量
 constexpr float EPSILON = 1e-6f;
@@ -0,0 +1,147 @@
+// raster_check.cpp
+#include "raster_check.h"
+#include "job_system.h"
+#include "scene.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    constexpr int MSAA_SAMPLES = 4;
+    constexpr size_t MAX_REPORTED_MISMATCHES = 16;
+
+    // 一次渲染的输出：按行展开的颜色和深度（MSAA时每个像素MSAA_SAMPLES个样本深度）
+    struct FrameCapture
+    {
+        std::vector<uint32_t> color;
+        std::vector<float> depth;
+        int depthPerPixel = 1;
+    };
+
+    FrameCapture captureFrame(const FrameBuffer &frameBuffer)
+    {
+        const int width = frameBuffer.getWidth();
+        const int height = frameBuffer.getHeight();
+        FrameCapture capture;
+        capture.depthPerPixel = frameBuffer.isMSAAEnabled() ? MSAA_SAMPLES : 1;
+        capture.color.resize(static_cast<size_t>(width) * height);
+        capture.depth.resize(capture.color.size() * capture.depthPerPixel);
+        frameBuffer.copyToPlatform(capture.color.data());
+
+        float *depth = capture.depth.data();
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                if (capture.depthPerPixel == 1)
+                {
+                    *depth++ = frameBuffer.getDepth(x, y);
+                    continue;
+                }
+                for (int sample = 0; sample < MSAA_SAMPLES; ++sample)
+                {
+                    *depth++ = frameBuffer.getMSAADepth(x, y, sample);
+                }
+            }
+        }
+        return capture;
+    }
+
+    void renderWith(Scene &scene, Renderer &renderer, int workers, RasterPath path)
+    {
+        JobSystem::getInstance().setWorkerCount(workers);
+        renderer.setRasterPath(path);
+        scene.render(renderer);
+        renderer.finishFrame();
+    }
+
+    int channelDifference(uint32_t a, uint32_t b)
+    {
+        int difference = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            const int ca = static_cast<int>((a >> shift) & 0xFF);
+            const int cb = static_cast<int>((b >> shift) & 0xFF);
+            difference = std::max(difference, std::abs(ca - cb));
+        }
+        return difference;
+    }
+}
+
+RasterCheckReport checkSerialParallelRaster(Scene &scene, Renderer &renderer, int parallelWorkers)
+{
+    JobSystem &jobs = JobSystem::getInstance();
+    const int previousWorkers = jobs.getWorkerCount();
+    const RasterPath previousPath = renderer.getRasterPath();
+    const bool previousPipelining = renderer.isFramePipeliningEnabled();
+    if (parallelWorkers <= 0)
+    {
+        parallelWorkers = previousWorkers;
+    }
+
+    renderer.enableFramePipelining(false);
+    renderWith(scene, renderer, 1, RasterPath::SERIAL);
+    const FrameCapture serial = captureFrame(renderer.getFrameBuffer());
+    renderWith(scene, renderer, parallelWorkers, RasterPath::PARALLEL);
+    const FrameCapture parallel = captureFrame(renderer.getFrameBuffer());
+
+    RasterCheckReport report;
+    report.width = renderer.getFrameBuffer().getWidth();
+    report.height = renderer.getFrameBuffer().getHeight();
+    report.parallelWorkers = jobs.getWorkerCount();
+
+    for (size_t i = 0; i < serial.color.size(); ++i)
+    {
+        // 按位比较深度，-0.0和0.0、NaN的差异也算不一致
+        const size_t depthBase = i * serial.depthPerPixel;
+        if (std::memcmp(&serial.depth[depthBase], &parallel.depth[depthBase], sizeof(float) * serial.depthPerPixel) != 0)
+        {
+            ++report.depthMismatches;
+        }
+        if (serial.color[i] == parallel.color[i])
+        {
+            continue;
+        }
+        ++report.colorMismatches;
+        report.maxColorDifference = std::max(report.maxColorDifference, channelDifference(serial.color[i], parallel.color[i]));
+        if (report.firstMismatches.size() < MAX_REPORTED_MISMATCHES)
+        {
+            const int x = static_cast<int>(i % report.width);
+            const int y = static_cast<int>(i / report.width);
+            report.firstMismatches.push_back({x, y, serial.color[i], parallel.color[i]});
+        }
+    }
+
+    jobs.setWorkerCount(previousWorkers);
+    renderer.setRasterPath(previousPath);
+    renderer.enableFramePipelining(previousPipelining);
+    return report;
+}
+
+bool printRasterCheckReport(const RasterCheckReport &report)
+{
+    const size_t pixels = static_cast<size_t>(report.width) * report.height;
+    std::cout << "[RasterCheck] 串行(1) vs 并行(" << report.parallelWorkers << ") "
+              << report.width << "x" << report.height << ": ";
+    if (report.identical())
+    {
+        std::cout << "逐位一致" << std::endl;
+        return true;
+    }
+
+    std::cout << "颜色不一致 " << report.colorMismatches << " 像素 ("
+              << std::fixed << std::setprecision(4) << (pixels ? 100.0 * report.colorMismatches / pixels : 0.0)
+              << "%), 单通道最大差值 " << report.maxColorDifference
+              << ", 深度不一致 " << report.depthMismatches << " 像素" << std::endl;
+    for (const RasterMismatch &mismatch : report.firstMismatches)
+    {
+        std::cout << "  (" << mismatch.x << ", " << mismatch.y << ") 串行 0x" << std::hex << std::setw(8)
+                  << std::setfill('0') << mismatch.serialColor << " 并行 0x" << std::setw(8) << mismatch.parallelColor
+                  << std::dec << std::setfill(' ') << std::endl;
+    }
+    return false;
+}
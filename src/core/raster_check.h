@@ -0,0 +1,44 @@
+// raster_check.h
+// 串行/并行光栅化一致性检查：同一帧分别串行和并行渲染，逐像素比较颜色和深度
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class Renderer;
+class Scene;
+
+// 不一致的像素
+struct RasterMismatch
+{
+    int x, y;
+    unsigned int serialColor;   // ARGB8888
+    unsigned int parallelColor;
+};
+
+struct RasterCheckReport
+{
+    int width = 0;
+    int height = 0;
+    int parallelWorkers = 0;     // 并行渲染实际使用的工作者数
+    size_t colorMismatches = 0;  // 颜色不一致的像素数
+    size_t depthMismatches = 0;  // 深度（MSAA时为任一样本深度）不一致的像素数
+    int maxColorDifference = 0;  // 单通道最大差值
+    std::vector<RasterMismatch> firstMismatches; // 最先发现的若干个颜色不一致像素（按行扫描顺序）
+
+    bool identical() const { return colorMismatches == 0 && depthMismatches == 0; }
+};
+
+/**
+ * 用场景当前的状态渲染两次并比较结果：
+ *   串行：1个工作者，所有三角形走串行扫描路径
+ *   并行：parallelWorkers个工作者（<= 0时使用检查前的工作者数），所有三角形走分块并行路径
+ * 检查期间关闭帧流水线，结束后恢复工作者数、遍历路径和流水线设置；帧缓冲保留并行渲染的结果。
+ * 只能在拥有渲染器的非工作线程上调用，调用时不能有未完成的任务。
+ * 启用确定性光栅化时两次渲染应逐位一致，否则三角形边上的像素可能因边函数的累加顺序不同而不一致。
+ */
+RasterCheckReport checkSerialParallelRaster(Scene &scene, Renderer &renderer, int parallelWorkers = 0);
+
+// 打印检查结果，返回是否一致
+bool printRasterCheckReport(const RasterCheckReport &report);
@@ -0,0 +1,78 @@
+// raster_tuning.cpp
+#include "raster_tuning.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+RasterTuning RasterTuning::clamped() const
+{
+    RasterTuning result = *this;
+    result.blockSize = std::clamp(blockSize, 4, 256);
+    result.parallelPixelThreshold = std::max(parallelPixelThreshold, 0);
+    result.msaaRowsPerTask = std::max(msaaRowsPerTask, 0);
+    result.resolveTileRowsPerTask = std::max(resolveTileRowsPerTask, 1);
+    return result;
+}
+
+bool loadRasterTuning(const std::string &filename, RasterTuning &tuning, int *workers)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        return false;
+    }
+
+    RasterTuning loaded = tuning;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        const size_t keyBegin = line.find('"');
+        const size_t keyEnd = keyBegin == std::string::npos ? keyBegin : line.find('"', keyBegin + 1);
+        const size_t colon = keyEnd == std::string::npos ? keyEnd : line.find(':', keyEnd);
+        if (colon == std::string::npos)
+        {
+            continue;
+        }
+        const std::string key = line.substr(keyBegin + 1, keyEnd - keyBegin - 1);
+        const int value = std::atoi(line.c_str() + colon + 1);
+        if (key == "block_size")
+        {
+            loaded.blockSize = value;
+        }
+        else if (key == "parallel_pixel_threshold")
+        {
+            loaded.parallelPixelThreshold = value;
+        }
+        else if (key == "msaa_rows_per_task")
+        {
+            loaded.msaaRowsPerTask = value;
+        }
+        else if (key == "resolve_tile_rows_per_task")
+        {
+            loaded.resolveTileRowsPerTask = value;
+        }
+        else if (key == "workers" && workers)
+        {
+            *workers = value;
+        }
+    }
+    tuning = loaded.clamped();
+    return true;
+}
+
+bool saveRasterTuning(const std::string &filename, const RasterTuning &tuning, int workers)
+{
+    std::ofstream file(filename);
+    if (!file)
+    {
+        return false;
+    }
+    file << "{\n"
+         << "  \"workers\": " << workers << ",\n"
+         << "  \"block_size\": " << tuning.blockSize << ",\n"
+         << "  \"parallel_pixel_threshold\": " << tuning.parallelPixelThreshold << ",\n"
+         << "  \"msaa_rows_per_task\": " << tuning.msaaRowsPerTask << ",\n"
+         << "  \"resolve_tile_rows_per_task\": " << tuning.resolveTileRowsPerTask << "\n"
+         << "}\n";
+    return static_cast<bool>(file);
+}
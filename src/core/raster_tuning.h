@@ -0,0 +1,29 @@
+// raster_tuning.h
+// 光栅化的可调参数和按机器保存的调优配置文件
+
+#pragma once
+
+#include <string>
+
+/**
+ * 光栅化的分块大小和并行门限。默认值与调优前的常量一致；
+ * 最优值取决于缓存大小和核心数，可用SimpleRenderer --autotune在部署机器上测得后保存为配置文件，
+ * 启动时由loadRasterTuning读取。确定性光栅化下这些参数不影响输出。
+ */
+struct RasterTuning
+{
+    int blockSize = 16;                // 大三角形分块并行遍历的块边长（像素）
+    int parallelPixelThreshold = 1024; // 包围盒像素数超过该值的三角形并行遍历
+    int msaaRowsPerTask = 0;           // MSAA并行遍历每个任务的行数，0为按工作者数自动选择
+    int resolveTileRowsPerTask = 1;    // 颜色展开/复制到平台层时每个任务处理的tile行数
+
+    // 把参数限制在有效范围内
+    RasterTuning clamped() const;
+};
+
+/**
+ * 调优配置文件：扁平JSON对象，每行一个 "键": 整数，未知的键被忽略、缺少的键保持默认值。
+ * workers记录测量时的工作者数，供加载时提示配置是否来自相同的线程配置。
+ */
+bool loadRasterTuning(const std::string &filename, RasterTuning &tuning, int *workers = nullptr);
+bool saveRasterTuning(const std::string &filename, const RasterTuning &tuning, int workers);
@@ -0,0 +1,134 @@
+// render_queue.cpp
+#include "render_queue.h"
+#include "job_system.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+    constexpr int RADIX_BITS = 8;
+    constexpr int RADIX_BUCKETS = 1 << RADIX_BITS;
+    constexpr int RADIX_PASSES = 64 / RADIX_BITS;
+
+    using Histogram = std::array<size_t, RADIX_BUCKETS>;
+
+    inline uint32_t keyDigit(uint64_t key, int pass)
+    {
+        return static_cast<uint32_t>(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+    }
+}
+
+uint32_t RenderQueue::depthToBits(float viewDepth)
+{
+    // 相机后方或NaN的深度统一视为0
+    if (!(viewDepth > 0.0f))
+    {
+        return 0;
+    }
+
+    uint32_t bits;
+    std::memcpy(&bits, &viewDepth, sizeof(bits));
+    return bits;
+}
+
+uint64_t RenderQueue::makeOpaqueKey(uint32_t shaderId, uint32_t materialId, float viewDepth)
+{
+    return (static_cast<uint64_t>(RenderQueueType::OPAQUE) << 63) |
+           (static_cast<uint64_t>(std::min(shaderId, MAX_SHADER_ID)) << 51) |
+           (static_cast<uint64_t>(std::min(materialId, MAX_MATERIAL_ID)) << 32) |
+           static_cast<uint64_t>(depthToBits(viewDepth));
+}
+
+uint64_t RenderQueue::makeTransparentKey(uint32_t shaderId, uint32_t materialId, float viewDepth)
+{
+    // 反转深度位使远处物体排在前面
+    const uint32_t invDepth = ~depthToBits(viewDepth);
+    return (static_cast<uint64_t>(RenderQueueType::TRANSPARENT) << 63) |
+           (static_cast<uint64_t>(invDepth) << 31) |
+           (static_cast<uint64_t>(std::min(shaderId, MAX_SHADER_ID)) << 19) |
+           static_cast<uint64_t>(std::min(materialId, MAX_MATERIAL_ID));
+}
+
+void RenderQueue::sort()
+{
+    radixSortDrawItems(items, scratch);
+}
+
+void radixSortDrawItems(std::vector<DrawItem> &items, std::vector<DrawItem> &scratch)
+{
+    const size_t count = items.size();
+    if (count < 2)
+    {
+        return;
+    }
+    scratch.resize(count);
+
+    // 小队列串行处理，大队列按线程切分为连续块
+    const int numChunks = count < RenderQueue::PARALLEL_SORT_THRESHOLD
+                              ? 1
+                              : std::max(1, std::min(JobSystem::getInstance().getWorkerCount(), static_cast<int>(count / 1024)));
+    const size_t chunkSize = (count + numChunks - 1) / numChunks;
+
+    std::vector<Histogram> histograms(numChunks);
+    DrawItem *src = items.data();
+    DrawItem *dst = scratch.data();
+
+    for (int pass = 0; pass < RADIX_PASSES; ++pass)
+    {
+        // 1. 每块统计直方图
+        JobSystem::getInstance().parallelFor(0, numChunks, 1, [&](int chunk) {
+            Histogram &hist = histograms[chunk];
+            hist.fill(0);
+            const size_t begin = chunk * chunkSize;
+            const size_t end = std::min(count, begin + chunkSize);
+            for (size_t i = begin; i < end; ++i)
+            {
+                hist[keyDigit(src[i].sortKey, pass)]++;
+            }
+        });
+
+        // 所有键在该字节上相同，跳过本轮
+        const uint32_t firstDigit = keyDigit(src[0].sortKey, pass);
+        size_t firstDigitCount = 0;
+        for (const Histogram &hist : histograms)
+        {
+            firstDigitCount += hist[firstDigit];
+        }
+        if (firstDigitCount == count)
+        {
+            continue;
+        }
+
+        // 2. 按(桶, 块)顺序求前缀和，得到每块在每个桶中的写入起点，保证稳定性
+        size_t offset = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        {
+            for (int chunk = 0; chunk < numChunks; ++chunk)
+            {
+                const size_t bucketCount = histograms[chunk][bucket];
+                histograms[chunk][bucket] = offset;
+                offset += bucketCount;
+            }
+        }
+
+        // 3. 分散写入
+        JobSystem::getInstance().parallelFor(0, numChunks, 1, [&](int chunk) {
+            Histogram &cursor = histograms[chunk];
+            const size_t begin = chunk * chunkSize;
+            const size_t end = std::min(count, begin + chunkSize);
+            for (size_t i = begin; i < end; ++i)
+            {
+                dst[cursor[keyDigit(src[i].sortKey, pass)]++] = src[i];
+            }
+        });
+
+        std::swap(src, dst);
+    }
+
+    // 结果位于scratch时交换回items
+    if (src != items.data())
+    {
+        items.swap(scratch);
+    }
+}
@@ -0,0 +1,67 @@
+// render_queue.h
+// 渲染队列：收集带64位排序键的绘制项，按状态和深度排序后提交
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 渲染队列类型（排序键的最高位）
+enum class RenderQueueType : uint8_t
+{
+    OPAQUE = 0,     // 不透明物体：按着色器/材质分组，组内从前到后
+    TRANSPARENT = 1 // 半透明物体：从后到前
+};
+
+// 绘制项：排序键 + 场景对象索引
+struct DrawItem
+{
+    uint64_t sortKey;     // 64位排序键
+    uint32_t objectIndex; // 场景对象索引
+};
+
+/**
+ * 渲染队列
+ *
+ * 排序键布局（高位到低位）：
+ *   不透明: [63]队列 [62..51]着色器ID [50..32]材质ID [31..0]视空间深度（升序）
+ *   半透明: [63]队列 [62..31]反转的视空间深度（降序） [30..19]着色器ID [18..0]材质ID
+ * 正浮点数的位模式与其数值单调一致，因此深度可直接作为整数参与排序。
+ */
+class RenderQueue
+{
+public:
+    static constexpr uint32_t MAX_SHADER_ID = (1u << 12) - 1;
+    static constexpr uint32_t MAX_MATERIAL_ID = (1u << 19) - 1;
+
+    // 小于该数量时使用串行排序，避免并行调度开销
+    static constexpr size_t PARALLEL_SORT_THRESHOLD = 4096;
+
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    void clear() { items.clear(); }
+    void reserve(size_t count) { items.reserve(count); scratch.reserve(count); }
+    void submit(uint64_t sortKey, uint32_t objectIndex) { items.push_back({sortKey, objectIndex}); }
+
+    // 按排序键升序排序（稳定的LSD基数排序）
+    void sort();
+
+    const std::vector<DrawItem> &getItems() const { return items; }
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+
+    // 构造排序键
+    static uint64_t makeOpaqueKey(uint32_t shaderId, uint32_t materialId, float viewDepth);
+    static uint64_t makeTransparentKey(uint32_t shaderId, uint32_t materialId, float viewDepth);
+
+private:
+    std::vector<DrawItem> items;
+    std::vector<DrawItem> scratch; // 基数排序的双缓冲
+
+    static uint32_t depthToBits(float viewDepth);
+};
+
+// 对绘制项做稳定的64位LSD基数排序（8轮8位），全部键在某字节上相同则跳过该轮
+void radixSortDrawItems(std::vector<DrawItem> &items, std::vector<DrawItem> &scratch);
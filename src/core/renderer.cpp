@@ -7,7 +7,54 @@
 #include "renderer.h"
 #include "mesh.h"
 #include "texture_io.h"
-#include <omp.h>
+#include "job_system.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    // 热力图颜色达到最高档（白色）的着色次数
+    constexpr float OVERDRAW_HEATMAP_MAX = 8.0f;
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 着色次数映射为伪彩色：0为黑色，1为蓝色，之后依次经过青、绿、黄、红，达到上限时为白色
+    Vec4f overdrawColor(float shadeCount)
+    {
+        static const Vec3f stops[] = {
+            {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 0.0f},
+            {1.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+        constexpr int lastStop = static_cast<int>(sizeof(stops) / sizeof(stops[0])) - 1;
+        if (shadeCount <= 0.0f)
+        {
+            return Vec4f(stops[0], 1.0f);
+        }
+        // 1次对应第1档，之后线性分布到上限
+        const float t = 1.0f + (std::min(shadeCount, OVERDRAW_HEATMAP_MAX) - 1.0f) *
+                                   (lastStop - 1) / (OVERDRAW_HEATMAP_MAX - 1.0f);
+        const int stop = std::min(static_cast<int>(t), lastStop - 1);
+        const float f = t - stop;
+        return Vec4f(stops[stop] * (1.0f - f) + stops[stop + 1] * f, 1.0f);
+    }
+}
+
+PipelineStatistics &PipelineStatistics::operator+=(const PipelineStatistics &other)
+{
+    trianglesSubmitted += other.trianglesSubmitted;
+    trianglesCulledBackface += other.trianglesCulledBackface;
+    trianglesCulledOffscreen += other.trianglesCulledOffscreen;
+    trianglesClipped += other.trianglesClipped;
+    trianglesRasterized += other.trianglesRasterized;
+    pixelsTested += other.pixelsTested;
+    depthTestsPassed += other.depthTestsPassed;
+    depthTestsFailed += other.depthTestsFailed;
+    fragmentsShaded += other.fragmentsShaded;
+    fragmentsDiscarded += other.fragmentsDiscarded;
+    return *this;
+}
 
 // 构造函数
 Renderer::Renderer(int width, int height)
@@ -19,116 +66,429 @@ Renderer::Renderer(int width, int height)
       msaaEnabled(false)
 {
     light = Light(Vec3f(0.0f, 0.0f, -1.0f), Vec3f(1.0f), 1.0f, 0.2f);
-    // 设置OpenMP线程数
-    // 获取系统可用的处理器核心数
-    int max_threads = omp_get_max_threads();
-    // 使用所有核心
-    omp_set_num_threads(max_threads);
-    
-    // 设置OpenMP嵌套并行
-    omp_set_nested(1);
-    
-    // 设置动态线程调度
-    omp_set_dynamic(1);
+    // 启动常驻工作线程（所有并行阶段共用同一个任务调度器）
+    JobSystem::getInstance();
+}
+
+Renderer::~Renderer()
+{
+    // 光栅化任务引用帧上下文和帧缓冲，必须在销毁前完成
+    finishFrame();
 }
 
 void Renderer::enableMSAA(bool enable)
 {
+    finishFrame();
     msaaEnabled = enable;
     frameBuffer->enableMSAA(enable);
 }
 
+void Renderer::enableDeterministicRaster(bool enable)
+{
+    finishFrame();
+    deterministicRaster = enable;
+}
+
+void Renderer::setRasterPath(RasterPath path)
+{
+    finishFrame();
+    rasterPath = path;
+}
+
+void Renderer::setRasterTuning(const RasterTuning &tuning)
+{
+    finishFrame();
+    rasterTuning = tuning.clamped();
+    frameBuffer->setResolveGrain(rasterTuning.resolveTileRowsPerTask);
+}
+
+void Renderer::setFrameBufferLayout(FrameBufferLayout layout)
+{
+    finishFrame();
+    frameBuffer->setLayout(layout);
+}
+
 void Renderer::clear(const Vec4f &color)
 {
     frameBuffer->clear(color);
 }
 
-// 网格绘制过程
-void Renderer::drawMeshPass(const std::shared_ptr<Mesh> &mesh, std::shared_ptr<IShader> activeShader)
+void Renderer::enableStatistics(bool enable)
+{
+    finishFrame();
+    statisticsEnabled = enable;
+    lastFrameStats = FrameStats();
+}
+
+void Renderer::setColorTarget(uint32_t *target, int pitch, bool readback)
+{
+    if (framePipelining)
+    {
+        hasPendingColorTarget = true;
+        pendingColorTarget = target;
+        pendingColorPitch = pitch;
+        pendingColorReadback = readback;
+        return;
+    }
+    frameBuffer->setColorTarget(target, pitch, readback);
+}
+
+void Renderer::enableFramePipelining(bool enable)
+{
+    if (framePipelining == enable)
+    {
+        return;
+    }
+    finishFrame();
+    framePipelining = enable;
+    if (hasPendingColorTarget)
+    {
+        frameBuffer->setColorTarget(pendingColorTarget, pendingColorPitch, pendingColorReadback);
+        hasPendingColorTarget = false;
+    }
+}
+
+void Renderer::beginFrame()
+{
+    recordingContext = (recordingContext + 1) % FRAME_CONTEXT_COUNT;
+    if (rasterContext == recordingContext)
+    {
+        finishFrame();
+    }
+
+    FrameContext &context = frameContexts[recordingContext];
+    context.draws.clear();
+    context.shaderInstances.clear();
+    context.sharesShaders = false;
+    context.stats = FrameStats();
+    context.debugView = debugView;
+}
+
+// 获取本帧上下文的着色器实例，首次使用时复制
+std::shared_ptr<IShader> Renderer::getContextShader(FrameContext &context, const std::shared_ptr<IShader> &shader)
+{
+    for (const auto &[source, instance] : context.shaderInstances)
+    {
+        if (source == shader.get())
+        {
+            return instance;
+        }
+    }
+
+    std::shared_ptr<IShader> instance = shader->clone();
+    if (!instance)
+    {
+        instance = shader;
+        context.sharesShaders = true;
+    }
+    context.shaderInstances.emplace_back(shader.get(), instance);
+    return instance;
+}
+
+size_t Renderer::submitDraw(const std::shared_ptr<Mesh> &mesh, const std::shared_ptr<IShader> &shader,
+                            const ShaderUniforms &uniforms)
 {
-    if (!mesh || !activeShader)
+    FrameContext &context = frameContexts[recordingContext];
+    if (!mesh || !shader)
     {
-        if (!activeShader)
+        if (!shader)
         {
             std::cerr << "Error: No shader set for material, cannot render mesh." << std::endl;
         }
-        return;
+        // 保留空批次，批次索引与调用方的绘制顺序一致
+        context.draws.push_back({nullptr, nullptr, uniforms, 0, 0});
+        return context.draws.size() - 1;
+    }
+
+    context.draws.push_back({mesh, getContextShader(context, shader), uniforms, 0, mesh->getTriangles().size()});
+    return context.draws.size() - 1;
+}
+
+// 几何阶段：逐批次并行执行顶点着色、背面剔除和三角形设置，结果按三角形顺序存放
+void Renderer::processFrameGeometry()
+{
+    FrameContext &context = frameContexts[recordingContext];
+    if (context.sharesShaders)
+    {
+        // 与上一帧共用着色器实例，重新绑定uniform前必须等待其光栅化完成
+        finishFrame();
+    }
+
+    CountedProfiler geometryProfiler("Renderer::geometry", "triangle");
+    const auto startTime = std::chrono::steady_clock::now();
+    size_t triangleCount = 0;
+    for (FrameContext::DrawBatch &draw : context.draws)
+    {
+        draw.firstTriangle = triangleCount;
+        triangleCount += draw.triangleCount;
     }
+    context.triangles.resize(triangleCount);
+    geometryProfiler.setWorkUnits(triangleCount);
 
-    // 直接渲染所有三角形
-    for (const Triangle &triangle : mesh->getTriangles())
+    JobSystem &jobs = JobSystem::getInstance();
+    for (FrameContext::DrawBatch &draw : context.draws)
     {
-        rasterizeTriangle(triangle, activeShader);
+        if (!draw.mesh)
+        {
+            continue;
+        }
+        draw.shader->setUniforms(draw.uniforms);
+        const std::vector<Triangle> &triangles = draw.mesh->getTriangles();
+        TriangleSetupData *setups = context.triangles.data() + draw.firstTriangle;
+        jobs.parallelFor(0, static_cast<int>(draw.triangleCount), GEOMETRY_GRAIN, [&](int i) {
+            setups[i] = setupTriangle(triangles[i], draw.shader);
+        });
+    }
+
+    if (statisticsEnabled)
+    {
+        context.stats.geometryMs = elapsedMs(startTime);
+        PipelineStatistics &counts = context.stats.pipeline;
+        counts.trianglesSubmitted = triangleCount;
+        for (const TriangleSetupData &setup : context.triangles)
+        {
+            counts.trianglesCulledBackface += setup.cull == TriangleCull::BACKFACE;
+            counts.trianglesCulledOffscreen += setup.cull == TriangleCull::OFFSCREEN;
+            counts.trianglesClipped += setup.valid && setup.clipped;
+            counts.trianglesRasterized += setup.valid;
+        }
     }
 }
 
-// 创建阴影贴图
-std::shared_ptr<Texture> Renderer::createShadowMap(int width, int height)
+void Renderer::beginRasterStage()
 {
-    shadowFrameBuffer = std::make_unique<FrameBuffer>(width, height);
-    shadowFrameBuffer->clear(Vec4f(1.0f), 1.0f);
+    finishFrame();
+    if (hasPendingColorTarget)
+    {
+        frameBuffer->setColorTarget(pendingColorTarget, pendingColorPitch, pendingColorReadback);
+        hasPendingColorTarget = false;
+    }
+}
 
-    auto shadowMap = textures::createTexture(width, height, TextureFormat::R32_FLOAT, TextureAccess::READ_WRITE);
-    this->shadowMap = shadowMap;
+void Renderer::setDrawUniforms(size_t draw, const ShaderUniforms &uniforms)
+{
+    frameContexts[recordingContext].draws[draw].uniforms = uniforms;
+}
 
-    return shadowMap;
+void Renderer::endFrame()
+{
+    // 整个光栅化阶段作为一个任务提交，内部的并行遍历与下一帧的几何阶段共享工作线程
+    FrameContext &context = frameContexts[recordingContext];
+    context.rasterPending.store(1, std::memory_order_relaxed);
+    const Job job{&Renderer::rasterizeFrameJob, this, recordingContext, recordingContext + 1, &context.rasterPending};
+    rasterContext = recordingContext;
+    JobSystem::getInstance().submit(&job, 1);
+
+    if (!framePipelining)
+    {
+        finishFrame();
+    }
 }
 
-// 阴影渲染过程
-void Renderer::shadowPass(const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &shadowCasters)
+void Renderer::finishFrame()
 {
-    if (!shadowFrameBuffer || !shadowMap)
+    if (rasterContext < 0)
     {
-        std::cerr << "Cannot render shadow map: shadow buffer or texture not initialized" << std::endl;
         return;
     }
+    PROFILE_SCOPE("Renderer::waitRaster");
+    JobSystem::getInstance().wait(frameContexts[rasterContext].rasterPending);
+    if (statisticsEnabled)
+    {
+        lastFrameStats = frameContexts[rasterContext].stats;
+    }
+    rasterContext = -1;
+}
 
-    // 保存当前渲染状态
-    auto originalMsaaEnabled = msaaEnabled;
-    auto originalFrameBuffer = std::move(frameBuffer);
+void Renderer::rasterizeFrameJob(const void *data, int begin, int /*end*/)
+{
+    Renderer &renderer = *const_cast<Renderer *>(static_cast<const Renderer *>(data));
+    renderer.rasterizeFrame(renderer.frameContexts[begin]);
+}
 
-    // 切换到阴影渲染状态
-    msaaEnabled = false;
-    frameBuffer = std::move(shadowFrameBuffer);
-    clear(Vec4f(1.0f));
+// 光栅化阶段：按提交顺序遍历三角形并着色，与逐三角形设置后立即遍历的结果一致
+void Renderer::rasterizeFrame(FrameContext &context)
+{
+    CountedProfiler rasterProfiler("Renderer::raster", "triangle");
+    const auto startTime = std::chrono::steady_clock::now();
+    uint64_t trianglesRasterized = 0;
+    if (statisticsEnabled)
+    {
+        // 同一时刻只有一帧在光栅化，计数器在帧之间复用
+        const int workerCount = JobSystem::getInstance().getWorkerCount();
+        if (workerStatisticsCount != workerCount)
+        {
+            workerStatistics = std::make_unique<WorkerStatistics[]>(workerCount);
+            workerStatisticsCount = workerCount;
+        }
+        for (int i = 0; i < workerStatisticsCount; ++i)
+        {
+            workerStatistics[i].counts = PipelineStatistics();
+        }
+        {
+            std::lock_guard<std::mutex> lock(externalStatisticsMutex);
+            for (size_t i = 0; i < externalStatisticsUsed; ++i)
+            {
+                externalStatistics[i]->counts = PipelineStatistics();
+            }
+            externalStatisticsUsed = 0;
+        }
+        // 之后提交的光栅化任务通过任务队列看到新的帧序号
+        static std::atomic<uint64_t> nextStatisticsFrame{0};
+        statisticsFrame = nextStatisticsFrame.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    overdrawCounts = nullptr;
+    if (context.debugView == DebugView::OVERDRAW)
+    {
+        overdrawBuffer.assign(static_cast<size_t>(frameBuffer->getWidth()) * frameBuffer->getHeight(), 0);
+        overdrawCounts = overdrawBuffer.data();
+    }
 
-    auto shadowShader = createShadowMapShader();
+    for (const FrameContext::DrawBatch &draw : context.draws)
+    {
+        if (!draw.mesh)
+        {
+            continue;
+        }
+        draw.shader->setUniforms(draw.uniforms);
+        const size_t triangleEnd = draw.firstTriangle + draw.triangleCount;
+        for (size_t i = draw.firstTriangle; i < triangleEnd; ++i)
+        {
+            const TriangleSetupData &setup = context.triangles[i];
+            if (setup.valid)
+            {
+                traverseTriangle(setup, draw.shader);
+                ++trianglesRasterized;
+            }
+        }
+    }
 
-    ShaderUniforms uniforms;
-    uniforms.viewMatrix = getViewMatrix();
-    uniforms.projMatrix = getProjMatrix();
-    uniforms.lightSpaceMatrix = uniforms.projMatrix * uniforms.viewMatrix;
+    if (overdrawCounts)
+    {
+        writeOverdrawHeatmap();
+        overdrawCounts = nullptr;
+    }
 
-    // 渲染阴影投射者
-    for (const auto &[mesh, modelMatrix] : shadowCasters)
+    // 分块布局：展开到外部颜色目标供呈现
     {
-        uniforms.modelMatrix = modelMatrix;
-        shadowShader->setUniforms(uniforms);
+        PROFILE_SCOPE("Renderer::resolve");
+        frameBuffer->resolveColorTarget();
+    }
+    rasterProfiler.setWorkUnits(trianglesRasterized);
 
-        for (const auto &triangle : mesh->getTriangles())
+    if (statisticsEnabled)
+    {
+        // 工作者只累加光栅化阶段的计数，几何阶段的计数已在processFrameGeometry中记录
+        for (int i = 1; i < workerStatisticsCount; ++i)
         {
-            rasterizeTriangle(triangle, shadowShader);
+            context.stats.pipeline += workerStatistics[i].counts;
         }
+        std::lock_guard<std::mutex> lock(externalStatisticsMutex);
+        for (size_t i = 0; i < externalStatisticsUsed; ++i)
+        {
+            context.stats.pipeline += externalStatistics[i]->counts;
+        }
+        context.stats.rasterMs = elapsedMs(startTime);
     }
+}
 
-    // 将阴影帧缓冲复制到阴影贴图纹理
+// 非工作线程在本帧首次计数时认领自己的计数器，之后直接复用
+PipelineStatistics *Renderer::externalThreadStatistics()
+{
+    struct Claim
+    {
+        uint64_t frame = 0;
+        PipelineStatistics *counts = nullptr;
+    };
+    static thread_local Claim claim;
+    if (claim.frame != statisticsFrame)
+    {
+        std::lock_guard<std::mutex> lock(externalStatisticsMutex);
+        if (externalStatisticsUsed == externalStatistics.size())
+        {
+            externalStatistics.push_back(std::make_unique<WorkerStatistics>());
+        }
+        claim = {statisticsFrame, &externalStatistics[externalStatisticsUsed++]->counts};
+    }
+    return claim.counts;
+}
+
+// 用每个像素的着色次数覆盖颜色（MSAA下按每像素的平均采样着色次数）
+void Renderer::writeOverdrawHeatmap()
+{
     const int width = frameBuffer->getWidth();
     const int height = frameBuffer->getHeight();
-
-#pragma omp parallel for collapse(2)
-    for (int y = 0; y < height; ++y)
-    {
+    const float sampleScale = msaaEnabled ? 0.25f : 1.0f;
+    JobSystem &jobs = JobSystem::getInstance();
+    jobs.parallelFor(0, height, jobs.autoGrain(height), [&](int y) {
+        const uint32_t *row = overdrawCounts + static_cast<size_t>(y) * width;
         for (int x = 0; x < width; ++x)
         {
-            float depth = frameBuffer->getDepth(x, y);
-            shadowMap->write(x, y, Vec4f(depth));
+            frameBuffer->setColor(x, y, overdrawColor(row[x] * sampleScale));
         }
+    });
+}
+
+// 创建阴影贴图
+std::shared_ptr<Texture> Renderer::createShadowMap(int size, int layers)
+{
+    auto shadowMap = textures::createTexture(size, size * layers, TextureFormat::R32_FLOAT, TextureAccess::READ_WRITE);
+    this->shadowMap = shadowMap;
+
+    return shadowMap;
+}
+
+// 阴影渲染过程：仅深度光栅化，直接写入阴影贴图对应层的R32_FLOAT存储
+void Renderer::shadowPass(const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &shadowCasters,
+                          int layer, bool clearLayer)
+{
+    float *depthData = shadowMap ? shadowMap->getData<float>() : nullptr;
+    if (!depthData || shadowMap->getFormat() != TextureFormat::R32_FLOAT)
+    {
+        std::cerr << "Cannot render shadow map: shadow texture not initialized" << std::endl;
+        return;
+    }
+
+    const int size = shadowMap->getWidth();
+    if (layer < 0 || (layer + 1) * size > shadowMap->getHeight())
+    {
+        std::cerr << "Cannot render shadow map: layer " << layer << " out of range" << std::endl;
+        return;
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    renderDepthOnly(shadowCasters, depthData + static_cast<size_t>(layer) * size * size, size, size, clearLayer);
+    if (statisticsEnabled)
+    {
+        frameContexts[recordingContext].stats.shadowMs += elapsedMs(startTime);
+    }
+}
+
+// 点光源阴影渲染过程：六个面在一次几何处理中完成
+void Renderer::shadowCubePass(const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &shadowCasters,
+                              const Vec3f &lightPosition, float zNear, float zFar, bool clearTarget)
+{
+    float *depthData = shadowMap ? shadowMap->getData<float>() : nullptr;
+    if (!depthData || shadowMap->getFormat() != TextureFormat::R32_FLOAT)
+    {
+        std::cerr << "Cannot render shadow map: shadow texture not initialized" << std::endl;
+        return;
+    }
+
+    const int size = shadowMap->getWidth();
+    if (shadowMap->getHeight() < size * 6)
+    {
+        std::cerr << "Cannot render cube shadow map: texture needs 6 layers" << std::endl;
+        return;
     }
 
-    // 恢复原始渲染状态
-    shadowFrameBuffer = std::move(frameBuffer);
-    frameBuffer = std::move(originalFrameBuffer);
-    msaaEnabled = originalMsaaEnabled;
+    const auto startTime = std::chrono::steady_clock::now();
+    renderDepthCube(shadowCasters, lightPosition, zNear, zFar, depthData, size, clearTarget);
+    if (statisticsEnabled)
+    {
+        frameContexts[recordingContext].stats.shadowMs += elapsedMs(startTime);
+    }
 }
 
 // 定义MSAA采样点偏移
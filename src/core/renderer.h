@@ -7,7 +7,11 @@
 #include "texture_sampler.h"
 #include "framebuffer.h"  // 引入独立的framebuffer头文件
 #include "profiler.h"     // 引入性能分析模块
+#include "job_system.h"
+#include "raster_tuning.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <array>
 
@@ -31,29 +35,132 @@ struct EdgeFunction {
     float rowIncrement, colIncrement;
 };
 
+// 三角形设置阶段的剔除结果
+enum class TriangleCull : uint8_t {
+    NONE,     // 进入光栅化
+    BACKFACE, // 背面或退化
+    OFFSCREEN // 包围盒与屏幕不相交
+};
+
 // 三角形设置阶段数据
 struct TriangleSetupData {
     std::array<ProcessedVertex, 3> vertices;  // 处理后的顶点
     std::array<EdgeFunction, 3> edges;        // 边缘函数
     int minX, minY, maxX, maxY;              // 边界框
     bool valid;                              // 三角形是否有效(通过背面剔除等)
+    TriangleCull cull;                       // 无效的原因
+    bool clipped;                            // 部分在屏幕外，包围盒按屏幕裁剪
+};
+
+// 仅深度三角形：边缘函数 + 屏幕空间深度平面 z = zdx * x + zdy * y + zc
+struct DepthTriangle {
+    std::array<EdgeFunction, 3> edges;
+    float zdx, zdy, zc;
+    int minX, minY, maxX, maxY;
+    bool valid;
+};
+
+// 管线统计：对应GPU的pipeline statistics查询，统计主渲染各阶段处理的图元和像素数
+// （阴影和光源剔除的仅深度渲染不计入）。MSAA下像素相关的计数按采样点计。
+struct PipelineStatistics {
+    uint64_t trianglesSubmitted = 0;       // 提交的三角形数
+    uint64_t trianglesCulledBackface = 0;  // 背面剔除（含退化三角形）
+    uint64_t trianglesCulledOffscreen = 0; // 包围盒在屏幕外
+    uint64_t trianglesClipped = 0;         // 部分在屏幕外（没有几何裁剪，只按屏幕裁剪包围盒）
+    uint64_t trianglesRasterized = 0;      // 通过剔除、进入光栅化的三角形数
+    uint64_t pixelsTested = 0;             // 做过覆盖测试的像素
+    uint64_t depthTestsPassed = 0;
+    uint64_t depthTestsFailed = 0;
+    uint64_t fragmentsShaded = 0;          // 执行片段着色器的次数
+    uint64_t fragmentsDiscarded = 0;       // 被片段着色器丢弃
+
+    PipelineStatistics &operator+=(const PipelineStatistics &other);
+};
+
+// 一帧的统计数据：阶段耗时和管线统计，启用统计后记录
+struct FrameStats {
+    double geometryMs = 0.0;          // 几何阶段（顶点着色、剔除、三角形设置）
+    double shadowMs = 0.0;            // 阴影贴图渲染
+    double rasterMs = 0.0;            // 光栅化和片段着色
+    PipelineStatistics pipeline;
+};
+
+// 调试视图
+enum class DebugView {
+    NONE,
+    OVERDRAW // 每个像素执行片段着色器的次数，以伪彩色热力图输出（蓝 -> 绿 -> 黄 -> 红 -> 白）
+};
+
+// 三角形遍历路径
+enum class RasterPath {
+    AUTO,    // 按三角形包围盒大小选择，小三角形串行扫描，大三角形分块并行
+    SERIAL,  // 全部串行扫描
+    PARALLEL // 全部分块并行
+};
+
+// 一帧主渲染的几何阶段输出：按提交顺序的绘制批次和三角形设置结果，光栅化阶段只读取这里的数据
+struct FrameContext {
+    struct DrawBatch {
+        std::shared_ptr<Mesh> mesh;
+        std::shared_ptr<IShader> shader; // 本帧上下文的着色器实例
+        ShaderUniforms uniforms;         // uniform快照，几何和光栅化阶段各自绑定
+        size_t firstTriangle;            // 在triangles中的起始位置
+        size_t triangleCount;
+    };
+    std::vector<DrawBatch> draws;
+    std::vector<TriangleSetupData> triangles;
+    // 原着色器 -> 本上下文的实例（每帧重新复制，着色器参数的修改从下一帧生效）
+    std::vector<std::pair<const IShader *, std::shared_ptr<IShader>>> shaderInstances;
+    bool sharesShaders = false;  // 有着色器不支持复制，几何阶段不能与上一帧的光栅化重叠
+    JobCounter rasterPending{0}; // 光栅化任务未完成时为1
+    FrameStats stats;            // 本帧的统计数据
+    DebugView debugView = DebugView::NONE;
 };
 
+// 立方体阴影各面的视图投影矩阵（90°透视），面顺序为 +X, -X, +Y, -Y, +Z, -Z
+std::array<Matrix4x4f, 6> computeCubeFaceViewProj(const Vec3f &center, float zNear, float zFar);
+
 // 光栅化渲染器类
 class Renderer
 {
+    // 微基准测试直接调用内部的光栅化kernel
+    friend class KernelBench;
+
 public:
     Renderer(int width, int height);
-    ~Renderer() = default;
+    ~Renderer();
 
     //--------------------
     // 性能分析相关方法
     //--------------------
-    void enableProfiling(bool enable) { profilingEnabled = enable; }
+    // 分析器的开关是全局的，所有线程的作用域都受其控制
+    void enableProfiling(bool enable) { profilingEnabled = enable; Profiler::getInstance().setEnabled(enable); }
     bool isProfilingEnabled() const { return profilingEnabled; }
     void resetProfilingData() { if (profilingEnabled) PROFILE_RESET(); }
     void printProfilingReport() const { if (profilingEnabled) PROFILE_REPORT(); }
 
+    // 帧统计：启用后每帧记录阶段耗时和管线统计（光栅化阶段的计数按工作者分别累加，帧结束时合并）
+    void enableStatistics(bool enable);
+    bool isStatisticsEnabled() const { return statisticsEnabled; }
+    // 最近一帧已完成光栅化的统计；流水线模式下Scene::render返回时对应上一帧
+    const FrameStats &getLastFrameStats() const { return lastFrameStats; }
+
+    // 调试视图，从下一次beginFrame开始生效
+    void setDebugView(DebugView view) { debugView = view; }
+    DebugView getDebugView() const { return debugView; }
+
+    // 确定性光栅化：边函数在每个像素中心直接求值而不是从行首或块原点增量累加，
+    // 覆盖测试和着色结果与遍历路径、分块大小和工作者数无关（输出逐位一致）。
+    // 三角形按提交顺序逐个光栅化，每个像素在一个三角形内只由一个任务写入，像素上的解析顺序本来就是固定的
+    void enableDeterministicRaster(bool enable);
+    bool isDeterministicRasterEnabled() const { return deterministicRaster; }
+    // 强制三角形遍历路径，用于串行/并行一致性检查
+    void setRasterPath(RasterPath path);
+    RasterPath getRasterPath() const { return rasterPath; }
+    // 分块大小和并行门限，超出范围的值被限制到有效范围
+    void setRasterTuning(const RasterTuning &tuning);
+    const RasterTuning &getRasterTuning() const { return rasterTuning; }
+
     //--------------------
     // 基础状态设置
     //--------------------
@@ -62,6 +169,31 @@ public:
     
     void enableMSAA(bool enable);
     void clear(const Vec4f &color = Vec4f(0.0f));
+    // 帧缓冲内存布局，分块布局在每帧光栅化结束时展开到外部颜色目标
+    void setFrameBufferLayout(FrameBufferLayout layout);
+
+    //--------------------
+    // 帧流水线：几何阶段（顶点着色、剔除、三角形设置）与光栅化/着色阶段分离
+    //--------------------
+    // 一帧的调用顺序：
+    //   beginFrame → submitDraw... → processFrameGeometry   几何阶段，可与上一帧的光栅化重叠
+    //   beginRasterStage                                     等待上一帧光栅化完成，之后才能修改帧缓冲、阴影贴图等共享状态
+    //   setDrawUniforms... → endFrame                        提交光栅化阶段
+    // 启用流水线后endFrame不等待光栅化完成，读取帧缓冲前需调用finishFrame；
+    // 颜色目标的切换推迟到下一次beginRasterStage，不影响正在光栅化的帧
+    void enableFramePipelining(bool enable);
+    bool isFramePipeliningEnabled() const { return framePipelining; }
+    void beginFrame();
+    // 记录一次绘制，返回批次索引；uniforms供顶点着色使用，只需对象和相机相关的部分有效
+    size_t submitDraw(const std::shared_ptr<Mesh> &mesh, const std::shared_ptr<IShader> &shader,
+                      const ShaderUniforms &uniforms);
+    void processFrameGeometry();
+    void beginRasterStage();
+    // 替换批次的uniform快照，光栅化阶段使用完整的uniform
+    void setDrawUniforms(size_t draw, const ShaderUniforms &uniforms);
+    void endFrame();
+    // 等待正在进行的光栅化完成
+    void finishFrame();
 
     //--------------------
     // 变换矩阵操作
@@ -86,20 +218,34 @@ public:
     //--------------------
     // 阴影渲染
     //--------------------
-    std::shared_ptr<Texture> createShadowMap(int width, int height);
-    void shadowPass(const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &shadowCasters);
+    // 创建layers个size x size的阴影层，纵向排列在同一张R32_FLOAT纹理中
+    std::shared_ptr<Texture> createShadowMap(int size, int layers = 1);
+    // 使用当前视图/投影矩阵渲染第layer层阴影；clearLayer为false时叠加到已有深度上
+    void shadowPass(const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &shadowCasters,
+                    int layer = 0, bool clearLayer = true);
 
-    //--------------------
-    // 主渲染流程
-    //--------------------
-    void drawMeshPass(const std::shared_ptr<Mesh> &mesh, std::shared_ptr<IShader> activeShader);
-    void rasterizeTriangle(const Triangle &triangle, std::shared_ptr<IShader> shader);
+    // 仅深度渲染：只插值z，不执行片段着色器，直接写入depthTarget（width * height个float）
+    void renderDepthOnly(
+        const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &meshes,
+        float *depthTarget, int width, int height, bool clearTarget = true);
+
+    // 单遍立方体深度渲染：depthTarget为6个faceSize x faceSize的面，顺序 +X, -X, +Y, -Y, +Z, -Z
+    void renderDepthCube(
+        const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &meshes,
+        const Vec3f &center, float zNear, float zFar,
+        float *depthTarget, int faceSize, bool clearTarget = true);
+    // 渲染点光源的立方体阴影，阴影贴图需有6层；clearTarget为false时叠加到已有深度上
+    void shadowCubePass(const std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> &shadowCasters,
+                        const Vec3f &lightPosition, float zNear, float zFar, bool clearTarget = true);
 
     //--------------------
     // 工具方法
     //--------------------
     Vec3f screenMapping(const Vec3f &ndcPos);
     const FrameBuffer &getFrameBuffer() const { return *frameBuffer; }
+    // 设置外部ARGB8888颜色目标（pitch以像素为单位），nullptr恢复内部存储。
+    // 外部目标只写入；readback为true时本帧渲染到内部存储，帧结束后可通过getFrameBuffer读取（如截图）
+    void setColorTarget(uint32_t *target, int pitch, bool readback = false);
 
     //--------------------
     // 三角形设置与遍历
@@ -132,10 +278,65 @@ private:
     Vec3f eyePosWS;
     bool msaaEnabled;
     bool profilingEnabled = false; // 性能分析开关
+    bool deterministicRaster = false;
+    RasterPath rasterPath = RasterPath::AUTO;
+    RasterTuning rasterTuning;
+
+    // 帧统计
+    struct alignas(64) WorkerStatistics
+    {
+        PipelineStatistics counts;
+    };
+    bool statisticsEnabled = false;
+    FrameStats lastFrameStats;
+    // 每个工作线程一个，避免共享缓存行，每个计数器只有一个写入者，不需要原子操作。
+    // 非工作线程的工作者索引都是0（调用线程、帧流水线的渲染线程和主线程等待任务时都可能执行光栅化任务），
+    // 它们在每帧首次计数时各自认领一个额外的计数器，数量不够时加锁追加（每个线程每帧只有一次），
+    // 已认领的计数器地址不变，因此计数不会丢失。第0个工作者计数器不使用
+    std::unique_ptr<WorkerStatistics[]> workerStatistics;
+    int workerStatisticsCount = 0;
+    uint64_t statisticsFrame = 0;         // 光栅化帧的全局序号，非工作线程按它判断认领是否过期
+    std::mutex externalStatisticsMutex;
+    std::vector<std::unique_ptr<WorkerStatistics>> externalStatistics; // 由externalStatisticsMutex保护
+    size_t externalStatisticsUsed = 0;                                 // 本帧已认领的数量
+    // 光栅化中当前线程的计数器，未启用统计时为nullptr
+    PipelineStatistics *currentWorkerStatistics()
+    {
+        if (!statisticsEnabled)
+        {
+            return nullptr;
+        }
+        const int worker = JobSystem::getInstance().getCurrentWorkerIndex();
+        return worker > 0 ? &workerStatistics[worker].counts : externalThreadStatistics();
+    }
+    PipelineStatistics *externalThreadStatistics();
+
+    // 调试视图
+    DebugView debugView = DebugView::NONE;
+    std::vector<uint32_t> overdrawBuffer; // 每个像素的片段着色次数
+    uint32_t *overdrawCounts = nullptr;   // 光栅化中的帧使用热力图时指向overdrawBuffer
+    void writeOverdrawHeatmap();
 
     // 阴影相关
     std::shared_ptr<Texture> shadowMap;
-    std::unique_ptr<FrameBuffer> shadowFrameBuffer;
+    std::vector<DepthTriangle> depthTriangles; // 仅深度渲染的三角形设置缓存
+    std::array<std::vector<DepthTriangle>, 6> cubeFaceTriangles; // 立方体深度渲染的分面三角形
+
+    // 帧流水线：记录中的帧和光栅化中的帧使用不同的上下文
+    static constexpr int FRAME_CONTEXT_COUNT = 2;
+    static constexpr int GEOMETRY_GRAIN = 256; // 几何阶段每个任务处理的三角形数
+    std::array<FrameContext, FRAME_CONTEXT_COUNT> frameContexts;
+    int recordingContext = 0;  // 正在记录的帧上下文
+    int rasterContext = -1;    // 光栅化中的帧上下文，-1表示没有
+    bool framePipelining = false;
+    bool hasPendingColorTarget = false; // 流水线模式下推迟到beginRasterStage的颜色目标
+    uint32_t *pendingColorTarget = nullptr;
+    int pendingColorPitch = 0;
+    bool pendingColorReadback = false;
+
+    std::shared_ptr<IShader> getContextShader(FrameContext &context, const std::shared_ptr<IShader> &shader);
+    void rasterizeFrame(FrameContext &context);
+    static void rasterizeFrameJob(const void *data, int begin, int end);
 
     //--------------------
     // 光栅化核心方法
@@ -155,17 +356,6 @@ private:
         const std::array<ProcessedVertex, 3> &vertices,
         std::shared_ptr<IShader> shader);
 
-    // 新增的MSAA优化方法
-    void processMSAATriangleParallel(
-        const std::array<ProcessedVertex, 3> &vertices,
-        int minX, int minY, int maxX, int maxY,
-        std::shared_ptr<IShader> shader);
-        
-    void processMSAABlockPixels(
-        const std::array<ProcessedVertex, 3> &vertices,
-        int blockX, int blockY, int maxBlockX, int maxBlockY,
-        const float* edgeParams, std::shared_ptr<IShader> shader);
-
     // 新增 MSAA 采样点检测
     static const Vec2f msaaSampleOffsets[4];
     bool isSampleInTriangle(
@@ -205,7 +395,6 @@ private:
         
     float calculateFragmentDepth(
         const Vec3f &barycentric,
-        const Vec4f &weights,
         const std::array<ProcessedVertex, 3> &vertices);
         
     void interpolateVaryings(
@@ -3,6 +3,68 @@
 #include <iostream>
 #include "texture_io.h" // 添加纹理IO库
 #include "camera.h" // 引入独立的相机实现文件
+#include "job_system.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+    // 阴影基底复制每个任务的texel数
+    constexpr int SHADOW_COPY_GRAIN = 64 * 1024;
+
+    // 把仅含静态投射者的阴影基底复制回阴影贴图，之后叠加动态投射者
+    void restoreShadowBase(const std::vector<float> &base, float *target)
+    {
+        const float *source = base.data();
+        JobSystem::getInstance().parallelForRange(0, static_cast<int>(base.size()), SHADOW_COPY_GRAIN,
+                                                  [&](int begin, int end) {
+            std::copy(source + begin, source + end, target + begin);
+        });
+    }
+
+    // 模型矩阵的最大轴向缩放，用于变换包围球半径
+    float maxAxisScale(const Matrix4x4f &m)
+    {
+        const float sx = Vec3f(m.m00, m.m10, m.m20).length();
+        const float sy = Vec3f(m.m01, m.m11, m.m21).length();
+        const float sz = Vec3f(m.m02, m.m12, m.m22).length();
+        return std::max(sx, std::max(sy, sz));
+    }
+
+    // 计算网格的模型空间包围球
+    void computeMeshBounds(const Mesh &mesh, Vec3f &center, float &radius)
+    {
+        Vec3f minPos(std::numeric_limits<float>::max());
+        Vec3f maxPos(std::numeric_limits<float>::lowest());
+        if (!mesh.vertices.empty())
+        {
+            mesh.calculateBoundingBox(minPos, maxPos);
+        }
+        else
+        {
+            for (const Triangle &triangle : mesh.getTriangles())
+            {
+                for (const Vertex &vertex : triangle.vertices)
+                {
+                    minPos = min(minPos, vertex.position);
+                    maxPos = max(maxPos, vertex.position);
+                }
+            }
+        }
+
+        if (minPos.x > maxPos.x)
+        {
+            center = Vec3f(0.0f);
+            radius = 0.0f;
+            return;
+        }
+        center = (minPos + maxPos) * 0.5f;
+        radius = (maxPos - minPos).length() * 0.5f;
+    }
+}
 
 // Scene 实现
 Scene::Scene() : light(Vec3f(0.0f, 10.0f, 10.0f), Vec3f(1.0f, 1.0f, 1.0f), 1.0f, 0.2f) {}
@@ -10,6 +72,7 @@ Scene::Scene() : light(Vec3f(0.0f, 10.0f, 10.0f), Vec3f(1.0f, 1.0f, 1.0f), 1.0f,
 void Scene::addObject(const SceneObject &object)
 {
     objects.push_back(object);
+    resolvedObjectsDirty = true;
 }
 
 void Scene::removeObject(size_t index)
@@ -17,6 +80,7 @@ void Scene::removeObject(size_t index)
     if (index < objects.size())
     {
         objects.erase(objects.begin() + index);
+        resolvedObjectsDirty = true;
     }
 }
 
@@ -27,6 +91,7 @@ void Scene::removeObject(const std::string &name)
         if (it->name == name)
         {
             objects.erase(it);
+            resolvedObjectsDirty = true;
             return;
         }
     }
@@ -74,6 +139,7 @@ std::string Scene::loadMesh(const std::string &objFile, const std::string &name)
 
     // 将mesh添加到资源管理器
     resourceManager.addResource(mesh, guid);
+    resolvedObjectsDirty = true;
 
     return guid;
 }
@@ -98,6 +164,7 @@ std::string Scene::loadTexture(const std::string &filename, TextureType type)
 
     // 将纹理添加到资源管理器
     resourceManager.addResource(texture, guid);
+    resolvedObjectsDirty = true;
 
     return guid;
 }
@@ -119,6 +186,7 @@ std::string Scene::createMaterial(const std::string &name, const Surface &surfac
 
     // 将材质添加到资源管理器
     resourceManager.addResource(material, guid);
+    resolvedObjectsDirty = true;
 
     return guid;
 }
@@ -179,6 +247,7 @@ std::string Scene::createMaterialWithTextures(
 
     // 将材质添加到资源管理器
     resourceManager.addResource(material, guid);
+    resolvedObjectsDirty = true;
 
     return guid;
 }
@@ -197,15 +266,17 @@ std::string Scene::createShader(const std::string &name, std::shared_ptr<IShader
 
     // 将着色器添加到资源管理器
     resourceManager.addResource(shader, guid);
+    resolvedObjectsDirty = true;
 
     return guid;
 }
 
 // 配置阴影映射的实现
-void Scene::setupShadowMapping(bool enabled, int shadowMapSize)
+void Scene::setupShadowMapping(bool enabled, int shadowMapSize, int cascadeCount)
 {
     shadowMappingEnabled = enabled;
     this->shadowMapSize = shadowMapSize;
+    shadowCascadeCount = std::clamp(cascadeCount, 1, MAX_SHADOW_CASCADES);
 
     if (enabled)
     {
@@ -215,7 +286,7 @@ void Scene::setupShadowMapping(bool enabled, int shadowMapSize)
     }
 }
 
-// 更新阴影贴图的实现
+// 更新阴影贴图的实现：方向光使用级联阴影，点光源使用立方体阴影
 void Scene::updateShadowMap(Renderer &renderer)
 {
     if (!shadowMappingEnabled || objects.empty())
@@ -223,143 +294,575 @@ void Scene::updateShadowMap(Renderer &renderer)
         return;
     }
 
-    // 创建或获取阴影贴图
-    std::shared_ptr<Texture> shadowMap;
-    if (shadowMapGUID.empty())
+    // 创建或获取阴影贴图（各层纵向排列在同一张纹理中），层数随光源类型变化时重新创建
+    const int layers = light.type == LightType::POINT ? 6 : shadowCascadeCount;
+    std::shared_ptr<Texture> shadowMap = shadowMapGUID.empty() ? nullptr : getTexture(shadowMapGUID);
+    if (!shadowMap || shadowMap->getHeight() != shadowMapSize * layers)
     {
-        // 创建新的阴影贴图
-        shadowMap = renderer.createShadowMap(shadowMapSize, shadowMapSize);
+        shadowMap = renderer.createShadowMap(shadowMapSize, layers);
         shadowMapGUID = "texture_shadowmap";
         resourceManager.addResource(shadowMap, shadowMapGUID);
+
+        // 新纹理内容为空，缓存全部失效
+        for (ShadowCascadeCache &cache : shadowCascadeCaches)
+        {
+            cache.valid = false;
+            cache.staticDepthValid = false;
+        }
+        pointShadowCache.valid = false;
+    }
+
+    resolveObjects();
+    if (light.type == LightType::POINT)
+    {
+        updatePointShadowMap(renderer, *shadowMap);
     }
     else
     {
-        // 获取已有的阴影贴图
-        shadowMap = getTexture(shadowMapGUID);
+        updateCascadedShadowMap(renderer, *shadowMap);
     }
+}
 
-    // 计算光源的视图矩阵
-    Matrix4x4f lightViewMatrix = Matrix4x4f::lookAt(
-        light.position,           // 光源位置
-        float3(0.0f, 0.0f, 0.0f), // 观察原点
-        float3(0.0f, 1.0f, 0.0f)  // 上方向
-    );
-
-    // 计算光源的投影矩阵
-    // 注：对于方向光，可以使用正交投影；对于点光源，可以使用透视投影
-    Matrix4x4f lightProjMatrix = Matrix4x4f::perspective(
-        3.14159f / 4.0f, // FOV
-        1.0f,            // 宽高比
-        0.1f,            // 近平面
-        100.0f           // 远平面
-    );
-    // renderer.getProjMatrix();
-    // 更新光源的变换矩阵
-    light.lightViewMatrix = lightViewMatrix;
-    light.lightProjMatrix = lightProjMatrix;
+// 点光源立方体阴影：光源位置和静态投射者都未变化时复用静态部分，动态投射者每帧叠加
+void Scene::updatePointShadowMap(Renderer &renderer, Texture &shadowMap)
+{
+    const float nearPlane = POINT_SHADOW_NEAR;
+    const float farPlane = shadowDistance;
+
+    std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> staticCasters;
+    std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> dynamicCasters;
+    std::vector<uint64_t> staticStamps;
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const SceneObject &obj = objects[i];
+        const ResolvedObject &resolved = resolvedObjects[i];
+        if (!obj.castShadow || !resolved.mesh)
+        {
+            continue;
+        }
+
+        // 超出阴影范围的投射者不参与渲染
+        const Vec3f centerWS = transformNoDiv(obj.modelMatrix, resolved.boundsCenter);
+        const float radius = resolved.boundsRadius * maxAxisScale(obj.modelMatrix);
+        if ((centerWS - light.position).length() - radius > farPlane)
+        {
+            continue;
+        }
+
+        if (obj.isStatic)
+        {
+            staticCasters.push_back({resolved.mesh, obj.modelMatrix});
+            staticStamps.push_back((static_cast<uint64_t>(i) << 32) | (resolved.version & 0xFFFFFFFFu));
+        }
+        else
+        {
+            dynamicCasters.push_back({resolved.mesh, obj.modelMatrix});
+        }
+    }
+
+    PointShadowCache &cache = pointShadowCache;
+    const bool staticChanged = !cache.valid ||
+                               cache.position.x != light.position.x ||
+                               cache.position.y != light.position.y ||
+                               cache.position.z != light.position.z ||
+                               cache.farPlane != farPlane ||
+                               cache.staticStamps != staticStamps;
+    float *cubeData = shadowMap.getData<float>();
+    const size_t cubeSize = static_cast<size_t>(shadowMapSize) * shadowMapSize * 6;
+    if (dynamicCasters.empty())
+    {
+        if (staticChanged || cache.hasDynamicCasters)
+        {
+            renderer.shadowCubePass(staticCasters, light.position, nearPlane, farPlane);
+            cache.staticDepthValid = false;
+        }
+    }
+    else
+    {
+        if (staticChanged || !cache.staticDepthValid)
+        {
+            renderer.shadowCubePass(staticCasters, light.position, nearPlane, farPlane);
+            cache.staticDepth.assign(cubeData, cubeData + cubeSize);
+            cache.staticDepthValid = true;
+        }
+        else
+        {
+            restoreShadowBase(cache.staticDepth, cubeData);
+        }
+        renderer.shadowCubePass(dynamicCasters, light.position, nearPlane, farPlane, false);
+    }
+
+    cache.valid = true;
+    cache.hasDynamicCasters = !dynamicCasters.empty();
+    cache.position = light.position;
+    cache.farPlane = farPlane;
+    cache.staticStamps.swap(staticStamps);
+
+    pointShadow.faceViewProjMatrices = computeCubeFaceViewProj(light.position, nearPlane, farPlane);
+    pointShadow.position = light.position;
+    pointShadow.nearPlane = nearPlane;
+    pointShadow.farPlane = farPlane;
+    pointShadow.faceSize = shadowMapSize;
     light.castShadow = true;
-    renderer.setViewMatrix(lightViewMatrix);
-    renderer.setProjMatrix(lightProjMatrix);
-    // 收集要投射阴影的网格
-    std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> shadowCasters;
-    for (const auto &obj : objects)
+}
+
+// 方向光级联阴影：每个级联用正交投影拟合相机视锥的一段切片
+void Scene::updateCascadedShadowMap(Renderer &renderer, Texture &shadowMap)
+{
+    // 方向光：从光源位置指向原点。光源视图只含旋转，
+    // 这样级联中心在光源空间中的网格对齐不受相机平移影响
+    const Vec3f lightDir = normalize(Vec3f(0.0f) - light.position);
+    const Vec3f lightUp = std::abs(lightDir.y) > 0.99f ? Vec3f(0.0f, 0.0f, 1.0f) : Vec3f(0.0f, 1.0f, 0.0f);
+    const Matrix4x4f lightViewMatrix = Matrix4x4f::lookAt(Vec3f(0.0f), lightDir, lightUp);
+
+    // 收集投射阴影的对象，并计算其在光源空间的包围球
+    struct CasterBounds
+    {
+        size_t index;
+        Vec3f centerLS;
+        float radius;
+    };
+    std::vector<CasterBounds> casterBounds;
+    for (size_t i = 0; i < objects.size(); ++i)
     {
-        if (obj.castShadow)
+        const SceneObject &obj = objects[i];
+        const ResolvedObject &resolved = resolvedObjects[i];
+        if (obj.castShadow && resolved.mesh)
+        {
+            const Vec3f centerWS = transformNoDiv(obj.modelMatrix, resolved.boundsCenter);
+            casterBounds.push_back({i, transformNoDiv(lightViewMatrix, centerWS),
+                                    resolved.boundsRadius * maxAxisScale(obj.modelMatrix)});
+        }
+    }
+
+    // 相机基向量
+    const Vec3f cameraPos = camera.getPosition();
+    const Vec3f forward = normalize(camera.getTarget() - cameraPos);
+    const Vec3f right = normalize(cross(forward, camera.getUp()));
+    const Vec3f cameraUp = cross(right, forward);
+    const float tanHalfFov = std::tan(camera.getFOV() * 0.5f);
+    const float nearPlane = camera.getNearPlane();
+    const float farPlane = std::min(camera.getFarPlane(), shadowDistance);
+
+    // 级联区域以网格点为中心，网格步长为区域宽度的1/CASCADE_GRID_DIVISIONS。
+    // 中心就近对齐，每个轴最多偏移半个步长，由半径扩展量覆盖（代价是纹素密度降低同样的比例）
+    const float gridPadding = 1.0f / CASCADE_GRID_DIVISIONS;
+    float *shadowData = shadowMap.getData<float>();
+    const size_t layerSize = static_cast<size_t>(shadowMapSize) * shadowMapSize;
+
+    std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> staticCasters;
+    std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> dynamicCasters;
+    std::vector<uint64_t> staticStamps;
+    float sliceNear = nearPlane;
+    for (int cascadeIndex = 0; cascadeIndex < shadowCascadeCount; ++cascadeIndex)
+    {
+        // 对数分割与均匀分割混合
+        const float t = static_cast<float>(cascadeIndex + 1) / shadowCascadeCount;
+        const float logSplit = nearPlane * std::pow(farPlane / nearPlane, t);
+        const float uniformSplit = nearPlane + (farPlane - nearPlane) * t;
+        const float sliceFar = CASCADE_SPLIT_LAMBDA * logSplit + (1.0f - CASCADE_SPLIT_LAMBDA) * uniformSplit;
+
+        // 切片的包围球：半径与相机朝向无关，旋转相机时投影尺寸不变
+        Vec3f corners[8];
+        Vec3f sphereCenter(0.0f);
+        for (int c = 0; c < 8; ++c)
+        {
+            const float depth = (c & 4) ? sliceFar : sliceNear;
+            const float halfHeight = depth * tanHalfFov;
+            const float halfWidth = halfHeight * camera.getAspect();
+            corners[c] = cameraPos + forward * depth +
+                         right * ((c & 1) ? halfWidth : -halfWidth) +
+                         cameraUp * ((c & 2) ? halfHeight : -halfHeight);
+            sphereCenter += corners[c];
+        }
+        sphereCenter = sphereCenter * (1.0f / 8.0f);
+        float sliceRadius = 0.0f;
+        for (const Vec3f &corner : corners)
+        {
+            sliceRadius = std::max(sliceRadius, (corner - sphereCenter).length());
+        }
+        sliceRadius = std::ceil(sliceRadius * 16.0f) / 16.0f;
+
+        // 区域尺寸只取决于切片距离和相机视角，中心对齐到网格：相机在一个网格单元内移动时
+        // 级联矩阵完全不变，静态阴影可以直接复用。贴图尺寸是CASCADE_GRID_DIVISIONS的倍数时
+        // 网格步长是纹素的整数倍，跨越单元时阴影边缘也不闪烁
+        const float radius = sliceRadius / (1.0f - gridPadding);
+        const float gridStep = 2.0f * radius / CASCADE_GRID_DIVISIONS;
+        Vec3f centerLS = transformNoDiv(lightViewMatrix, sphereCenter);
+        centerLS.x = std::round(centerLS.x / gridStep) * gridStep;
+        centerLS.y = std::round(centerLS.y / gridStep) * gridStep;
+        centerLS.z = std::round(centerLS.z / gridStep) * gridStep;
+
+        // 深度范围只覆盖区域本身；位于光源和区域之间的投射者深度小于近平面，
+        // 正交深度渲染不按近平面裁剪，它们照常写入，因此范围与投射者无关
+        const float zNear = -centerLS.z - radius;
+        const float zFar = -centerLS.z + radius;
+        staticCasters.clear();
+        dynamicCasters.clear();
+        staticStamps.clear();
+        for (const CasterBounds &caster : casterBounds)
+        {
+            const float reach = radius + caster.radius;
+            if (std::abs(caster.centerLS.x - centerLS.x) > reach ||
+                std::abs(caster.centerLS.y - centerLS.y) > reach ||
+                -caster.centerLS.z - caster.radius > zFar)
+            {
+                continue;
+            }
+
+            const SceneObject &obj = objects[caster.index];
+            if (obj.isStatic)
+            {
+                staticCasters.push_back({resolvedObjects[caster.index].mesh, obj.modelMatrix});
+                staticStamps.push_back((static_cast<uint64_t>(caster.index) << 32) |
+                                       (resolvedObjects[caster.index].version & 0xFFFFFFFFu));
+            }
+            else
+            {
+                dynamicCasters.push_back({resolvedObjects[caster.index].mesh, obj.modelMatrix});
+            }
+        }
+
+        const Matrix4x4f lightProjMatrix = Matrix4x4f::orthographic(
+            centerLS.x - radius, centerLS.x + radius,
+            centerLS.y - radius, centerLS.y + radius,
+            zNear, zFar);
+
+        ShadowCascade &cascade = shadowCascades[cascadeIndex];
+        cascade.viewProjMatrix = lightProjMatrix * lightViewMatrix;
+        cascade.splitDepth = sliceFar;
+        cascade.depthScale = 2.0f / (zFar - zNear);
+        cascade.texelSize = 2.0f * radius / shadowMapSize;
+
+        // 级联矩阵只取决于光源方向和对齐后的区域，它或静态投射者变化时才重新渲染静态部分
+        ShadowCascadeCache &cache = shadowCascadeCaches[cascadeIndex];
+        const bool staticChanged = !cache.valid ||
+                                   std::memcmp(cache.viewProjMatrix.m, cascade.viewProjMatrix.m, sizeof(cascade.viewProjMatrix.m)) != 0 ||
+                                   cache.staticStamps != staticStamps;
+        float *layerData = shadowData + cascadeIndex * layerSize;
+
+        renderer.setViewMatrix(lightViewMatrix);
+        renderer.setProjMatrix(lightProjMatrix);
+        if (dynamicCasters.empty())
+        {
+            // 阴影层只含静态投射者，未变化时直接复用
+            if (staticChanged || cache.hasDynamicCasters)
+            {
+                renderer.shadowPass(staticCasters, cascadeIndex);
+                cache.staticDepthValid = false;
+            }
+        }
+        else
         {
-            auto mesh = getMesh(obj.meshGUID);
-            if (mesh)
+            // 静态部分保存为基底，每帧复制基底后叠加动态投射者
+            if (staticChanged || !cache.staticDepthValid)
             {
-                // 存储网格和它的模型变换矩阵
-                // 这样在阴影计算时可以应用正确的变换
-                shadowCasters.push_back({mesh, obj.modelMatrix});
+                renderer.shadowPass(staticCasters, cascadeIndex);
+                cache.staticDepth.assign(layerData, layerData + layerSize);
+                cache.staticDepthValid = true;
             }
+            else
+            {
+                restoreShadowBase(cache.staticDepth, layerData);
+            }
+            renderer.shadowPass(dynamicCasters, cascadeIndex, false);
+        }
+
+        cache.valid = true;
+        cache.hasDynamicCasters = !dynamicCasters.empty();
+        cache.viewProjMatrix = cascade.viewProjMatrix;
+        cache.staticStamps.swap(staticStamps);
+
+        if (cascadeIndex == 0)
+        {
+            light.lightProjMatrix = lightProjMatrix;
         }
+        sliceNear = sliceFar;
     }
 
-    // 渲染阴影贴图
-    renderer.shadowPass(shadowCasters);
+    // 更新光源的变换矩阵（投影为第0级联）
+    light.lightViewMatrix = lightViewMatrix;
+    light.castShadow = true;
+}
+
+// 解析被修改对象引用的资源
+void Scene::resolveObjects()
+{
+    if (resolvedObjectsDirty)
+    {
+        // 对象列表或资源集合发生变化，全部重新解析
+        resolvedObjects.clear();
+        resolvedObjects.resize(objects.size());
+        shaderIds.clear();
+        materialIds.clear();
+        resolvedObjectsDirty = false;
+    }
+
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const ResolvedObject &resolved = resolvedObjects[i];
+        const bool materialChanged = resolved.material && resolved.material->getVersion() != resolved.materialVersion;
+        if (resolved.dirty || materialChanged)
+        {
+            resolveObject(i);
+        }
+    }
+}
+
+void Scene::resolveObject(size_t index)
+{
+    const SceneObject &obj = objects[index];
+    ResolvedObject &resolved = resolvedObjects[index];
+    resolved = ResolvedObject();
+    resolved.dirty = false;
+    resolved.version = ++objectVersionCounter;
+
+    resolved.mesh = getMesh(obj.meshGUID);
+    resolved.material = getMaterial(obj.materialGUID);
+    if (!resolved.mesh || !resolved.material)
+    {
+        return;
+    }
+    resolved.materialVersion = resolved.material->getVersion();
+
+    resolved.shader = getShader(resolved.material->getShaderGUID());
+    if (!resolved.shader)
+    {
+        return;
+    }
+
+    resolved.diffuseMap = getTexture(resolved.material->getDiffuseMapGUID());
+    resolved.normalMap = getTexture(resolved.material->getNormalMapGUID());
+    computeMeshBounds(*resolved.mesh, resolved.boundsCenter, resolved.boundsRadius);
+
+    resolved.shaderId = shaderIds.emplace(resolved.shader.get(), static_cast<uint32_t>(shaderIds.size())).first->second;
+    resolved.materialId = materialIds.emplace(resolved.material.get(), static_cast<uint32_t>(materialIds.size())).first->second;
+    resolved.valid = true;
+
+    // uniform块的对象部分：模型矩阵、法线矩阵和材质
+    ShaderUniforms &uniforms = resolved.uniforms;
+    uniforms.modelMatrix = obj.modelMatrix;
+    uniforms.normalMatrix = normalMatrix(obj.modelMatrix);
+    uniforms.surface = resolved.material->getSurface();
+    uniforms.setTexture(TextureSlot::COLOR_MAP, resolved.diffuseMap.get());
+    uniforms.setTexture(TextureSlot::NORMAL_MAP, resolved.normalMap.get());
+}
+
+// 收集绘制项：不透明按着色器/材质分组并从前到后，半透明从后到前
+void Scene::buildRenderQueue(const Matrix4x4f &viewMatrix)
+{
+    renderQueue.clear();
+    renderQueue.reserve(objects.size());
+
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        const ResolvedObject &resolved = resolvedObjects[i];
+        if (!resolved.valid)
+        {
+            continue;
+        }
+
+        // 包围球中心的视空间深度（相机看向-Z）
+        const Vec3f centerWS = transformNoDiv(objects[i].modelMatrix, resolved.boundsCenter);
+        const float viewDepth = -transformNoDiv(viewMatrix, centerWS).z;
+
+        const uint64_t key = resolved.material->isTransparent()
+                                 ? RenderQueue::makeTransparentKey(resolved.shaderId, resolved.materialId, viewDepth)
+                                 : RenderQueue::makeOpaqueKey(resolved.shaderId, resolved.materialId, viewDepth);
+        renderQueue.submit(key, static_cast<uint32_t>(i));
+    }
+
+    renderQueue.sort();
+}
+
+// 更新帧级uniform状态，只有相机、光源或阴影状态变化时才递增版本号
+void Scene::updateFrameUniforms(const Renderer &renderer, const Texture *shadowMap)
+{
+    auto sameMatrix = [](const Matrix4x4f &a, const Matrix4x4f &b) {
+        return std::memcmp(a.m, b.m, sizeof(a.m)) == 0;
+    };
+    auto sameVec = [](const Vec3f &a, const Vec3f &b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    };
+
+    const Matrix4x4f viewMatrix = renderer.getViewMatrix();
+    const Matrix4x4f projMatrix = renderer.getProjMatrix();
+    const Vec3f eyePosition = renderer.getEye();
+    const Matrix4x4f lightSpaceMatrix = light.lightProjMatrix * light.lightViewMatrix;
+    const bool useShadowMap = shadowMappingEnabled && shadowMap;
+    const bool pointLight = light.type == LightType::POINT;
+    const int cascadeCount = pointLight ? 0 : shadowCascadeCount;
+    const PointShadow activePointShadow = pointLight ? pointShadow : PointShadow();
+    const LightGrid *activeLightGrid = pointLights.empty() ? nullptr : &lightGrid;
+
+    const Light &cached = frameUniforms.light;
+    const bool unchanged = frameUniformsVersion != 0 &&
+                           sameMatrix(viewMatrix, frameUniforms.viewMatrix) &&
+                           sameMatrix(projMatrix, frameUniforms.projMatrix) &&
+                           sameMatrix(lightSpaceMatrix, frameUniforms.lightSpaceMatrix) &&
+                           sameVec(eyePosition, frameUniforms.eyePosition) &&
+                           sameVec(light.position, cached.position) &&
+                           sameVec(light.color, cached.color) &&
+                           light.intensity == cached.intensity &&
+                           light.ambientIntensity == cached.ambientIntensity &&
+                           light.castShadow == cached.castShadow &&
+                           useShadowMap == frameUniforms.useShadowMap &&
+                           light.type == cached.type &&
+                           cascadeCount == frameUniforms.shadowCascadeCount &&
+                           std::memcmp(shadowCascades.data(), frameUniforms.shadowCascades.data(),
+                                       sizeof(ShadowCascade) * cascadeCount) == 0 &&
+                           std::memcmp(&activePointShadow, &frameUniforms.pointShadow, sizeof(PointShadow)) == 0 &&
+                           activeLightGrid == frameUniforms.lightGrid &&
+                           shadowMap == frameUniforms.getTexture(TextureSlot::SHADOW_MAP);
+    if (unchanged)
+    {
+        return;
+    }
+
+    frameUniforms.viewMatrix = viewMatrix;
+    frameUniforms.projMatrix = projMatrix;
+    frameUniforms.eyePosition = eyePosition;
+    frameUniforms.light = light;
+    frameUniforms.lightSpaceMatrix = lightSpaceMatrix;
+    frameUniforms.useShadowMap = useShadowMap;
+    frameUniforms.shadowCascadeCount = cascadeCount;
+    frameUniforms.shadowCascades = shadowCascades;
+    frameUniforms.pointShadow = activePointShadow;
+    frameUniforms.lightGrid = activeLightGrid;
+    frameUniforms.setTexture(TextureSlot::SHADOW_MAP, shadowMap);
+    frameViewProjMatrix = projMatrix * viewMatrix;
+    ++frameUniformsVersion;
+}
+
+// 帧状态或对象变化后，重新计算对象uniform块中依赖帧状态的派生矩阵
+void Scene::updateObjectFrameUniforms(size_t index)
+{
+    ResolvedObject &resolved = resolvedObjects[index];
+    if (resolved.uniformsFrameVersion == frameUniformsVersion)
+    {
+        return;
+    }
+
+    ShaderUniforms &uniforms = resolved.uniforms;
+    uniforms.viewMatrix = frameUniforms.viewMatrix;
+    uniforms.projMatrix = frameUniforms.projMatrix;
+    uniforms.eyePosition = frameUniforms.eyePosition;
+    uniforms.light = frameUniforms.light;
+    uniforms.lightSpaceMatrix = frameUniforms.lightSpaceMatrix;
+    uniforms.mvpMatrix = frameViewProjMatrix * uniforms.modelMatrix;
+    uniforms.lightMVPMatrix = frameUniforms.lightSpaceMatrix * uniforms.modelMatrix;
+    uniforms.shadowCascadeCount = frameUniforms.shadowCascadeCount;
+    uniforms.shadowCascades = frameUniforms.shadowCascades;
+    uniforms.pointShadow = frameUniforms.pointShadow;
+    uniforms.lightGrid = frameUniforms.lightGrid;
+
+    // 如果启用了阴影映射，设置阴影相关参数
+    uniforms.useShadowMap = frameUniforms.useShadowMap && objects[index].receiveShadow;
+    uniforms.setTexture(TextureSlot::SHADOW_MAP,
+                        uniforms.useShadowMap ? frameUniforms.getTexture(TextureSlot::SHADOW_MAP) : nullptr);
+
+    resolved.uniformsFrameVersion = frameUniformsVersion;
+}
+
+// 分块光源剔除：先渲染不透明物体的相机深度，得到每个tile的深度范围，再为每个tile收集相交的点光源
+void Scene::updateLightGrid(Renderer &renderer)
+{
+    if (pointLights.empty())
+    {
+        return;
+    }
+    PROFILE_SCOPE("Scene::lightGrid");
+
+    // 半透明物体不写入预渲染深度，存在时tile的近端不能按深度收缩
+    depthPrepassMeshes.clear();
+    bool hasTransparent = false;
+    for (const DrawItem &item : renderQueue.getItems())
+    {
+        const ResolvedObject &resolved = resolvedObjects[item.objectIndex];
+        if (resolved.material->isTransparent())
+        {
+            hasTransparent = true;
+            continue;
+        }
+        depthPrepassMeshes.push_back({resolved.mesh, objects[item.objectIndex].modelMatrix});
+    }
+
+    const int width = renderer.getFrameBuffer().getWidth();
+    const int height = renderer.getFrameBuffer().getHeight();
+    lightCullingDepth.resize(static_cast<size_t>(width) * height);
+    renderer.renderDepthOnly(depthPrepassMeshes, lightCullingDepth.data(), width, height);
+
+    lightGrid.build(pointLights, renderer.getViewMatrix(), renderer.getProjMatrix(),
+                    lightCullingDepth.data(), width, height, hasTransparent);
 }
 
 // 渲染场景的实现
 void Scene::render(Renderer &renderer)
 {
-    // 如果启用了阴影映射，先更新阴影贴图
+    PROFILE_SCOPE("Scene::render");
+    resolveObjects();
+
+    // 应用相机设置
+    const Matrix4x4f viewMatrix = camera.getViewMatrix();
+    const Matrix4x4f projMatrix = camera.getProjectionMatrix();
+    renderer.setViewMatrix(viewMatrix);
+    renderer.setProjMatrix(projMatrix);
+    renderer.setEye(camera.getPosition());
+
+    // 收集并排序绘制项
+    buildRenderQueue(viewMatrix);
+
+    // 几何阶段：顶点着色只依赖对象和相机，用相机矩阵补全uniform快照即可提前执行，
+    // 启用帧流水线时与上一帧的光栅化重叠
+    renderer.beginFrame();
+    const Matrix4x4f viewProjMatrix = projMatrix * viewMatrix;
+    for (const DrawItem &item : renderQueue.getItems())
+    {
+        const ResolvedObject &resolved = resolvedObjects[item.objectIndex];
+        ShaderUniforms uniforms = resolved.uniforms;
+        uniforms.viewMatrix = viewMatrix;
+        uniforms.projMatrix = projMatrix;
+        uniforms.eyePosition = camera.getPosition();
+        uniforms.mvpMatrix = viewProjMatrix * uniforms.modelMatrix;
+        renderer.submitDraw(resolved.mesh, resolved.shader, uniforms);
+    }
+    renderer.processFrameGeometry();
+
+    // 以下修改阴影贴图、光源网格和帧缓冲，需等待上一帧的光栅化完成
+    renderer.beginRasterStage();
+
+    // 如果启用了阴影映射，更新阴影贴图（会临时改写渲染器的视图/投影矩阵）
     if (shadowMappingEnabled)
     {
+        PROFILE_SCOPE("Scene::shadow");
         updateShadowMap(renderer);
+        renderer.setViewMatrix(viewMatrix);
+        renderer.setProjMatrix(projMatrix);
     }
 
-    // 应用相机设置
-    renderer.setViewMatrix(camera.getViewMatrix());
-    renderer.setProjMatrix(camera.getProjectionMatrix());
-    renderer.setEye(camera.getPosition());
-
     // 设置光源
     renderer.setLight(light);
 
     // 清屏
     renderer.clear(float4(0.16f, 0.16f, 0.24f, 1.0f)); // 深蓝灰色背景
 
-    // 准备光源空间变换矩阵，用于阴影映射
-    Matrix4x4f lightSpaceMatrix = light.lightProjMatrix * light.lightViewMatrix;
-
     // 准备阴影贴图
     std::shared_ptr<Texture> shadowMap = nullptr;
     if (shadowMappingEnabled)
     {
         shadowMap = getTexture(shadowMapGUID);
     }
+    updateFrameUniforms(renderer, shadowMap.get());
 
-    // 渲染所有对象
-    for (const auto &obj : objects)
-    {
-        // 设置模型变换
-        renderer.setModelMatrix(obj.modelMatrix);
-
-        // 获取网格和材质
-        auto mesh = getMesh(obj.meshGUID);
-        auto material = getMaterial(obj.materialGUID);
+    // 为局部点光源构建分块列表
+    updateLightGrid(renderer);
 
-        if (!mesh || !material)
-        {
-            continue;
-        }
-
-        // 获取着色器
-        auto shader = getShader(material->getShaderGUID());
-        if (!shader)
-        {
-            continue;
-        }
-
-        // 设置着色器的统一变量
-        ShaderUniforms uniforms;
-        uniforms.modelMatrix = obj.modelMatrix;
-        uniforms.viewMatrix = renderer.getViewMatrix();
-        uniforms.projMatrix = renderer.getProjMatrix();
-        uniforms.mvpMatrix = renderer.getMVPMatrix();
-        uniforms.eyePosition = renderer.getEye();
-        uniforms.light = renderer.getLight();
-        uniforms.surface = material->getSurface();
-        uniforms.textures[_ColorMap] = getTexture(material->getDiffuseMapGUID());
-        
-        uniforms.textures[_NormalMap] = getTexture(material->getNormalMapGUID());
-
-        // 如果启用了阴影映射，设置阴影相关参数
-        if (shadowMappingEnabled && obj.receiveShadow && shadowMap)
-        {
-            uniforms.useShadowMap = true;
-            uniforms.textures[_ShadowMap] = shadowMap;
-            uniforms.lightSpaceMatrix = lightSpaceMatrix;
-        }
-        else
-        {
-            uniforms.useShadowMap = false;
-        }
-
-        shader->setUniforms(uniforms);
-
-        // 使用对象的材质和着色器渲染网格
-        renderer.drawMeshPass(mesh, shader);
+    // 光栅化阶段使用完整的uniform块，uniform块跨帧保留，只在对象、材质或帧状态变化时更新
+    const std::vector<DrawItem> &items = renderQueue.getItems();
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        updateObjectFrameUniforms(items[i].objectIndex);
+        renderer.setDrawUniforms(i, resolvedObjects[items[i].objectIndex].uniforms);
     }
-}
\ No newline at end of file
+    renderer.endFrame();
+}
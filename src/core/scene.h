@@ -6,6 +6,8 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <array>
+#include <unordered_map>
 #include "maths.h"
 #include "mesh.h"
 #include "shader.h"
@@ -15,6 +17,8 @@
 #include "texture.h"      // 使用新的纹理库
 #include "texture_types.h" // 使用新的纹理类型定义
 #include "camera.h" // 引入独立的相机头文件
+#include "render_queue.h" // 渲染队列
+#include "light_grid.h"   // 分块光源剔除
 
 // 场景对象，包含网格和材质
 struct SceneObject {
@@ -24,6 +28,7 @@ struct SceneObject {
     Matrix4x4f modelMatrix;           // 模型矩阵
     bool castShadow;                  // 是否投射阴影
     bool receiveShadow;               // 是否接收阴影
+    bool isStatic = true;             // 静态对象：阴影深度可跨帧缓存，动态对象每帧重新光栅化
     
     SceneObject() : castShadow(true), receiveShadow(true) {}
     SceneObject(const std::string& name, const std::string& meshGUID, 
@@ -33,6 +38,48 @@ struct SceneObject {
           modelMatrix(matrix), castShadow(castShadow), receiveShadow(receiveShadow) {}
 };
 
+// 场景对象的资源解析缓存，避免每帧按GUID查找网格、材质和着色器
+struct ResolvedObject {
+    std::shared_ptr<Mesh> mesh;
+    std::shared_ptr<Material> material;
+    std::shared_ptr<IShader> shader;
+    std::shared_ptr<Texture> diffuseMap;
+    std::shared_ptr<Texture> normalMap;
+    Vec3f boundsCenter;               // 模型空间包围球中心
+    float boundsRadius = 0.0f;        // 模型空间包围球半径
+    uint32_t shaderId = 0;            // 排序用着色器ID
+    uint32_t materialId = 0;          // 排序用材质ID
+    uint32_t materialVersion = 0;     // 解析时的材质版本号
+    uint64_t version = 0;             // 每次重新解析时递增，用于阴影缓存失效判断
+    bool valid = false;               // 资源是否完整
+    bool dirty = true;                // 对象被修改过，需要重新解析
+
+    // 跨帧持久的uniform块：对象部分在解析时更新，帧部分在帧状态版本变化时更新
+    ShaderUniforms uniforms;
+    uint64_t uniformsFrameVersion = 0; // 构建帧部分时的帧状态版本
+};
+
+// 单个阴影级联的缓存状态：级联矩阵和静态投射者版本不变时跳过重新渲染
+struct ShadowCascadeCache {
+    bool valid = false;                 // 阴影层内容是否有效
+    bool hasDynamicCasters = false;     // 阴影层中是否叠加了动态投射者
+    Matrix4x4f viewProjMatrix;          // 渲染时的级联矩阵
+    std::vector<uint64_t> staticStamps; // 静态投射者的(对象索引 << 32 | 版本)
+    std::vector<float> staticDepth;     // 仅含静态投射者的深度，有动态投射者时作为每帧的基底
+    bool staticDepthValid = false;
+};
+
+// 点光源立方体阴影的缓存状态，静态/动态投射者的处理与级联相同
+struct PointShadowCache {
+    bool valid = false;
+    bool hasDynamicCasters = false;
+    Vec3f position;                     // 渲染时的光源位置
+    float farPlane = 0.0f;              // 渲染时的远平面
+    std::vector<uint64_t> staticStamps; // 静态投射者的(对象索引 << 32 | 版本)
+    std::vector<float> staticDepth;     // 仅含静态投射者的六个面
+    bool staticDepthValid = false;
+};
+
 // 场景类
 class Scene {
     public:
@@ -46,13 +93,26 @@ class Scene {
         // 光源管理
         void setLight(const Light& light) { this->light = light; }
         Light getLight() const { return light; }
+
+        // 局部点光源管理：不投射阴影，每帧按屏幕tile剔除后只在受影响的片元上计算
+        size_t addPointLight(const PointLight& light) { pointLights.push_back(light); return pointLights.size() - 1; }
+        PointLight& getPointLight(size_t index) { return pointLights[index]; }
+        const PointLight& getPointLight(size_t index) const { return pointLights[index]; }
+        size_t getPointLightCount() const { return pointLights.size(); }
+        void clearPointLights() { pointLights.clear(); }
+        const LightGrid& getLightGrid() const { return lightGrid; }
         
         // 场景对象管理
         void addObject(const SceneObject& object);
         void removeObject(size_t index);
         void removeObject(const std::string& name);
         size_t getObjectCount() const { return objects.size(); }
-        SceneObject& getObject(size_t index) { return objects[index]; }
+        // 可写访问可能修改变换或GUID，标记该对象需重新解析
+        SceneObject& getObject(size_t index)
+        {
+            if (index < resolvedObjects.size()) resolvedObjects[index].dirty = true;
+            return objects[index];
+        }
         const SceneObject& getObject(size_t index) const { return objects[index]; }
         
         // 资源管理
@@ -90,8 +150,11 @@ class Scene {
         // 创建着色器
         std::string createShader(const std::string& name, std::shared_ptr<IShader> shader);
         
-        // 配置阴影映射
-        void setupShadowMapping(bool enabled, int shadowMapSize = 1024);
+        // 配置阴影映射：shadowMapSize为每个级联的分辨率
+        void setupShadowMapping(bool enabled, int shadowMapSize = 512, int cascadeCount = 3);
+        // 阴影覆盖的最大距离：方向光为相机视距（同时受相机远平面限制），点光源为立方体阴影的远平面
+        void setShadowDistance(float distance) { shadowDistance = distance; }
+        float getShadowDistance() const { return shadowDistance; }
         
         // 渲染场景
         void render(Renderer& renderer);
@@ -102,12 +165,55 @@ class Scene {
     private:
         Camera camera;                      // 场景相机
         Light light;                        // 主光源
+        std::vector<PointLight> pointLights; // 局部点光源
         std::vector<SceneObject> objects;   // 场景对象列表
         ResourceManager resourceManager;    // 资源管理器
         
+        // 渲染队列相关
+        std::vector<ResolvedObject> resolvedObjects; // 与objects一一对应的解析缓存
+        bool resolvedObjectsDirty = true;            // 对象列表或资源集合变化，需要全部重新解析
+        std::unordered_map<const IShader*, uint32_t> shaderIds;
+        std::unordered_map<const Material*, uint32_t> materialIds;
+        RenderQueue renderQueue;
+
+        // 分块光源剔除：相机深度预渲染 + 每个tile的光源列表
+        LightGrid lightGrid;
+        std::vector<float> lightCullingDepth;
+        std::vector<std::pair<std::shared_ptr<Mesh>, Matrix4x4f>> depthPrepassMeshes;
+        void updateLightGrid(Renderer &renderer);
+
+        // 帧级uniform状态（相机、光源、阴影），变化时递增版本号
+        ShaderUniforms frameUniforms;
+        Matrix4x4f frameViewProjMatrix;
+        uint64_t frameUniformsVersion = 0;
+
+        // 重新解析被修改对象引用的资源，并更新其uniform块的对象部分
+        void resolveObjects();
+        void resolveObject(size_t index);
+        // 收集绘制项并排序
+        void buildRenderQueue(const Matrix4x4f &viewMatrix);
+        // 更新帧级uniform状态
+        void updateFrameUniforms(const Renderer &renderer, const Texture *shadowMap);
+        // 按需更新对象uniform块的帧部分
+        void updateObjectFrameUniforms(size_t index);
+        
         // 阴影映射相关
         bool shadowMappingEnabled = false;
-        int shadowMapSize = 1024;
+        int shadowMapSize = 512;
+        int shadowCascadeCount = 3;
+        float shadowDistance = 30.0f;
+        std::array<ShadowCascade, MAX_SHADOW_CASCADES> shadowCascades{};
+        std::array<ShadowCascadeCache, MAX_SHADOW_CASCADES> shadowCascadeCaches;
+        uint64_t objectVersionCounter = 0;                   // ResolvedObject::version的来源
+        static constexpr float CASCADE_SPLIT_LAMBDA = 0.75f; // 对数分割的权重
+        static constexpr int CASCADE_GRID_DIVISIONS = 8;     // 级联中心按区域宽度的1/8对齐
+        PointShadow pointShadow;                             // 点光源立方体阴影参数
+        PointShadowCache pointShadowCache;
+        static constexpr float POINT_SHADOW_NEAR = 0.05f;    // 立方体阴影的近平面
         std::string shadowMapGUID;
         std::string shadowShaderGUID;
+
+        // 按光源类型渲染阴影
+        void updateCascadedShadowMap(Renderer &renderer, Texture &shadowMap);
+        void updatePointShadowMap(Renderer &renderer, Texture &shadowMap);
     };
\ No newline at end of file
@@ -0,0 +1,161 @@
+// simd_dispatch.cpp
+#include "simd_dispatch.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace simd_baseline { extern const SimdKernels kernels; }
+#ifdef SR_SIMD_X86
+namespace simd_sse42 { extern const SimdKernels kernels; }
+namespace simd_avx2 { extern const SimdKernels kernels; }
+namespace simd_avx512 { extern const SimdKernels kernels; }
+#endif
+
+namespace
+{
+    // 本构建包含的kernel表，未以对应指令集编译的级别为nullptr
+    const SimdKernels *kernelTable(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SimdLevel::BASELINE:
+            return &simd_baseline::kernels;
+#ifdef SR_SIMD_X86
+        case SimdLevel::SSE42:
+            return &simd_sse42::kernels;
+        case SimdLevel::AVX2:
+            return &simd_avx2::kernels;
+        case SimdLevel::AVX512:
+            return &simd_avx512::kernels;
+#endif
+        default:
+            return nullptr;
+        }
+    }
+
+    // cpuid检测；__builtin_cpu_supports同时检查操作系统是否保存了对应的向量寄存器状态（XGETBV）
+    SimdLevel detectCpuLevel()
+    {
+#if defined(SR_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+        {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"))
+        {
+            return SimdLevel::SSE42;
+        }
+#endif
+        return SimdLevel::BASELINE;
+    }
+
+    struct Dispatch
+    {
+        SimdLevel maxLevel = SimdLevel::BASELINE;
+        std::atomic<SimdLevel> level{SimdLevel::BASELINE};
+        std::atomic<const SimdKernels *> kernels{&simd_baseline::kernels};
+
+        Dispatch()
+        {
+            maxLevel = detectCpuLevel();
+            while (!kernelTable(maxLevel))
+            {
+                maxLevel = static_cast<SimdLevel>(static_cast<int>(maxLevel) - 1);
+            }
+            SimdLevel initial = maxLevel;
+            // 环境变量SR_SIMD强制使用较低的级别，用于比较各级别的性能
+            if (const char *env = std::getenv("SR_SIMD"))
+            {
+                if (!parseSimdLevel(env, initial))
+                {
+                    std::cerr << "[SIMD] 无法识别SR_SIMD=" << env << "，使用 " << getSimdLevelName(maxLevel) << std::endl;
+                    initial = maxLevel;
+                }
+            }
+            select(initial);
+        }
+
+        SimdLevel select(SimdLevel requested)
+        {
+            if (static_cast<int>(requested) > static_cast<int>(maxLevel))
+            {
+                std::cerr << "[SIMD] CPU或本构建不支持 " << getSimdLevelName(requested) << "，使用 "
+                          << getSimdLevelName(maxLevel) << std::endl;
+                requested = maxLevel;
+            }
+            level.store(requested, std::memory_order_relaxed);
+            kernels.store(kernelTable(requested), std::memory_order_release);
+            return requested;
+        }
+    };
+
+    Dispatch &dispatch()
+    {
+        static Dispatch instance;
+        return instance;
+    }
+}
+
+const SimdKernels &simdKernels()
+{
+    return *dispatch().kernels.load(std::memory_order_acquire);
+}
+
+SimdLevel getSimdLevel()
+{
+    return dispatch().level.load(std::memory_order_relaxed);
+}
+
+SimdLevel getMaxSimdLevel()
+{
+    return dispatch().maxLevel;
+}
+
+SimdLevel setSimdLevel(SimdLevel level)
+{
+    return dispatch().select(level);
+}
+
+const char *getSimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::BASELINE:
+        return "baseline";
+    case SimdLevel::SSE42:
+        return "sse4.2";
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::AVX512:
+        return "avx512";
+    default:
+        return "unknown";
+    }
+}
+
+bool parseSimdLevel(const char *name, SimdLevel &level)
+{
+    const struct
+    {
+        const char *name;
+        SimdLevel level;
+    } names[] = {{"baseline", SimdLevel::BASELINE}, {"sse2", SimdLevel::BASELINE},
+                 {"sse4.2", SimdLevel::SSE42}, {"sse42", SimdLevel::SSE42},
+                 {"avx2", SimdLevel::AVX2}, {"avx512", SimdLevel::AVX512}};
+    for (const auto &entry : names)
+    {
+        if (std::strcmp(name, entry.name) == 0)
+        {
+            level = entry.level;
+            return true;
+        }
+    }
+    return false;
+}
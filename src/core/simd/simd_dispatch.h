@@ -0,0 +1,55 @@
+// simd_dispatch.h
+// 热点kernel的运行时指令集分发：同一份kernel源码按多个指令集级别各编译一份，
+// 启动时按cpuid选择CPU支持的最高级别，发布的二进制不需要-march=native
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 指令集级别，按从低到高排列
+enum class SimdLevel : int
+{
+    BASELINE = 0, // 编译器默认目标（x86-64为SSE2）
+    SSE42,        // SSE4.2 + POPCNT
+    AVX2,         // AVX2，256位向量
+    AVX512,       // AVX-512 F/BW/DQ/VL，512位向量
+    COUNT
+};
+
+/**
+ * kernel函数表。接口只使用基本类型的指针：kernel翻译单元以不同的-m选项编译，
+ * 不能调用头文件中的内联函数（链接器可能把高指令集版本的内联函数副本用于其他代码）。
+ * 所有级别关闭浮点乘加融合，各级别的结果逐位一致，与标量代码的运算顺序也相同。
+ */
+struct SimdKernels
+{
+    // 一行像素的三角形覆盖：第k个像素的边函数值为start[i] + step[i] * (first + k)，
+    // 三条边都 >= 0 时mask[k] = 1，否则为0；返回覆盖的像素数
+    int (*coverageRow)(const float *start, const float *step, int first, int count, uint8_t *mask);
+    // 同上，边函数在像素中心直接求值：dx[i] * (y + 0.5) + dy[i] * (x0 + k + 0.5) + c[i]（确定性光栅化）
+    int (*coverageRowDirect)(const float *dx, const float *dy, const float *c, int x0, int y, int count, uint8_t *mask);
+    // 仅深度光栅化的一行：第k个像素的边函数值为start[i] + step[i] * k，深度为z0 + zStep * k，
+    // 覆盖且深度小于row[k]时写入
+    void (*depthRow)(const float *start, const float *step, float z0, float zStep, int count, float *row);
+    // 顶点位置变换：positions中每个位置的xyz相隔stride个float，输出齐次坐标（w取1）到out，每个4个float；
+    // matrix为按行存储的4x4矩阵
+    void (*transformPositions)(const float *matrix, const float *positions, size_t stride, size_t count, float *out);
+    // 用value填充count个float（深度目标清除）
+    void (*fillFloat)(float *dst, size_t count, float value);
+};
+
+// 当前使用的kernel表，首次调用时按CPU和环境变量SR_SIMD选择
+const SimdKernels &simdKernels();
+
+// 当前使用的指令集级别
+SimdLevel getSimdLevel();
+// CPU支持且本构建包含的最高级别
+SimdLevel getMaxSimdLevel();
+// 切换级别（用于基准测试比较），超过getMaxSimdLevel时降为最高可用级别，返回实际使用的级别。
+// 只能在没有光栅化任务运行时调用
+SimdLevel setSimdLevel(SimdLevel level);
+
+const char *getSimdLevelName(SimdLevel level);
+// 解析级别名（baseline/sse2, sse4.2, avx2, avx512），无法识别时返回false
+bool parseSimdLevel(const char *name, SimdLevel &level);
@@ -0,0 +1,108 @@
+// simd_kernels.inl
+// kernel实现，由simd_kernels_<级别>.cpp定义SR_SIMD_NAMESPACE后包含，CMake为每个文件添加对应的-m选项。
+// 循环写成无分支的形式并标注#pragma omp simd，由编译器按目标指令集向量化。
+// 这里只能使用内建运算：头文件中的内联函数会以本文件的指令集生成副本，可能被链接到其他翻译单元。
+
+#include "simd_dispatch.h"
+
+namespace SR_SIMD_NAMESPACE
+{
+    namespace
+    {
+        int coverageRow(const float *start, const float *step, int first, int count, uint8_t *mask)
+        {
+            const float s0 = start[0], s1 = start[1], s2 = start[2];
+            const float d0 = step[0], d1 = step[1], d2 = step[2];
+            int covered = 0;
+#pragma omp simd reduction(+ : covered)
+            for (int k = 0; k < count; ++k)
+            {
+                const float offset = static_cast<float>(first + k);
+                const float e0 = s0 + d0 * offset;
+                const float e1 = s1 + d1 * offset;
+                const float e2 = s2 + d2 * offset;
+                const int inside = (e0 >= 0.0f) & (e1 >= 0.0f) & (e2 >= 0.0f);
+                mask[k] = static_cast<uint8_t>(inside);
+                covered += inside;
+            }
+            return covered;
+        }
+
+        int coverageRowDirect(const float *dx, const float *dy, const float *c, int x0, int y, int count, uint8_t *mask)
+        {
+            const float centerY = y + 0.5f;
+            const float r0 = dx[0] * centerY, r1 = dx[1] * centerY, r2 = dx[2] * centerY;
+            const float d0 = dy[0], d1 = dy[1], d2 = dy[2];
+            const float c0 = c[0], c1 = c[1], c2 = c[2];
+            int covered = 0;
+#pragma omp simd reduction(+ : covered)
+            for (int k = 0; k < count; ++k)
+            {
+                const float centerX = static_cast<float>(x0 + k) + 0.5f;
+                const float e0 = r0 + d0 * centerX + c0;
+                const float e1 = r1 + d1 * centerX + c1;
+                const float e2 = r2 + d2 * centerX + c2;
+                const int inside = (e0 >= 0.0f) & (e1 >= 0.0f) & (e2 >= 0.0f);
+                mask[k] = static_cast<uint8_t>(inside);
+                covered += inside;
+            }
+            return covered;
+        }
+
+        void depthRow(const float *start, const float *step, float z0, float zStep, int count, float *row)
+        {
+            const float s0 = start[0], s1 = start[1], s2 = start[2];
+            const float d0 = step[0], d1 = step[1], d2 = step[2];
+#pragma omp simd
+            for (int k = 0; k < count; ++k)
+            {
+                const float offset = static_cast<float>(k);
+                const float e0 = s0 + d0 * offset;
+                const float e1 = s1 + d1 * offset;
+                const float e2 = s2 + d2 * offset;
+                const float z = z0 + zStep * offset;
+                const float current = row[k];
+                const bool write = (e0 >= 0.0f) & (e1 >= 0.0f) & (e2 >= 0.0f) & (z < current);
+                row[k] = write ? z : current;
+            }
+        }
+
+        void transformPositions(const float *matrix, const float *positions, size_t stride, size_t count, float *out)
+        {
+            const float m00 = matrix[0], m01 = matrix[1], m02 = matrix[2], m03 = matrix[3];
+            const float m10 = matrix[4], m11 = matrix[5], m12 = matrix[6], m13 = matrix[7];
+            const float m20 = matrix[8], m21 = matrix[9], m22 = matrix[10], m23 = matrix[11];
+            const float m30 = matrix[12], m31 = matrix[13], m32 = matrix[14], m33 = matrix[15];
+            // 与Matrix4x4::transform的运算顺序相同（w = 1时m*3 * w即m*3）
+#pragma omp simd
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float x = positions[i * stride];
+                const float y = positions[i * stride + 1];
+                const float z = positions[i * stride + 2];
+                out[i * 4] = m00 * x + m01 * y + m02 * z + m03;
+                out[i * 4 + 1] = m10 * x + m11 * y + m12 * z + m13;
+                out[i * 4 + 2] = m20 * x + m21 * y + m22 * z + m23;
+                out[i * 4 + 3] = m30 * x + m31 * y + m32 * z + m33;
+            }
+        }
+
+        void fillFloat(float *dst, size_t count, float value)
+        {
+#pragma omp simd
+            for (size_t i = 0; i < count; ++i)
+            {
+                dst[i] = value;
+            }
+        }
+    }
+
+    extern const SimdKernels kernels;
+    const SimdKernels kernels = {
+        &coverageRow,
+        &coverageRowDirect,
+        &depthRow,
+        &transformPositions,
+        &fillFloat,
+    };
+}
@@ -0,0 +1,9 @@
+// simd_kernels_avx2.cpp
+// AVX2级别的kernel，CMake在x86上为本文件添加-mavx2
+
+#if defined(SR_SIMD_X86) && !defined(__AVX2__)
+#error "simd_kernels_avx2.cpp需要以-mavx2编译"
+#endif
+
+#define SR_SIMD_NAMESPACE simd_avx2
+#include "simd_kernels.inl"
@@ -0,0 +1,9 @@
+// simd_kernels_avx512.cpp
+// AVX-512级别的kernel，CMake在x86上为本文件添加-mavx512f -mavx512bw -mavx512dq -mavx512vl
+
+#if defined(SR_SIMD_X86) && !defined(__AVX512F__)
+#error "simd_kernels_avx512.cpp需要以-mavx512f编译"
+#endif
+
+#define SR_SIMD_NAMESPACE simd_avx512
+#include "simd_kernels.inl"
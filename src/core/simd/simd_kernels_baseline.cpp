@@ -0,0 +1,5 @@
+// simd_kernels_baseline.cpp
+// 基础级别的kernel，使用编译器的默认目标
+
+#define SR_SIMD_NAMESPACE simd_baseline
+#include "simd_kernels.inl"
@@ -0,0 +1,9 @@
+// simd_kernels_sse42.cpp
+// SSE4.2级别的kernel，CMake在x86上为本文件添加-msse4.2 -mpopcnt
+
+#if defined(SR_SIMD_X86) && !defined(__SSE4_2__)
+#error "simd_kernels_sse42.cpp需要以-msse4.2编译"
+#endif
+
+#define SR_SIMD_NAMESPACE simd_sse42
+#include "simd_kernels.inl"
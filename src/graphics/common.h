@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include "maths.h"
 
@@ -64,9 +65,17 @@ struct Vertex
         : position(pos), normal(norm), tangent(tan), texCoord(tex), color(col.toFloat4()) {}
 };
 
+// 光源类型
+enum class LightType
+{
+    DIRECTIONAL, // 方向光：从position指向原点，使用级联阴影
+    POINT        // 点光源：使用立方体阴影
+};
+
 // 光照结构体
 struct Light
 {
+    LightType type = LightType::DIRECTIONAL; // 光源类型（决定阴影方式）
     float3 position;        // 光源位置
     float3 color;           // 光源颜色
     float intensity;        // 光源强度
@@ -82,6 +91,41 @@ struct Light
         : position(pos), color(col), intensity(intens), ambientIntensity(ambIntens), castShadow(false) {}
 };
 
+// 局部点光源：无阴影，影响范围为以range为半径的球，由分块光源剔除分配到屏幕tile
+struct PointLight
+{
+    float3 position;         // 光源位置（世界空间）
+    float3 color;            // 光源颜色
+    float intensity = 1.0f;  // 光源强度
+    float range = 5.0f;      // 影响半径，超出后贡献为0
+
+    PointLight() : position(0, 0, 0), color(1, 1, 1) {}
+    PointLight(const float3 &pos, const float3 &col, float intens, float range)
+        : position(pos), color(col), intensity(intens), range(range) {}
+};
+
+// 级联阴影的最大级数
+constexpr int MAX_SHADOW_CASCADES = 4;
+
+// 单个阴影级联：正交光源投影拟合到相机视锥的一段切片
+struct ShadowCascade
+{
+    Matrix4x4f viewProjMatrix; // 世界空间到该级联光源裁剪空间
+    float splitDepth = 0.0f;   // 切片远端的相机视空间深度
+    float depthScale = 0.0f;   // 世界单位到NDC深度的比例（2 / (far - near)）
+    float texelSize = 0.0f;    // 单个阴影纹素覆盖的世界空间尺寸
+};
+
+// 点光源立方体阴影：6个面纵向排列在阴影贴图中，顺序为 +X, -X, +Y, -Y, +Z, -Z
+struct PointShadow
+{
+    std::array<Matrix4x4f, 6> faceViewProjMatrices; // 各面世界空间到光源裁剪空间
+    float3 position;         // 光源位置
+    float nearPlane = 0.0f;  // 各面透视投影的近平面
+    float farPlane = 0.0f;   // 各面透视投影的远平面
+    int faceSize = 0;        // 每个面的分辨率，0表示未启用
+};
+
 // 表面材质属性结构体保持不变
 struct Surface
 {
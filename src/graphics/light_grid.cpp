@@ -0,0 +1,161 @@
+// light_grid.cpp
+#include "light_grid.h"
+#include "job_system.h"
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // 平面 n·p + d >= 0 为内侧，n已归一化
+    struct Plane
+    {
+        float nx, ny, nz, d;
+    };
+
+    // 由视图投影矩阵的两行组合出裁剪平面：a * rowA + b * rowB
+    Plane makePlane(const Matrix4x4f &m, int rowA, float a, int rowB, float b)
+    {
+        Plane plane{
+            a * m.m[rowA * 4 + 0] + b * m.m[rowB * 4 + 0],
+            a * m.m[rowA * 4 + 1] + b * m.m[rowB * 4 + 1],
+            a * m.m[rowA * 4 + 2] + b * m.m[rowB * 4 + 2],
+            a * m.m[rowA * 4 + 3] + b * m.m[rowB * 4 + 3]};
+        const float invLength = 1.0f / std::sqrt(plane.nx * plane.nx + plane.ny * plane.ny + plane.nz * plane.nz);
+        plane.nx *= invLength;
+        plane.ny *= invLength;
+        plane.nz *= invLength;
+        plane.d *= invLength;
+        return plane;
+    }
+
+    // 屏幕矩形[left, right] x [bottom, top]（NDC）对应的四个侧平面
+    // 裁剪空间中 x >= left * w 即 (row0 - left * row3)·p >= 0，其余同理，对透视和正交投影都成立
+    void makeSidePlanes(const Matrix4x4f &viewProj, float left, float right, float bottom, float top, Plane planes[4])
+    {
+        planes[0] = makePlane(viewProj, 0, 1.0f, 3, -left);
+        planes[1] = makePlane(viewProj, 0, -1.0f, 3, right);
+        planes[2] = makePlane(viewProj, 1, 1.0f, 3, -bottom);
+        planes[3] = makePlane(viewProj, 1, -1.0f, 3, top);
+    }
+
+    bool sphereInsidePlanes(const Plane planes[4], const Vec3f &center, float radius)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            const Plane &p = planes[i];
+            if (p.nx * center.x + p.ny * center.y + p.nz * center.z + p.d < -radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void LightGrid::build(const std::vector<PointLight> &lights,
+                      const Matrix4x4f &viewMatrix, const Matrix4x4f &projMatrix,
+                      const float *depth, int width, int height, bool conservativeNear)
+{
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    tileLists.resize(static_cast<size_t>(tilesX) * tilesY);
+    for (std::vector<uint32_t> &list : tileLists)
+    {
+        list.clear();
+    }
+    this->lights = lights;
+    if (lights.empty() || width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // NDC深度转换为相机视空间深度（正值），由 ndcZ = (m22 * z + m23) / (m32 * z + m33) 反解
+    const Matrix4x4f &proj = projMatrix;
+    auto linearDepth = [&proj](float ndcZ) {
+        return -(proj.m23 - ndcZ * proj.m33) / (ndcZ * proj.m32 - proj.m22);
+    };
+    const float nearDepth = linearDepth(-1.0f);
+    const float farDepth = linearDepth(1.0f);
+    const Matrix4x4f viewProj = projMatrix * viewMatrix;
+
+    // 先对整个视锥剔除，tile只测试可见光源
+    Plane screenPlanes[4];
+    makeSidePlanes(viewProj, -1.0f, 1.0f, -1.0f, 1.0f, screenPlanes);
+    visibleLights.clear();
+    lightViewDepths.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i)
+    {
+        const PointLight &light = lights[i];
+        const float viewDepth = -transformNoDiv(viewMatrix, light.position).z;
+        lightViewDepths[i] = viewDepth;
+        if (viewDepth + light.range < nearDepth || viewDepth - light.range > farDepth)
+        {
+            continue;
+        }
+        if (sphereInsidePlanes(screenPlanes, light.position, light.range))
+        {
+            visibleLights.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    if (visibleLights.empty())
+    {
+        return;
+    }
+
+    JobSystem::getInstance().parallelFor(0, tilesX * tilesY, 4, [&](int tile) {
+        const int tx = tile % tilesX, ty = tile / tilesX;
+        const int x0 = tx * TILE_SIZE, x1 = std::min(x0 + TILE_SIZE, width);
+        const int y0 = ty * TILE_SIZE, y1 = std::min(y0 + TILE_SIZE, height);
+
+        // tile的深度范围：只统计被几何覆盖的像素（深度小于清除值1.0）
+        float tileNear = nearDepth, tileFar = farDepth;
+        if (depth)
+        {
+            float minZ = 1.0f, maxZ = -std::numeric_limits<float>::max();
+            for (int y = y0; y < y1; ++y)
+            {
+                const float *row = depth + static_cast<size_t>(y) * width;
+                for (int x = x0; x < x1; ++x)
+                {
+                    if (row[x] < 1.0f)
+                    {
+                        minZ = std::min(minZ, row[x]);
+                        maxZ = std::max(maxZ, row[x]);
+                    }
+                }
+            }
+
+            if (maxZ >= minZ)
+            {
+                tileNear = conservativeNear ? nearDepth : std::max(linearDepth(minZ), nearDepth);
+                tileFar = std::min(linearDepth(maxZ), farDepth);
+            }
+            else if (!conservativeNear)
+            {
+                return; // tile内没有几何，不会产生片元
+            }
+        }
+
+        // 像素坐标转NDC：屏幕y向下，NDC y向上
+        Plane tilePlanes[4];
+        makeSidePlanes(viewProj,
+                       2.0f * x0 / width - 1.0f, 2.0f * x1 / width - 1.0f,
+                       1.0f - 2.0f * y1 / height, 1.0f - 2.0f * y0 / height,
+                       tilePlanes);
+
+        std::vector<uint32_t> &list = tileLists[ty * tilesX + tx];
+        for (uint32_t index : visibleLights)
+        {
+            const PointLight &light = lights[index];
+            const float viewDepth = lightViewDepths[index];
+            if (viewDepth + light.range < tileNear || viewDepth - light.range > tileFar)
+            {
+                continue;
+            }
+            if (sphereInsidePlanes(tilePlanes, light.position, light.range))
+            {
+                list.push_back(index);
+            }
+        }
+    });
+}
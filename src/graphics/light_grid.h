@@ -0,0 +1,63 @@
+// light_grid.h
+// 分块光源剔除：按16x16像素的屏幕tile收集影响范围与tile视锥（含深度范围）相交的点光源
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "maths.h"
+#include "common.h"
+
+class LightGrid
+{
+public:
+    static constexpr int TILE_SIZE = 16;
+
+    // tile内的光源索引列表
+    struct TileLights
+    {
+        const uint32_t *indices = nullptr;
+        uint32_t count = 0;
+    };
+
+    LightGrid() = default;
+    ~LightGrid() = default;
+
+    /**
+     * 重建光源网格
+     * @param lights     场景中的点光源
+     * @param viewMatrix 相机视图矩阵
+     * @param projMatrix 相机投影矩阵
+     * @param depth      屏幕空间深度（NDC z，width * height个float，清除值为1.0），
+     *                   为nullptr时每个tile使用完整的视锥深度范围
+     * @param conservativeNear 为true时tile的近端不收缩到深度缓冲（深度中缺少半透明物体时使用）
+     */
+    void build(const std::vector<PointLight> &lights,
+               const Matrix4x4f &viewMatrix, const Matrix4x4f &projMatrix,
+               const float *depth, int width, int height, bool conservativeNear = false);
+
+    // 获取像素坐标所在tile的光源列表
+    TileLights getTileLights(float x, float y) const
+    {
+        const int tx = std::clamp(static_cast<int>(x) / TILE_SIZE, 0, tilesX - 1);
+        const int ty = std::clamp(static_cast<int>(y) / TILE_SIZE, 0, tilesY - 1);
+        const std::vector<uint32_t> &list = tileLists[ty * tilesX + tx];
+        return {list.data(), static_cast<uint32_t>(list.size())};
+    }
+
+    const PointLight &getLight(uint32_t index) const { return lights[index]; }
+    size_t getLightCount() const { return lights.size(); }
+    bool empty() const { return lights.empty(); }
+
+    int getTilesX() const { return tilesX; }
+    int getTilesY() const { return tilesY; }
+
+private:
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<PointLight> lights;                 // 本帧的光源副本，着色时按索引访问
+    std::vector<std::vector<uint32_t>> tileLists;   // 每个tile的光源索引（跨帧复用容量）
+    std::vector<uint32_t> visibleLights;            // 通过整个视锥测试的光源
+    std::vector<float> lightViewDepths;             // 光源中心的相机视空间深度
+};
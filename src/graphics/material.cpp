@@ -30,6 +30,7 @@ Material::Material(const Surface& surface)
 
 void Material::setSurface(const Surface& surface) {
     this->surface = surface;
+    ++version;
 }
 
 const Surface& Material::getSurface() const {
@@ -42,6 +43,7 @@ const Surface& Material::getSurface() const {
 
 void Material::setShaderGUID(const std::string& guid) {
     this->shaderGUID = guid;
+    ++version;
 }
 
 const std::string& Material::getShaderGUID() const {
@@ -59,6 +61,7 @@ void Material::addTextureGUID(const std::string& name, const std::string& guid)
     }
     
     textureGUIDs[name] = guid;
+    ++version;
 }
 
 std::string Material::getTextureGUID(const std::string& name) const {
@@ -107,12 +110,26 @@ std::string Material::getSpecularMapGUID() const {
 
 void Material::setReceiveShadow(bool receive) {
     this->receiveShadow = receive;
+    ++version;
 }
 
 bool Material::getReceiveShadow() const {
     return receiveShadow;
 }
 
+//===========================
+// 渲染队列设置实现
+//===========================
+
+void Material::setTransparent(bool transparent) {
+    this->transparent = transparent;
+    ++version;
+}
+
+bool Material::isTransparent() const {
+    return transparent;
+}
+
 //===========================
 // 材质工厂函数实现
 //===========================
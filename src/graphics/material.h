@@ -49,11 +49,20 @@ public:
     void setReceiveShadow(bool receive);
     bool getReceiveShadow() const;
 
+    // 渲染队列设置（半透明材质从后到前绘制）
+    void setTransparent(bool transparent);
+    bool isTransparent() const;
+
+    // 版本号：任何属性修改都会递增，供渲染端判断缓存是否失效
+    uint32_t getVersion() const { return version; }
+
 private:
     Surface surface;                                     // 表面属性
     std::string shaderGUID;                              // 着色器GUID
     std::unordered_map<std::string, std::string> textureGUIDs;  // 纹理GUID映射表
     bool receiveShadow{true};                            // 是否接收阴影
+    bool transparent{false};                             // 是否为半透明材质
+    uint32_t version{0};                                 // 修改版本号
 };
 
 // 材质工厂函数
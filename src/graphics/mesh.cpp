@@ -234,7 +234,7 @@ void Mesh::triangulate()
         triangles.insert(triangles.end(), faceTriangles.begin(), faceTriangles.end());
     }
     
-    std::cout << "已将 " << faces.size() << " 个面转换为 " << triangles.size() << " 个三角形。" << std::endl;
+    std::cerr << "已将 " << faces.size() << " 个面转换为 " << triangles.size() << " 个三角形。" << std::endl;
 }
 
 // 将triangulateFace方法更新为用float4存储顶点颜色
@@ -409,7 +409,7 @@ std::shared_ptr<Mesh> loadOBJ(const std::string& filename) {
     // 预先将所有面转换为三角形
     mesh->triangulate();
     
-    std::cout << "已加载 " << filename << "：" << mesh->getVertexCount() << " 个顶点，" 
+    std::cerr << "已加载 " << filename << "：" << mesh->getVertexCount() << " 个顶点，" 
               << mesh->getFaceCount() << " 个面，" << mesh->getTriangleCount() << " 个三角形。" << std::endl;
     
     return mesh;
@@ -51,6 +51,45 @@ Matrix4x4<T>  Matrix4x4<T>::transposed() const
     return result;
 }
 
+// 矩阵求逆（伴随矩阵法）
+template<typename T>
+Matrix4x4<T> Matrix4x4<T>::inverse() const
+{
+    const T* a = m;
+    T inv[16];
+
+    inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+    inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+    inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+    inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+    inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+    inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+    inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+    inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+    inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+    inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+    inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+    inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+    inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+    inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+    inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+    inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+    T det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+    if (std::abs(det) < static_cast<T>(1e-12))
+    {
+        return Matrix4x4<T>();
+    }
+
+    Matrix4x4<T> result;
+    T invDet = static_cast<T>(1) / det;
+    for (int i = 0; i < 16; i++)
+    {
+        result.m[i] = inv[i] * invDet;
+    }
+    return result;
+}
+
 // 变换向量
 template<typename T>
 Vec4<T> Matrix4x4<T>::transform(const Vec4<T>& v) const
@@ -140,6 +179,18 @@ Matrix4x4<T> Matrix4x4<T>::perspective(T fovY, T aspect, T zNear, T zFar) {
     return result;
 }
 
+template<typename T>
+Matrix4x4<T> Matrix4x4<T>::orthographic(T left, T right, T bottom, T top, T zNear, T zFar) {
+    Matrix4x4<T> result;
+    result.m00 = static_cast<T>(2) / (right - left);
+    result.m11 = static_cast<T>(2) / (top - bottom);
+    result.m22 = -static_cast<T>(2) / (zFar - zNear);
+    result.m03 = -(right + left) / (right - left);
+    result.m13 = -(top + bottom) / (top - bottom);
+    result.m23 = -(zFar + zNear) / (zFar - zNear);
+    return result;
+}
+
 template<typename T>
 Matrix4x4<T> Matrix4x4<T>::lookAt(const Vec3<T>& eye, const Vec3<T>& target, const Vec3<T>& up) {
     // 计算相机坐标系
@@ -178,7 +229,9 @@ template Matrix4x4<float> Matrix4x4<float>::rotationX(float angle);
 template Matrix4x4<float> Matrix4x4<float>::rotationY(float angle);
 template Matrix4x4<float> Matrix4x4<float>::rotationZ(float angle);
 template Matrix4x4<float> Matrix4x4<float>::perspective(float fovY, float aspect, float zNear, float zFar);
+template Matrix4x4<float> Matrix4x4<float>::orthographic(float left, float right, float bottom, float top, float zNear, float zFar);
 template Matrix4x4<float> Matrix4x4<float>::lookAt(const Vec3<float>& eye, const Vec3<float>& target, const Vec3<float>& up);
+template Matrix4x4<float> Matrix4x4<float>::inverse() const;
 template Vec4<float> Matrix4x4<float>::transform(const Vec4<float>& vec) const;
 template Vec4<float> Matrix4x4<float>::operator*(const Vec4<float>& v) const;
 
@@ -218,10 +271,18 @@ Vec3f transformDir(const Matrix4x4f& mat, const Vec3f& dir) {
     );
 }
 
-Vec3f transformNormal(const Matrix4x4f& modelMatrix, const Vec3f& normal) {
-    // 简化实现: 假设模型矩阵只有旋转和均匀缩放，可以直接使用模型矩阵
+Vec3f transformNormal(const Matrix4x4f& normalMatrix, const Vec3f& normal) {
+    // 传入预先计算的法线矩阵，支持非均匀缩放
+    return normalize(transformDir(normalMatrix, normal));
+}
 
-    return normalize(transformDir(modelMatrix,normal));
+Matrix4x4f normalMatrix(const Matrix4x4f& modelMatrix) {
+    // 仅保留左上3x3，平移不影响法线
+    Matrix4x4f linear = modelMatrix;
+    linear.m03 = linear.m13 = linear.m23 = 0.0f;
+    linear.m30 = linear.m31 = linear.m32 = 0.0f;
+    linear.m33 = 1.0f;
+    return linear.inverse().transposed();
 }
 
 
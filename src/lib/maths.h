@@ -259,11 +259,13 @@ struct Matrix4x4
     static Matrix4x4<T> rotationY(T angle);                                                   // 绕Y轴旋转
     static Matrix4x4<T> rotationZ(T angle);                                                   // 绕Z轴旋转
     static Matrix4x4<T> perspective(T fovY, T aspect, T zNear, T zFar);                       // 透视投影矩阵
+    static Matrix4x4<T> orthographic(T left, T right, T bottom, T top, T zNear, T zFar);      // 正交投影矩阵
     static Matrix4x4<T> lookAt(const Vec3<T> &eye, const Vec3<T> &target, const Vec3<T> &up); // 视图矩阵
     
     Matrix4x4 operator*(const Matrix4x4 &other) const; // 矩阵乘法
    
     Matrix4x4 transposed() const; // 矩阵转置
+    Matrix4x4 inverse() const;    // 矩阵求逆（不可逆时返回单位矩阵）
     Vec4<T> transform(const Vec4<T>& v) const;  // 变换向量
     Vec4<T> operator*(const Vec4<T>& v) const; // 变换向量
 };
@@ -274,7 +276,8 @@ using Matrix4x4f = Matrix4x4<float>;
 Vec3f transform(const Matrix4x4f &matrix, const Vec3f &vector, float w = 1.0f);
 Vec3f transformNoDiv(const Matrix4x4f &matrix, const Vec3f &vector, float w = 1.0f);
 Vec3f transformDir(const Matrix4x4f &mat, const Vec3f &dir);
-Vec3f transformNormal(const Matrix4x4f &modelMatrix, const Vec3f &normal);
+Vec3f transformNormal(const Matrix4x4f &normalMatrix, const Vec3f &normal);
+Matrix4x4f normalMatrix(const Matrix4x4f &modelMatrix); // 法线矩阵（模型矩阵左上3x3的逆转置）
 
 
 // Shader Common
@@ -50,3 +50,33 @@ private:
     float anisotropy;
 };
 
+
+// 比较采样器状态：用于阴影贴图的深度比较和百分比渐近过滤（PCF）
+class SamplerComparisonState
+{
+public:
+    static constexpr int MAX_KERNEL_SIZE = 7;
+
+    // kernelSize为PCF核的边长（奇数，1表示单个双线性比较）
+    SamplerComparisonState(CompareFunc compareFunc = CompareFunc::LESS_EQUAL,
+                           TextureFilter filter = TextureFilter::LINEAR,
+                           int kernelSize = 1)
+        : compareFunc(compareFunc), filter(filter),
+          kernelSize(kernelSize < 1 ? 1 : (kernelSize > MAX_KERNEL_SIZE ? MAX_KERNEL_SIZE : (kernelSize | 1))) {}
+
+    // Getters
+    CompareFunc getCompareFunc() const { return compareFunc; }
+    TextureFilter getFilter() const { return filter; }
+    int getKernelSize() const { return kernelSize; }
+
+    // 预定义的常用比较采样器状态（包裹模式固定为CLAMP）
+    static const SamplerComparisonState SHADOW_POINT;   // 单点硬比较
+    static const SamplerComparisonState SHADOW_LINEAR;  // 2x2双线性比较
+    static const SamplerComparisonState SHADOW_PCF_3X3; // 3x3双线性PCF
+    static const SamplerComparisonState SHADOW_PCF_5X5; // 5x5双线性PCF
+
+private:
+    CompareFunc compareFunc;
+    TextureFilter filter;
+    int kernelSize;
+};
@@ -102,7 +102,7 @@ bool Texture::saveToFile(const std::string &filename, int level, TextureFileForm
         return false;
     }
 
-    std::cout << "已保存纹理到文件: " << filename << " (" << mipLevel.width << "x" << mipLevel.height
+    std::cerr << "已保存纹理到文件: " << filename << " (" << mipLevel.width << "x" << mipLevel.height
               << ", 级别: " << level << ")" << std::endl;
 
     return true;
@@ -146,7 +146,7 @@ bool Texture::saveDepthToFile(const std::string &filename,
         return false;
     }
 
-    std::cout << "已保存深度数据到文件: " << filename << " (" << baseLevel.width << "x" << baseLevel.height << ")" << std::endl;
+    std::cerr << "已保存深度数据到文件: " << filename << " (" << baseLevel.width << "x" << baseLevel.height << ")" << std::endl;
 
     return true;
 }
@@ -185,7 +185,7 @@ bool Texture::create(int width, int height, TextureFormat format, TextureAccess
         this->generateMipmaps();
     }
 
-    std::cout << "已创建空白纹理: " << width << "x" << height
+    std::cerr << "已创建空白纹理: " << width << "x" << height
               << ", 格式: " << static_cast<int>(format)
               << ", 访问模式: " << static_cast<int>(access)
               << ", Mipmap级别: " << mipLevels.size() << std::endl;
@@ -241,7 +241,7 @@ bool Texture::loadFromFile(const std::string &filename, TextureFileFormat filefo
         return false;
     }
 
-    std::cout << "已加载纹理: " << filename << " (" << fileWidth << "x" << fileHeight
+    std::cerr << "已加载纹理: " << filename << " (" << fileWidth << "x" << fileHeight
               << ", " << fileChannels << "通道)" << std::endl;
 
     return true;
@@ -291,7 +291,7 @@ bool Texture::generateMipmaps()
         currentLevel = nextLevel;
     }
 
-    std::cout << "已生成" << mipLevels.size() << "级mipmap链" << std::endl;
+    std::cerr << "已生成" << mipLevels.size() << "级mipmap链" << std::endl;
     return true;
 }
 
@@ -316,6 +316,9 @@ float4 Texture::sampleGrad(float2 uv, float2 ddx, float2 ddy, const SamplerState
 float Texture::sampleDepth(float2 uv, const SamplerState &samplerState) const{
     return TextureSampler::sampleDepth(this, uv, samplerState);
 }
+float Texture::sampleCmp(float2 uv, float compareValue, const SamplerComparisonState &samplerState) const{
+    return TextureSampler::sampleCmp(this, uv, compareValue, samplerState);
+}
 
 int Texture::getBytesPerPixel() const
 {
@@ -34,6 +34,7 @@ public:
     float4 sampleLevel(float2 uv, float level, const SamplerState &samplerState) const;
     float4 sampleGrad(float2 uv, float2 ddx, float2 ddy, const SamplerState &samplerState) const;
     float sampleDepth(float2 uv, const SamplerState &samplerState) const;
+    float sampleCmp(float2 uv, float compareValue, const SamplerComparisonState &samplerState) const;
 
     // 直接像素访问
     float4 read(int x, int y, int level = 0) const;
@@ -75,6 +76,27 @@ private:
     // 获取直接像素索引
     size_t getPixelIndex(int x, int y, int width) const;
 };
+// 直接访问指定mipmap级别的原始存储，T需与纹理格式的像素布局一致
+template <typename T>
+T *Texture::getData(int level)
+{
+    if (level < 0 || level >= static_cast<int>(mipLevels.size()))
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<T *>(mipLevels[level].data->data());
+}
+
+template <typename T>
+const T *Texture::getData(int level) const
+{
+    if (level < 0 || level >= static_cast<int>(mipLevels.size()))
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const T *>(mipLevels[level].data->data());
+}
+
 namespace textures{
 // 工厂函数
 std::shared_ptr<Texture> loadTexture(const std::string &filename, TextureFileFormat format = TextureFileFormat::TGA);
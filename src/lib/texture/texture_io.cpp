@@ -105,7 +105,7 @@ namespace texture_io
             data = std::move(flippedData);
         }
 
-        std::cout << "已加载TGA纹理: " << filename << " (" << width << "x" << height
+        std::cerr << "已加载TGA纹理: " << filename << " (" << width << "x" << height
                   << ", " << static_cast<int>(header.bitsPerPixel) << "位每像素)" << std::endl;
 
         return true;
@@ -196,7 +196,7 @@ namespace texture_io
         // 写入TGA尾部
         writeFooter(file);
 
-        std::cout << "成功保存到TGA文件：" << filename << " (" << width << "x" << height
+        std::cerr << "成功保存到TGA文件：" << filename << " (" << width << "x" << height
                   << ", " << (channels * 8) << "位每像素)" << std::endl;
 
         return true;
@@ -239,7 +239,7 @@ namespace texture_io
         // 写入TGA尾部
         writeFooter(file);
 
-        std::cout << "成功保存灰度数据到TGA文件：" << filename << " (" << width << "x" << height
+        std::cerr << "成功保存灰度数据到TGA文件：" << filename << " (" << width << "x" << height
                   << ", 8位每像素)" << std::endl;
 
         return true;
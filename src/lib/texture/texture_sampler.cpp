@@ -15,6 +15,12 @@ const SamplerState SamplerState::TRILINEAR_CLAMP(TextureFilter::TRILINEAR, Textu
 const SamplerState SamplerState::TRILINEAR_REPEAT(TextureFilter::TRILINEAR, TextureWrapMode::REPEAT, TextureWrapMode::REPEAT);
 const SamplerState SamplerState::TRILINEAR_MIRROR(TextureFilter::TRILINEAR, TextureWrapMode::MIRROR, TextureWrapMode::MIRROR);
 
+// 预定义比较采样器状态
+const SamplerComparisonState SamplerComparisonState::SHADOW_POINT(CompareFunc::LESS_EQUAL, TextureFilter::POINT, 1);
+const SamplerComparisonState SamplerComparisonState::SHADOW_LINEAR(CompareFunc::LESS_EQUAL, TextureFilter::LINEAR, 1);
+const SamplerComparisonState SamplerComparisonState::SHADOW_PCF_3X3(CompareFunc::LESS_EQUAL, TextureFilter::LINEAR, 3);
+const SamplerComparisonState SamplerComparisonState::SHADOW_PCF_5X5(CompareFunc::LESS_EQUAL, TextureFilter::LINEAR, 5);
+
 
 // 错误检查和采样辅助函数
 inline float4 TextureSampler::getErrorColor() {
@@ -77,6 +83,141 @@ float TextureSampler::sampleDepth(const Texture* texture, float2 uv, const Sampl
     return sample(texture, uv, samplerState).x;
 }
 
+namespace
+{
+    // 比较单个纹素，通过返回1，否则返回0
+    inline float compareTexel(float compareValue, float texel, CompareFunc func)
+    {
+        switch (func)
+        {
+        case CompareFunc::LESS:
+            return compareValue < texel ? 1.0f : 0.0f;
+        case CompareFunc::LESS_EQUAL:
+            return compareValue <= texel ? 1.0f : 0.0f;
+        case CompareFunc::GREATER:
+            return compareValue > texel ? 1.0f : 0.0f;
+        case CompareFunc::GREATER_EQUAL:
+            return compareValue >= texel ? 1.0f : 0.0f;
+        }
+        return 0.0f;
+    }
+
+    // 一行纹素的加权比较和：行内连续读取R32_FLOAT数据，便于编译器向量化
+    template <CompareFunc Func>
+    inline float compareRow(const float *row, const float *weights, int count, float compareValue)
+    {
+        float sum = 0.0f;
+        #pragma omp simd reduction(+ : sum)
+        for (int i = 0; i < count; ++i)
+        {
+            bool pass;
+            if constexpr (Func == CompareFunc::LESS)
+                pass = compareValue < row[i];
+            else if constexpr (Func == CompareFunc::LESS_EQUAL)
+                pass = compareValue <= row[i];
+            else if constexpr (Func == CompareFunc::GREATER)
+                pass = compareValue > row[i];
+            else
+                pass = compareValue >= row[i];
+            sum += pass ? weights[i] : 0.0f;
+        }
+        return sum;
+    }
+
+    template <CompareFunc Func>
+    float compareFootprint(const float *data, int width, int x0, int y0,
+                           const float *weightsX, const float *weightsY, int count, float compareValue)
+    {
+        float sum = 0.0f;
+        for (int j = 0; j < count; ++j)
+        {
+            sum += weightsY[j] * compareRow<Func>(data + static_cast<size_t>(y0 + j) * width + x0, weightsX, count, compareValue);
+        }
+        return sum;
+    }
+}
+
+// 比较采样
+// N x N的双线性PCF等价于在(N+1) x (N+1)个纹素上做一次可分离加权：
+// 首行/首列权重为(1 - f)，末行/末列为f，中间为1，总权重为N * N
+float TextureSampler::sampleCmp(const Texture* texture, float2 uv, float compareValue, const SamplerComparisonState& samplerState) {
+    if (!texture || texture->getMipmapCount() == 0) {
+        return 1.0f;
+    }
+
+    const int width = texture->getWidth();
+    const int height = texture->getHeight();
+    const CompareFunc func = samplerState.getCompareFunc();
+    const int kernelSize = samplerState.getKernelSize();
+    const int kernelRadius = kernelSize / 2;
+
+    float tx = std::clamp(uv.x, 0.0f, 1.0f) * width;
+    float ty = std::clamp(uv.y, 0.0f, 1.0f) * height;
+
+    // 计算采样足迹的起点和各行/列权重
+    int x0, y0, count;
+    float weightsX[SamplerComparisonState::MAX_KERNEL_SIZE + 1];
+    float weightsY[SamplerComparisonState::MAX_KERNEL_SIZE + 1];
+    if (samplerState.getFilter() == TextureFilter::POINT) {
+        x0 = static_cast<int>(tx) - kernelRadius;
+        y0 = static_cast<int>(ty) - kernelRadius;
+        count = kernelSize;
+        std::fill(weightsX, weightsX + count, 1.0f);
+        std::fill(weightsY, weightsY + count, 1.0f);
+    } else {
+        tx -= 0.5f;
+        ty -= 0.5f;
+        const float floorX = std::floor(tx);
+        const float floorY = std::floor(ty);
+        const float fx = tx - floorX;
+        const float fy = ty - floorY;
+        x0 = static_cast<int>(floorX) - kernelRadius;
+        y0 = static_cast<int>(floorY) - kernelRadius;
+        count = kernelSize + 1;
+        std::fill(weightsX, weightsX + count, 1.0f);
+        std::fill(weightsY, weightsY + count, 1.0f);
+        weightsX[0] = 1.0f - fx;
+        weightsX[count - 1] = fx;
+        weightsY[0] = 1.0f - fy;
+        weightsY[count - 1] = fy;
+    }
+    const float invTotalWeight = 1.0f / static_cast<float>(kernelSize * kernelSize);
+
+    // 快速路径：R32_FLOAT且足迹完全在纹理内，直接按行读取原始数据
+    const float *data = texture->getFormat() == TextureFormat::R32_FLOAT ? texture->getData<float>() : nullptr;
+    if (data && x0 >= 0 && y0 >= 0 && x0 + count <= width && y0 + count <= height) {
+        float sum;
+        switch (func) {
+            case CompareFunc::LESS:
+                sum = compareFootprint<CompareFunc::LESS>(data, width, x0, y0, weightsX, weightsY, count, compareValue);
+                break;
+            case CompareFunc::GREATER:
+                sum = compareFootprint<CompareFunc::GREATER>(data, width, x0, y0, weightsX, weightsY, count, compareValue);
+                break;
+            case CompareFunc::GREATER_EQUAL:
+                sum = compareFootprint<CompareFunc::GREATER_EQUAL>(data, width, x0, y0, weightsX, weightsY, count, compareValue);
+                break;
+            case CompareFunc::LESS_EQUAL:
+            default:
+                sum = compareFootprint<CompareFunc::LESS_EQUAL>(data, width, x0, y0, weightsX, weightsY, count, compareValue);
+                break;
+        }
+        return sum * invTotalWeight;
+    }
+
+    // 通用路径：边界钳制，任意格式取第一个通道
+    float sum = 0.0f;
+    for (int j = 0; j < count; ++j) {
+        const int y = std::clamp(y0 + j, 0, height - 1);
+        for (int i = 0; i < count; ++i) {
+            const int x = std::clamp(x0 + i, 0, width - 1);
+            const float texel = data ? data[static_cast<size_t>(y) * width + x] : texture->read(x, y).x;
+            sum += weightsY[j] * weightsX[i] * compareTexel(compareValue, texel, func);
+        }
+    }
+    return sum * invTotalWeight;
+}
+
 // 根据过滤模式选择合适的采样方法
 float4 TextureSampler::sampleWithFilter(const Texture* texture, float u, float v, float mipLevel, const SamplerState& samplerState) {
     switch (samplerState.getFilter()) {
@@ -25,6 +25,9 @@ public:
     // 阴影贴图专用采样方法
     static float sampleDepth(const Texture* texture, float2 uv, const SamplerState& samplerState);
 
+    // 比较采样：先与参考值比较再过滤，返回[0,1]的通过比例
+    static float sampleCmp(const Texture* texture, float2 uv, float compareValue, const SamplerComparisonState& samplerState);
+
 private:
     // 不同采样模式实现
     static float4 sampleWithFilter(const Texture* texture, float u, float v, float mipLevel, const SamplerState& samplerState);
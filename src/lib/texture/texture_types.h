@@ -66,6 +66,15 @@ enum class TextureWrapMode
     MIRROR  // 镜像模式（纹理坐标取模后在0.5-1.0范围内反转）
 };
 
+// 比较采样的比较函数：参考值 op 纹素值 成立时结果为1
+enum class CompareFunc
+{
+    LESS,          // 参考值 <  纹素值
+    LESS_EQUAL,    // 参考值 <= 纹素值（阴影：片段不比遮挡物更远时受光）
+    GREATER,       // 参考值 >  纹素值
+    GREATER_EQUAL  // 参考值 >= 纹素值
+};
+
 // Mipmap级别数据 - 使用智能指针优化内存管理
 struct MipmapLevel
 {
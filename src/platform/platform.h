@@ -19,7 +19,17 @@ bool platform_should_close(void);
 
 // 渲染相关
 void* platform_get_framebuffer(void);
-void platform_update_framebuffer(void);
+// 把platform_get_framebuffer的内容上传到第slot个纹理并呈现；该纹理正被锁定时不做任何事，
+// 帧流水线中应传入未锁定的槽位（通常是本帧自己的槽位）
+void platform_update_framebuffer(int slot);
+
+// 零复制呈现：锁定第slot个流式纹理，渲染器直接写入ARGB8888像素（pitch为每行字节数）
+// 共有PLATFORM_FRAMEBUFFER_SLOTS个纹理：一个在呈现、一个在光栅化、一个等待下一帧写入
+// 纹理尺寸与width/height不一致或锁定失败时返回NULL，此时应使用上面的复制路径
+#define PLATFORM_FRAMEBUFFER_SLOTS 3
+void* platform_lock_framebuffer(int slot, int width, int height, int* pitch);
+// 解锁第slot个纹理并呈现，与platform_lock_framebuffer成对调用
+void platform_present_framebuffer(int slot);
 
 // 事件处理
 void platform_process_events(void);
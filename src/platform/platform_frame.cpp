@@ -0,0 +1,37 @@
+#include "platform_frame.h"
+#include "platform.h"
+
+// 将渲染器的帧缓冲区复制到平台帧缓冲区
+void copyFrameBufferToPlatform(const Renderer &renderer)
+{
+    // 获取平台帧缓冲区
+    uint32_t *dst = static_cast<uint32_t *>(platform_get_framebuffer());
+
+    // 直接使用帧缓冲区内置的复制方法
+    renderer.getFrameBuffer().copyToPlatform(dst);
+}
+
+// 锁定平台纹理作为渲染器的颜色目标，失败时渲染器使用内部存储
+bool beginPlatformFrame(Renderer &renderer, bool readback)
+{
+    const FrameBuffer &frameBuffer = renderer.getFrameBuffer();
+    int pitch = 0;
+    void *pixels = platform_lock_framebuffer(0, frameBuffer.getWidth(), frameBuffer.getHeight(), &pitch);
+    renderer.setColorTarget(static_cast<uint32_t *>(pixels), pitch / static_cast<int>(sizeof(uint32_t)), readback);
+    return pixels != nullptr;
+}
+
+// 呈现当前帧：颜色目标是平台纹理时直接解锁呈现，否则走复制路径
+void presentPlatformFrame(Renderer &renderer)
+{
+    if (renderer.getFrameBuffer().hasExternalColorTarget())
+    {
+        renderer.setColorTarget(nullptr, 0);
+        platform_present_framebuffer(0);
+    }
+    else
+    {
+        copyFrameBufferToPlatform(renderer);
+        platform_update_framebuffer(0);
+    }
+}
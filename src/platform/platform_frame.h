@@ -0,0 +1,12 @@
+#pragma once
+#include "renderer.h"
+
+// 渲染器与平台窗口之间的帧传递，只在带窗口的可执行文件中使用，核心库不依赖平台层
+
+// 将渲染器的帧缓冲区复制到平台帧缓冲区
+void copyFrameBufferToPlatform(const Renderer &renderer);
+
+// 零复制呈现：帧开始时锁定平台纹理作为颜色目标，帧结束时解锁呈现。
+// 锁定的纹理只能写入，readback为true（本帧要截图）时渲染到内部存储，帧结束后才写入纹理
+bool beginPlatformFrame(Renderer &renderer, bool readback = false);
+void presentPlatformFrame(Renderer &renderer);
@@ -0,0 +1,104 @@
+#include "platform.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+// 无窗口平台：没有SDL时（SR_WITH_SDL=OFF）链接此实现，只能以--headless模式运行
+// platform_init总是失败，其余接口为空操作，时间函数使用std::chrono
+
+static char screenshot_filename[256] = "../output/screenshot.ppm";
+
+bool platform_init(const char* title, int width, int height) {
+    (void)title;
+    (void)width;
+    (void)height;
+    fprintf(stderr, "未启用SDL支持，无法创建窗口，请使用--headless模式\n");
+    return false;
+}
+
+void platform_cleanup(void) {}
+
+void platform_set_title(const char* title) {
+    (void)title;
+}
+
+void platform_get_size(int* width, int* height) {
+    if (width) *width = 0;
+    if (height) *height = 0;
+}
+
+bool platform_should_close(void) {
+    return true;
+}
+
+void* platform_get_framebuffer(void) {
+    return NULL;
+}
+
+void platform_update_framebuffer(int slot) {
+    (void)slot;
+}
+
+void* platform_lock_framebuffer(int slot, int width, int height, int* pitch) {
+    (void)slot;
+    (void)width;
+    (void)height;
+    (void)pitch;
+    return NULL;
+}
+
+void platform_present_framebuffer(int slot) {
+    (void)slot;
+}
+
+void platform_process_events(void) {}
+
+bool platform_get_key(int key) {
+    (void)key;
+    return false;
+}
+
+bool platform_get_mouse_button(int button) {
+    (void)button;
+    return false;
+}
+
+void platform_get_mouse_position(int* x, int* y) {
+    if (x) *x = 0;
+    if (y) *y = 0;
+}
+
+void platform_get_mouse_delta(int* dx, int* dy) {
+    if (dx) *dx = 0;
+    if (dy) *dy = 0;
+}
+
+void platform_get_mouse_wheel(float* x, float* y) {
+    if (x) *x = 0.0f;
+    if (y) *y = 0.0f;
+}
+
+bool platform_should_take_screenshot(void) {
+    return false;
+}
+
+void platform_set_screenshot_filename(const char* filename) {
+    if (filename) {
+        strncpy(screenshot_filename, filename, sizeof(screenshot_filename) - 1);
+        screenshot_filename[sizeof(screenshot_filename) - 1] = '\0';
+    }
+}
+
+const char* platform_get_screenshot_filename(void) {
+    return screenshot_filename;
+}
+
+double platform_get_time(void) {
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+void platform_sleep(double seconds) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+}
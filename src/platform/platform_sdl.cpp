@@ -7,10 +7,13 @@
 // SDL 相关变量
 static SDL_Window* window = NULL;
 static SDL_Renderer* renderer = NULL;
-static SDL_Texture* framebuffer_texture = NULL;
+static SDL_Texture* framebuffer_textures[PLATFORM_FRAMEBUFFER_SLOTS] = {NULL};
+static bool framebuffer_locked[PLATFORM_FRAMEBUFFER_SLOTS] = {false};
 static uint32_t* framebuffer = NULL;
 static int window_width = 0;
 static int window_height = 0;
+static int texture_width = 0;  // 纹理为渲染分辨率，窗口缩放时由SDL_RenderCopy拉伸
+static int texture_height = 0;
 static bool should_close = false;
 static uint64_t performance_frequency = 0;
 
@@ -60,27 +63,36 @@ bool platform_init(const char* title, int width, int height) {
         return false;
     }
 
-    // 创建纹理作为帧缓冲
-    framebuffer_texture = SDL_CreateTexture(
-        renderer,
-        SDL_PIXELFORMAT_ARGB8888,
-        SDL_TEXTUREACCESS_STREAMING,
-        width, height
-    );
-    
-    if (!framebuffer_texture) {
-        fprintf(stderr, "纹理创建失败: %s\n", SDL_GetError());
-        SDL_DestroyRenderer(renderer);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return false;
+    // 创建纹理作为帧缓冲（多个纹理轮流使用，呈现一帧的同时渲染下一帧）
+    for (int i = 0; i < PLATFORM_FRAMEBUFFER_SLOTS; ++i) {
+        framebuffer_textures[i] = SDL_CreateTexture(
+            renderer,
+            SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_STREAMING,
+            width, height
+        );
+        
+        if (!framebuffer_textures[i]) {
+            fprintf(stderr, "纹理创建失败: %s\n", SDL_GetError());
+            for (int j = 0; j < i; ++j) {
+                SDL_DestroyTexture(framebuffer_textures[j]);
+                framebuffer_textures[j] = NULL;
+            }
+            SDL_DestroyRenderer(renderer);
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            return false;
+        }
     }
 
     // 分配帧缓冲内存
     framebuffer = (uint32_t*)malloc(width * height * sizeof(uint32_t));
     if (!framebuffer) {
         fprintf(stderr, "帧缓冲内存分配失败\n");
-        SDL_DestroyTexture(framebuffer_texture);
+        for (int i = 0; i < PLATFORM_FRAMEBUFFER_SLOTS; ++i) {
+            SDL_DestroyTexture(framebuffer_textures[i]);
+            framebuffer_textures[i] = NULL;
+        }
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
@@ -93,6 +105,8 @@ bool platform_init(const char* title, int width, int height) {
     // 保存窗口尺寸
     window_width = width;
     window_height = height;
+    texture_width = width;
+    texture_height = height;
     
     // 获取性能计数器频率（用于时间函数）
     performance_frequency = SDL_GetPerformanceFrequency();
@@ -109,9 +123,15 @@ void platform_cleanup(void) {
         framebuffer = NULL;
     }
     
-    if (framebuffer_texture) {
-        SDL_DestroyTexture(framebuffer_texture);
-        framebuffer_texture = NULL;
+    for (int i = 0; i < PLATFORM_FRAMEBUFFER_SLOTS; ++i) {
+        if (framebuffer_textures[i]) {
+            if (framebuffer_locked[i]) {
+                SDL_UnlockTexture(framebuffer_textures[i]);
+                framebuffer_locked[i] = false;
+            }
+            SDL_DestroyTexture(framebuffer_textures[i]);
+            framebuffer_textures[i] = NULL;
+        }
     }
     
     if (renderer) {
@@ -146,29 +166,68 @@ void* platform_get_framebuffer(void) {
     return framebuffer;
 }
 
-void platform_update_framebuffer(void) {
-    if (!renderer || !framebuffer_texture || !framebuffer) {
+void platform_update_framebuffer(int slot) {
+    if (slot < 0 || slot >= PLATFORM_FRAMEBUFFER_SLOTS) {
+        return;
+    }
+    if (!renderer || !framebuffer_textures[slot] || !framebuffer || framebuffer_locked[slot]) {
         return;
     }
     
     // 更新纹理
     SDL_UpdateTexture(
-        framebuffer_texture,
+        framebuffer_textures[slot],
         NULL,
         framebuffer,
-        window_width * sizeof(uint32_t)
+        texture_width * sizeof(uint32_t)
     );
     
     // 清除渲染器
     SDL_RenderClear(renderer);
     
     // 复制纹理到渲染器
-    SDL_RenderCopy(renderer, framebuffer_texture, NULL, NULL);
+    SDL_RenderCopy(renderer, framebuffer_textures[slot], NULL, NULL);
     
     // 呈现
     SDL_RenderPresent(renderer);
 }
 
+void* platform_lock_framebuffer(int slot, int width, int height, int* pitch) {
+    if (slot < 0 || slot >= PLATFORM_FRAMEBUFFER_SLOTS) {
+        return NULL;
+    }
+    if (!renderer || !framebuffer_textures[slot] || framebuffer_locked[slot]) {
+        return NULL;
+    }
+    if (width != texture_width || height != texture_height) {
+        return NULL;
+    }
+
+    void* pixels = NULL;
+    if (SDL_LockTexture(framebuffer_textures[slot], NULL, &pixels, pitch) != 0) {
+        return NULL;
+    }
+    framebuffer_locked[slot] = true;
+    return pixels;
+}
+
+void platform_present_framebuffer(int slot) {
+    if (slot < 0 || slot >= PLATFORM_FRAMEBUFFER_SLOTS) {
+        return;
+    }
+    if (!renderer || !framebuffer_textures[slot] || !framebuffer_locked[slot]) {
+        return;
+    }
+    
+    // 解锁即提交像素，无需SDL_UpdateTexture
+    SDL_UnlockTexture(framebuffer_textures[slot]);
+    framebuffer_locked[slot] = false;
+    
+    SDL_RenderClear(renderer);
+    SDL_RenderCopy(renderer, framebuffer_textures[slot], NULL, NULL);
+    SDL_RenderPresent(renderer);
+}
+
 void platform_process_events(void) {
     // 重置鼠标增量
     mouse_delta_x = 0;
@@ -187,34 +246,10 @@ void platform_process_events(void) {
                 
             case SDL_WINDOWEVENT:
                 if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                    int new_width = event.window.data1;
-                    int new_height = event.window.data2;
-                    
-                    // 重新创建纹理
-                    if (framebuffer_texture) {
-                        SDL_DestroyTexture(framebuffer_texture);
-                    }
-                    
-                    framebuffer_texture = SDL_CreateTexture(
-                        renderer,
-                        SDL_PIXELFORMAT_ARGB8888,
-                        SDL_TEXTUREACCESS_STREAMING,
-                        new_width, new_height
-                    );
-                    
-                    // 重新分配帧缓冲
-                    if (framebuffer) {
-                        free(framebuffer);
-                    }
-                    
-                    framebuffer = (uint32_t*)malloc(new_width * new_height * sizeof(uint32_t));
-                    if (framebuffer) {
-                        memset(framebuffer, 0, new_width * new_height * sizeof(uint32_t));
-                    }
-                    
-                    // 更新尺寸
-                    window_width = new_width;
-                    window_height = new_height;
+                    // 纹理保持渲染分辨率，由SDL_RenderCopy拉伸到窗口；
+                    // 不在此处重建纹理，避免释放渲染线程正在写入的锁定像素
+                    window_width = event.window.data1;
+                    window_height = event.window.data2;
                 }
                 break;
                 
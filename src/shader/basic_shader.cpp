@@ -4,15 +4,15 @@
 float4 BasicShader::vertexShader(const VertexAttributes &attributes, Varyings &output)
 {
     // 将顶点变换到世界空间（用于片元着色器）
-    output.position = transformNoDiv(uniforms.modelMatrix, attributes.position);
+    output.position = transformNoDiv(uniforms->modelMatrix, attributes.position);
 
     // 传递法线和纹理坐标
-    output.normal = transformNormal(uniforms.modelMatrix, attributes.normal);
+    output.normal = transformNormal(uniforms->normalMatrix, attributes.normal);
     output.texCoord = attributes.texCoord;
     output.color = attributes.color;
 
     // 变换到裁剪空间，然后到NDC空间
-    float4 clipPos = uniforms.mvpMatrix * float4(attributes.position,1.0f);
+    float4 clipPos = uniforms->mvpMatrix * float4(attributes.position,1.0f);
 
     // 将z保存用于深度测试
     output.depth = clipPos.z/clipPos.w;
@@ -3,58 +3,162 @@
 #include <algorithm>
 #include <cmath>
 
+// 阴影查找使用3x3双线性PCF
+static const SamplerComparisonState &SHADOW_SAMPLER = SamplerComparisonState::SHADOW_PCF_3X3;
+
 // 实现阴影计算函数
-float PhongShader::calculateShadow(const float4& positionLightSpace, const float NoL) const
+float PhongShader::calculateShadow(const float3 &positionWS, const float NoL) const
 {
-    auto shadowMap = uniforms.textures.find(_ShadowMap)->second;
-    if (!uniforms.useShadowMap || !shadowMap) {
+    const Texture *shadowMap = uniforms->getTexture(TextureSlot::SHADOW_MAP);
+    if (!uniforms->useShadowMap || !shadowMap) {
         return 1.0f; // 无阴影，完全亮
     }
-    
-    // 执行透视除法
-    float3 projCoords = positionLightSpace.xyz()/positionLightSpace.w;
-    
-    // 变换到[0,1]范围
-    projCoords = float3(
-        (projCoords.x + 1.0f) * 0.5f,
-        (projCoords.y + 1.0f) * 0.5f,
-        (projCoords.z)
-    );
-    
-    // 获取最近深度值
-    float closestDepth = shadowMap->sample(projCoords.xy(),SamplerState::LINEAR_CLAMP).x;
-    
-    // 获取当前片段在光源视角下的深度
-    float currentDepth = projCoords.z;
-    
-    // 方案1: 固定z-offset bias
-    // const float constantBias = 0.005f;
-    
-    // 方案2: 根据法线和光照方向动态调整bias
-    float cosAngle = std::max(NoL, 0.0f);
-    float dynamicBias = std::max(0.005f * (1.0f - cosAngle), 0.005f);
-    
-    // 选择使用哪种bias (这里使用动态bias作为示例)
-    float bias = dynamicBias;
-    
-    // 执行深度比较
-    return (currentDepth - bias > closestDepth) ? 0.5f : 1.0f;
+    if (uniforms->shadowCascadeCount > 0) {
+        return calculateCascadeShadow(shadowMap, positionWS, NoL);
+    }
+    if (uniforms->pointShadow.faceSize > 0) {
+        return calculatePointShadow(shadowMap, positionWS, NoL);
+    }
+    return 1.0f;
+}
+
+// 方向光的级联阴影
+float PhongShader::calculateCascadeShadow(const Texture *shadowMap, const float3 &positionWS, const float NoL) const
+{
+    // 按相机视空间深度选择级联，超出最后一级的范围不计算阴影
+    const float viewDepth = -transformNoDiv(uniforms->viewMatrix, positionWS).z;
+    int cascadeIndex = 0;
+    while (cascadeIndex < uniforms->shadowCascadeCount &&
+           viewDepth > uniforms->shadowCascades[cascadeIndex].splitDepth) {
+        ++cascadeIndex;
+    }
+    if (cascadeIndex >= uniforms->shadowCascadeCount) {
+        return 1.0f;
+    }
+    const ShadowCascade &cascade = uniforms->shadowCascades[cascadeIndex];
+
+    // 变换到级联的光源NDC空间（正交投影，无需透视除法）
+    const float3 projCoords = transformNoDiv(cascade.viewProjMatrix, positionWS);
+    if (projCoords.x < -1.0f || projCoords.x > 1.0f || projCoords.y < -1.0f || projCoords.y > 1.0f) {
+        return 1.0f;
+    }
+
+    // 变换到纹理坐标：阴影贴图第0行对应NDC的y=+1，级联在v方向上纵向排列
+    const float invCount = 1.0f / uniforms->shadowCascadeCount;
+    float v = (1.0f - projCoords.y) * 0.5f;
+    v = (cascadeIndex + v) * invCount;
+    // 限制在本级联内，避免PCF足迹跨越相邻级联
+    const float kernelMarginV = (SHADOW_SAMPLER.getKernelSize() / 2 + 1.0f) / shadowMap->getHeight();
+    v = std::clamp(v, cascadeIndex * invCount + kernelMarginV, (cascadeIndex + 1) * invCount - kernelMarginV);
+    const float2 uv((projCoords.x + 1.0f) * 0.5f, v);
+
+    // 根据法线和光照方向的夹角调整bias：以纹素的世界尺寸为单位，掠射角时增大
+    float cosAngle = std::clamp(NoL, 0.05f, 1.0f);
+    float tanAngle = std::min(std::sqrt(1.0f - cosAngle * cosAngle) / cosAngle, 8.0f);
+    float bias = cascade.texelSize * (1.0f + tanAngle) * cascade.depthScale;
+
+    // 比较采样：片段深度（减去bias）不大于遮挡物深度时受光，PCF结果为受光比例
+    const float lit = shadowMap->sampleCmp(uv, projCoords.z - bias, SHADOW_SAMPLER);
+    return 0.5f + 0.5f * lit;
 }
 
+// 点光源的立方体阴影
+float PhongShader::calculatePointShadow(const Texture *shadowMap, const float3 &positionWS, const float NoL) const
+{
+    const PointShadow &pointShadow = uniforms->pointShadow;
+
+    // 按相对光源位置的主轴选择立方体面，主轴坐标即该面的视空间深度
+    const float3 rel = positionWS - pointShadow.position;
+    const float ax = std::abs(rel.x), ay = std::abs(rel.y), az = std::abs(rel.z);
+    int face;
+    float depth;
+    if (ax >= ay && ax >= az) {
+        face = rel.x >= 0.0f ? 0 : 1;
+        depth = ax;
+    } else if (ay >= az) {
+        face = rel.y >= 0.0f ? 2 : 3;
+        depth = ay;
+    } else {
+        face = rel.z >= 0.0f ? 4 : 5;
+        depth = az;
+    }
+    if (depth <= pointShadow.nearPlane || depth >= pointShadow.farPlane) {
+        return 1.0f;
+    }
+
+    // 变换到该面的NDC空间
+    const float4 clip = pointShadow.faceViewProjMatrices[face] * float4(positionWS, 1.0f);
+    const float3 ndc = clip.xyz() / clip.w;
+
+    // 六个面在v方向上纵向排列，限制在本面内
+    const float faceV = 1.0f / 6.0f;
+    const float kernelMarginV = (SHADOW_SAMPLER.getKernelSize() / 2 + 1.0f) / shadowMap->getHeight();
+    float v = (face + (1.0f - ndc.y) * 0.5f) * faceV;
+    v = std::clamp(v, face * faceV + kernelMarginV, (face + 1) * faceV - kernelMarginV);
+    const float2 uv((ndc.x + 1.0f) * 0.5f, v);
+
+    // bias先按纹素的世界尺寸（90°视场，深度d处面宽为2d）计算，再换算到透视NDC深度
+    const float cosAngle = std::clamp(NoL, 0.05f, 1.0f);
+    const float tanAngle = std::min(std::sqrt(1.0f - cosAngle * cosAngle) / cosAngle, 8.0f);
+    const float texelSize = 2.0f * depth / pointShadow.faceSize;
+    const float n = pointShadow.nearPlane, f = pointShadow.farPlane;
+    const float ndcPerUnit = 2.0f * f * n / ((f - n) * depth * depth);
+    const float bias = texelSize * (1.0f + tanAngle) * ndcPerUnit;
+
+    const float lit = shadowMap->sampleCmp(uv, ndc.z - bias, SHADOW_SAMPLER);
+    return 0.5f + 0.5f * lit;
+}
+
+// 局部点光源：只遍历片元所在tile中剔除后留下的光源
+float3 PhongShader::calculateTileLights(const Varyings &input, const float3 &normal, const float3 &viewDir,
+                                        const float3 &basecolor) const
+{
+    const LightGrid &lightGrid = *uniforms->lightGrid;
+    const LightGrid::TileLights tile = lightGrid.getTileLights(input.fragCoord.x, input.fragCoord.y);
+
+    float3 result(0.0f, 0.0f, 0.0f);
+    for (uint32_t i = 0; i < tile.count; ++i)
+    {
+        const PointLight &light = lightGrid.getLight(tile.indices[i]);
+        const float3 toLight = light.position - input.position;
+        const float distanceSq = dot(toLight, toLight);
+        const float rangeSq = light.range * light.range;
+        if (distanceSq >= rangeSq) {
+            continue;
+        }
+
+        const float3 lightDir = toLight / std::sqrt(distanceSq);
+        const float NoL = dot(normal, lightDir);
+        if (NoL <= 0.0f) {
+            continue;
+        }
+
+        // 平方反比衰减，乘以窗口函数使其在range处平滑衰减到0
+        const float ratio = distanceSq / rangeSq;
+        const float window = (1.0f - ratio * ratio) * (1.0f - ratio * ratio);
+        const float attenuation = window / (distanceSq + 1.0f);
+
+        const float NoH = dot(normal, normalize(lightDir + viewDir));
+        const float spec = std::pow(std::max(NoH, 0.0f), uniforms->surface.shininess);
+        const float3 radiance = light.color * (light.intensity * attenuation);
+        result += (basecolor * NoL + uniforms->surface.specular * spec) * radiance;
+    }
+    return result;
+}
 
 float4 PhongShader::vertexShader(const VertexAttributes &attributes, Varyings &output)
 {
     // 变换顶点位置到裁剪空间
-    float4 positionClip = uniforms.mvpMatrix * float4(attributes.position,1.0f);
+    float4 positionClip = uniforms->mvpMatrix * float4(attributes.position,1.0f);
     
     // 变换顶点位置到世界空间（用于光照计算）
-    output.position = transform(uniforms.modelMatrix, attributes.position);
+    output.position = transformNoDiv(uniforms->modelMatrix, attributes.position);
     
-    // 变换法线到世界空间并归一化
-    output.normal = normalize(transformNormal(uniforms.modelMatrix, attributes.normal));
+    // 使用预计算的法线矩阵变换法线到世界空间（transformNormal已归一化）
+    output.normal = transformNormal(uniforms->normalMatrix, attributes.normal);
     
     // 变换切线到世界空间并归一化
-    float3 tangentWS = normalize(transformDir(uniforms.modelMatrix, float3(attributes.tangent.x, attributes.tangent.y, attributes.tangent.z)));
+    float3 tangentWS = normalize(transformDir(uniforms->modelMatrix, float3(attributes.tangent.x, attributes.tangent.y, attributes.tangent.z)));
     output.tangent = float4(tangentWS.x, tangentWS.y, tangentWS.z, attributes.tangent.w);
     
     // 传递纹理坐标和颜色
@@ -64,12 +168,6 @@ float4 PhongShader::vertexShader(const VertexAttributes &attributes, Varyings &o
     // 存储深度用于深度测试
     output.depth = positionClip.z/positionClip.w;
     
-    // 如果启用了阴影映射，计算顶点在光源空间的位置
-    if (uniforms.useShadowMap) {
-        output.positionLightSpace = uniforms.lightSpaceMatrix * Vec4f(output.position.x, output.position.y, output.position.z, 1.0f);
-        // output.positionLightSpace = uniforms.lightSpaceMatrix.transform(Vec4f(output.position,1.0f));
-    }
-    
     return positionClip;
 }
 
@@ -78,12 +176,12 @@ FragmentOutput PhongShader::fragmentShader(const Varyings &input)
     FragmentOutput output;
     
     float3 normal = normalize(input.normal);
-    float3 lightDir = normalize(uniforms.light.position - input.position);
-    float3 viewDir = normalize(uniforms.eyePosition - input.position);
+    float3 lightDir = normalize(uniforms->light.position - input.position);
+    float3 viewDir = normalize(uniforms->eyePosition - input.position);
     float3 halfwayDir = normalize(lightDir + viewDir);
     
        // 如果有法线贴图，使用法线贴图计算法线
-       auto normalMap = uniforms.textures.find(_NormalMap)->second;
+       const Texture *normalMap = uniforms->getTexture(TextureSlot::NORMAL_MAP);
        if (normalMap) {
         // printf("normalMap is not null\n");
         // 从法线贴图中获取切线空间法线
@@ -114,39 +212,42 @@ FragmentOutput PhongShader::fragmentShader(const Varyings &input)
     float NoH = dot(normal, halfwayDir);
 
     // 计算环境光分量
-    float3 ambient = uniforms.surface.ambient * uniforms.light.color * uniforms.light.ambientIntensity;
+    float3 ambient = uniforms->surface.ambient * uniforms->light.color * uniforms->light.ambientIntensity;
     
     // 计算漫反射分量
-    // float3 basecolor = uniforms.surface.diffuse;
-    float3 basecolor =srgbToLinear( uniforms.surface.diffuse);
+    // float3 basecolor = uniforms->surface.diffuse;
+    float3 basecolor =srgbToLinear( uniforms->surface.diffuse);
     float diff = std::max(NoL, 0.0f);
-    auto colorMap = uniforms.textures.find(_ColorMap)->second;
+    const Texture *colorMap = uniforms->getTexture(TextureSlot::COLOR_MAP);
     if (colorMap)
     {
         basecolor = colorMap->sample(input.texCoord, SamplerState::LINEAR_REPEAT).xyz();
         // 如果纹理是 sRGB 格式，转换到线性空间
         basecolor = srgbToLinear(basecolor);
     }
-    // float3 basecolor = sampleTexture(_ColorMap,SamplerState::LINEAR_REPEAT, input.texCoord).xyz();
+    // float3 basecolor = sampleTexture(TextureSlot::COLOR_MAP,SamplerState::LINEAR_REPEAT, input.texCoord).xyz();
     // 计算漫反射分量
     float3 diffuse;
-    diffuse = basecolor * uniforms.light.color * (diff * uniforms.light.intensity);
+    diffuse = basecolor * uniforms->light.color * (diff * uniforms->light.intensity);
 
 
     // 计算镜面反射分量
     // Blinn-Phong 镜面反射模型
     // 使用半角向量和法线的点积计算反射强度
-    float spec = std::pow(std::max(NoH, 0.0f), uniforms.surface.shininess);
-    float3 specular = uniforms.surface.specular * uniforms.light.color * spec * uniforms.light.intensity;
+    float spec = std::pow(std::max(NoH, 0.0f), uniforms->surface.shininess);
+    float3 specular = uniforms->surface.specular * uniforms->light.color * spec * uniforms->light.intensity;
     
     // 计算阴影因子
     float shadow = 1.0f;
-    if (uniforms.useShadowMap) {
-        shadow = calculateShadow(input.positionLightSpace,NoL);
+    if (uniforms->useShadowMap) {
+        shadow = calculateShadow(input.position, NoL);
     }
     
     // 合并所有光照分量
     float3 result = ambient + (diffuse + specular) * shadow  ;
+    if (uniforms->lightGrid) {
+        result += calculateTileLights(input, normal, viewDir, basecolor);
+    }
     
     // 确保结果在 [0,1] 范围内
     result.x = std::min(result.x, 1.0f);
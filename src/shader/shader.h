@@ -2,10 +2,20 @@
 #pragma once
 
 #include <memory>
+#include <array>
 #include "maths.h"
 #include "texture.h" // 使用新的纹理库
 #include "common.h"
-#include <memory>
+#include "light_grid.h"
+
+// 纹理槽位：每次绘制前解析一次，片元着色器按槽位直接访问，不再做字符串查找
+enum class TextureSlot : uint8_t
+{
+    COLOR_MAP = 0, // 漫反射贴图
+    NORMAL_MAP,    // 法线贴图
+    SHADOW_MAP,    // 阴影贴图
+    COUNT
+};
 
 // 着色器输入/输出结构体
 struct ShaderUniforms
@@ -14,20 +24,29 @@ struct ShaderUniforms
     Matrix4x4f viewMatrix;  // 视图矩阵
     Matrix4x4f projMatrix;  // 投影矩阵
     Matrix4x4f mvpMatrix;   // 组合的MVP矩阵
+    Matrix4x4f normalMatrix; // 法线矩阵（模型矩阵的逆转置）
     float3 eyePosition;     // 相机位置（世界空间）
     Light light;            // 光源信息
     Surface surface;        // 材质信息
     // 阴影相关
     bool useShadowMap = false;   // 是否使用阴影贴图
     Matrix4x4f lightSpaceMatrix; // 光源空间变换矩阵（视图*投影）
-
-    std::unordered_map<std::string, std::shared_ptr<Texture>> textures;
+    Matrix4x4f lightMVPMatrix;   // 光源空间矩阵*模型矩阵
+    // 级联阴影：阴影贴图按级联纵向排列，第i级占据[i/count, (i+1)/count)的v范围
+    int shadowCascadeCount = 0;
+    std::array<ShadowCascade, MAX_SHADOW_CASCADES> shadowCascades{};
+    // 点光源立方体阴影（shadowCascadeCount为0且faceSize大于0时使用）
+    PointShadow pointShadow;
+    // 分块剔除后的局部点光源（不持有所有权，由场景持有），nullptr表示没有局部光源
+    const LightGrid *lightGrid = nullptr;
+
+    // 纹理绑定表（不持有所有权，纹理由资源管理器持有），未绑定的槽位为nullptr
+    std::array<const Texture *, static_cast<size_t>(TextureSlot::COUNT)> textures{};
+
+    const Texture *getTexture(TextureSlot slot) const { return textures[static_cast<size_t>(slot)]; }
+    void setTexture(TextureSlot slot, const Texture *texture) { textures[static_cast<size_t>(slot)] = texture; }
 };
 
-static constexpr const char *_ShadowMap = "shadowmap";
-static constexpr const char *_ColorMap = "colormap";
-static constexpr const char *_NormalMap = "normalmap";
-
 // sRGB 转换为线性颜色空间
 inline float4 srgbToLinear(const float4 &color)
 {
@@ -83,6 +102,7 @@ struct Varyings
     Vec2f texCoord;  // 插值后的纹理坐标
     float4 color;    // 插值后的颜色(改为float4)
     float depth;     // 深度值（用于深度测试）
+    Vec2f fragCoord; // 片元的屏幕坐标（像素中心或MSAA采样点），由光栅化阶段写入
 
     // 阴影映射相关
     float4 positionLightSpace; // 光源空间的位置（用于阴影映射）
@@ -102,16 +122,28 @@ struct FragmentOutput
 class IShader : public IResource
 {
 protected:
-    ShaderUniforms uniforms;
+    // 绑定的uniform块（不复制，由调用方持有并在绘制期间保持有效）
+    const ShaderUniforms *uniforms;
 
 public:
-    IShader() : IResource(ResourceType::SHADER) {}
+    IShader() : IResource(ResourceType::SHADER), uniforms(&defaultUniforms()) {}
     virtual ~IShader() = default;
 
-    // 设置着色器的uniform变量
+    // 绑定着色器的uniform变量块
     virtual void setUniforms(const ShaderUniforms &uniforms)
     {
-        this->uniforms = uniforms;
+        this->uniforms = &uniforms;
+    }
+
+    // 复制着色器实例（uniform绑定一并复制）。帧流水线中每个帧上下文使用自己的实例，
+    // 避免上一帧着色时重新绑定uniform与下一帧的顶点着色冲突；返回nullptr时两帧退化为串行
+    virtual std::shared_ptr<IShader> clone() const { return nullptr; }
+
+    // 未绑定时使用的默认uniform块
+    static const ShaderUniforms &defaultUniforms()
+    {
+        static const ShaderUniforms defaults;
+        return defaults;
     }
 
     // 顶点着色器
@@ -125,12 +157,11 @@ public:
     virtual FragmentOutput fragmentShader(const Varyings &input) = 0;
 
     // 核心方法：安全地采样纹理
-    float4 sampleTexture(const std::string &name, const SamplerState &samplerstate, const float2 &uv) const
+    float4 sampleTexture(TextureSlot slot, const SamplerState &samplerstate, const float2 &uv) const
     {
-        auto it = uniforms.textures.find(name);
-        if (it != uniforms.textures.end() && it->second)
+        if (const Texture *texture = uniforms->getTexture(slot))
         {
-            return it->second->sample(uv, samplerstate);
+            return texture->sample(uv, samplerstate);
         }
         // 纹理不存在或为空，返回错误颜色（紫色）
         return float4(1.0f, 0.0f, 1.0f, 1.0f);
@@ -143,6 +174,7 @@ class BasicShader : public IShader
 public:
     virtual float4 vertexShader(const VertexAttributes &attributes, Varyings &output) override;
     virtual FragmentOutput fragmentShader(const Varyings &input) override;
+    virtual std::shared_ptr<IShader> clone() const override { return std::make_shared<BasicShader>(*this); }
 };
 
 // 带Phong光照模型的着色器
@@ -151,10 +183,16 @@ class PhongShader : public IShader
 public:
     virtual float4 vertexShader(const VertexAttributes &attributes, Varyings &output) override;
     virtual FragmentOutput fragmentShader(const Varyings &input) override;
+    virtual std::shared_ptr<IShader> clone() const override { return std::make_shared<PhongShader>(*this); }
 
 protected:
-    // 计算阴影因子
-    float calculateShadow(const float4 &positionLightSpace,const float NoL) const;
+    // 计算阴影因子：按uniform中的阴影类型分派
+    float calculateShadow(const float3 &positionWS, const float NoL) const;
+    float calculateCascadeShadow(const Texture *shadowMap, const float3 &positionWS, const float NoL) const;
+    float calculatePointShadow(const Texture *shadowMap, const float3 &positionWS, const float NoL) const;
+    // 累加片元所在tile的局部点光源的漫反射和高光
+    float3 calculateTileLights(const Varyings &input, const float3 &normal, const float3 &viewDir,
+                               const float3 &basecolor) const;
 };
 
 // 自定义着色器示例：卡通渲染着色器
@@ -166,6 +204,7 @@ protected:
 public:
     virtual float4 vertexShader(const VertexAttributes &attributes, Varyings &output) override;
     virtual FragmentOutput fragmentShader(const Varyings &input) override;
+    virtual std::shared_ptr<IShader> clone() const override { return std::make_shared<ToonShader>(*this); }
 };
 
 // 阴影贴图生成着色器
@@ -174,6 +213,7 @@ class ShadowMapShader : public IShader
 public:
     virtual float4 vertexShader(const VertexAttributes &attributes, Varyings &output) override;
     virtual FragmentOutput fragmentShader(const Varyings &input) override;
+    virtual std::shared_ptr<IShader> clone() const override { return std::make_shared<ShadowMapShader>(*this); }
 };
 
 // 创建着色器的工厂函数
@@ -6,7 +6,7 @@
 float4 ShadowMapShader::vertexShader(const VertexAttributes &attributes, Varyings &output)
 {
     // 只需要将顶点变换到光源空间
-    float4 positionClip = uniforms.lightSpaceMatrix * uniforms.modelMatrix *float4(attributes.position,1.0f);
+    float4 positionClip = uniforms->lightMVPMatrix * float4(attributes.position,1.0f);
 
     // 保存深度值
     output.depth = positionClip.z/positionClip.w;
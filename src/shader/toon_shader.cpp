@@ -3,15 +3,15 @@
 float4 ToonShader::vertexShader(const VertexAttributes &attributes, Varyings &output)
 {
     // 将顶点变换到世界空间（用于片元着色器）
-    output.position = transformNoDiv(uniforms.modelMatrix, attributes.position);
+    output.position = transformNoDiv(uniforms->modelMatrix, attributes.position);
 
     // 传递法线和纹理坐标
-    output.normal = transformNormal(uniforms.modelMatrix, attributes.normal);
+    output.normal = transformNormal(uniforms->normalMatrix, attributes.normal);
     output.texCoord = attributes.texCoord;
     output.color = attributes.color;
 
     // 变换到裁剪空间，然后到NDC空间
-    float4 clipPos = uniforms.mvpMatrix * float4( attributes.position,1.0f);
+    float4 clipPos = uniforms->mvpMatrix * float4( attributes.position,1.0f);
 
     // 将z保存用于深度测试
     output.depth = clipPos.z/clipPos.w;
@@ -27,10 +27,10 @@ FragmentOutput ToonShader::fragmentShader(const Varyings &input)
     float3 normal = normalize(input.normal);
 
     // 计算从顶点到光源的方向向量
-    float3 lightDir = normalize(uniforms.light.position - input.position);
+    float3 lightDir = normalize(uniforms->light.position - input.position);
 
     // 计算从顶点到观察者的方向向量
-    float3 viewDir = normalize(uniforms.eyePosition - input.position);
+    float3 viewDir = normalize(uniforms->eyePosition - input.position);
 
     // 计算漫反射强度
     float diffuse = std::max(dot(normal, lightDir), 0.0f);
@@ -0,0 +1,176 @@
+#include "perf_counters.h"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace
+{
+#ifdef __linux__
+    struct CounterConfig {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    constexpr CounterConfig COUNTER_CONFIGS[HardwareCounters::COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}, // 通常映射到最后一级缓存缺失
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    constexpr uint64_t READ_FORMAT =
+        PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int openCounter(const CounterConfig &counter, int groupFd)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = counter.type;
+        attr.config = counter.config;
+        attr.read_format = READ_FORMAT;
+        attr.disabled = groupFd < 0 ? 1 : 0; // 组长先禁用，整组打开后一起启用
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // pid = 0, cpu = -1：只统计调用线程，跟随它在任意核心上运行
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+    }
+#endif
+}
+
+HardwareCounters::HardwareCounters()
+{
+    for (int &fd : fds)
+    {
+        fd = -1;
+    }
+#ifdef __linux__
+    leaderFd = openCounter(COUNTER_CONFIGS[CYCLES], -1);
+    if (leaderFd < 0)
+    {
+        error = std::string("perf_event_open失败: ") + std::strerror(errno);
+        if (errno == EACCES || errno == EPERM)
+        {
+            error += "（检查/proc/sys/kernel/perf_event_paranoid）";
+        }
+        return;
+    }
+    fds[CYCLES] = leaderFd;
+    for (int i = CYCLES + 1; i < COUNT; ++i)
+    {
+        fds[i] = openCounter(COUNTER_CONFIGS[i], leaderFd);
+    }
+    for (int i = 0; i < COUNT; ++i)
+    {
+        if (fds[i] >= 0 && ioctl(fds[i], PERF_EVENT_IOC_ID, &ids[i]) == 0)
+        {
+            validMask |= 1u << i;
+        }
+    }
+    ioctl(leaderFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leaderFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    error = "硬件计数器仅支持Linux";
+#endif
+}
+
+HardwareCounters::~HardwareCounters()
+{
+#ifdef __linux__
+    // 先关闭组员再关闭组长
+    for (int i = COUNT - 1; i >= 0; --i)
+    {
+        if (fds[i] >= 0)
+        {
+            close(fds[i]);
+        }
+    }
+#endif
+}
+
+bool HardwareCounters::read(Reading &reading) const
+{
+    for (uint64_t &value : reading.values)
+    {
+        value = 0;
+    }
+    reading.timeEnabled = 0;
+    reading.timeRunning = 0;
+#ifdef __linux__
+    if (leaderFd < 0)
+    {
+        return false;
+    }
+
+    // PERF_FORMAT_GROUP布局：nr, time_enabled, time_running, {value, id} * nr
+    uint64_t buffer[3 + 2 * COUNT];
+    const ssize_t bytes = ::read(leaderFd, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t)))
+    {
+        return false;
+    }
+    const uint64_t count = buffer[0];
+    reading.timeEnabled = buffer[1];
+    reading.timeRunning = buffer[2];
+    for (uint64_t n = 0; n < count && n < COUNT; ++n)
+    {
+        const uint64_t value = buffer[3 + 2 * n];
+        const uint64_t id = buffer[4 + 2 * n];
+        for (int i = 0; i < COUNT; ++i)
+        {
+            if ((validMask & (1u << i)) && ids[i] == id)
+            {
+                reading.values[i] = value;
+                break;
+            }
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool HardwareCounters::delta(const Reading &start, const Reading &end, uint64_t (&values)[COUNT])
+{
+    for (uint64_t &value : values)
+    {
+        value = 0;
+    }
+    const uint64_t timeEnabled = end.timeEnabled - start.timeEnabled;
+    const uint64_t timeRunning = end.timeRunning - start.timeRunning;
+    if (end.timeRunning <= start.timeRunning)
+    {
+        return false; // 这段时间内组从未被调度（PMU被其他组占满）
+    }
+    const double scale = static_cast<double>(timeEnabled) / static_cast<double>(timeRunning);
+    for (int i = 0; i < COUNT; ++i)
+    {
+        // 原始累计值单调递增，防御性地把回退视为0
+        const uint64_t value = end.values[i] > start.values[i] ? end.values[i] - start.values[i] : 0;
+        values[i] = timeRunning < timeEnabled ? static_cast<uint64_t>(value * scale) : value;
+    }
+    return true;
+}
+
+const char* HardwareCounters::getName(int counter)
+{
+    switch (counter)
+    {
+    case CYCLES:
+        return "cycles";
+    case INSTRUCTIONS:
+        return "instructions";
+    case LLC_MISSES:
+        return "llc_misses";
+    case BRANCH_MISSES:
+        return "branch_misses";
+    default:
+        return "unknown";
+    }
+}
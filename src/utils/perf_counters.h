@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * 当前线程的硬件性能计数器（Linux perf_event_open）
+ *
+ * 以CPU周期为组长打开一组计数器，只统计用户态，组内计数器同时调度，读数可以直接相减。
+ * 计数器只对打开它的线程计数，因此每个线程需要各自的实例（由Profiler按线程创建）。
+ * 不支持的平台、perf_event_paranoid禁止访问或虚拟机没有PMU时isAvailable()返回false，
+ * 单个事件不受支持时对应位不在getValidMask()中，其余计数器仍然可用。
+ */
+class HardwareCounters {
+public:
+    enum Counter {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        COUNT
+    };
+
+    // 一次读数：各计数器的原始累计值，以及组的启用和实际运行时间
+    struct Reading {
+        uint64_t values[COUNT];
+        uint64_t timeEnabled;
+        uint64_t timeRunning;
+    };
+
+    HardwareCounters();
+    ~HardwareCounters();
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    bool isAvailable() const { return leaderFd >= 0; }
+    // 可用计数器的位掩码（1 << Counter）
+    uint32_t getValidMask() const { return validMask; }
+    // 不可用时的原因
+    const std::string& getError() const { return error; }
+
+    // 读取当前原始累计值，不可用的计数器读为0
+    bool read(Reading& reading) const;
+    // 两次读数之间的增量。被内核分时复用时按这段时间内的启用/运行时间之比放大增量
+    // （分别放大两次累计值再相减可能得到负数）；这段时间内组从未被调度时返回false
+    static bool delta(const Reading& start, const Reading& end, uint64_t (&values)[COUNT]);
+
+    static const char* getName(int counter);
+
+private:
+    int fds[COUNT];
+    uint64_t ids[COUNT] = {};
+    int leaderFd = -1;
+    uint32_t validMask = 0;
+    std::string error;
+};
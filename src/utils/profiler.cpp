@@ -0,0 +1,395 @@
+#include "profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+
+namespace
+{
+    // 换算比例至少在这么长的时间窗口上测量
+    constexpr auto MIN_CALIBRATION_TIME = std::chrono::milliseconds(20);
+
+    // 当前线程的名称，注册前设置时暂存在这里
+    thread_local std::string pendingThreadName;
+
+    void writeJsonString(std::ostream& out, const char* text)
+    {
+        out << '"';
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                out << '\\';
+            }
+            out << *c;
+        }
+        out << '"';
+    }
+}
+
+Profiler::Profiler()
+    : calibrationTicks(timestamp()), calibrationTime(std::chrono::steady_clock::now())
+{
+}
+
+Profiler::ThreadBuffer* Profiler::registerThread()
+{
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->threadName = pendingThreadName;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->threadId = nextThreadId++;
+    if (buffer->threadName.empty())
+    {
+        buffer->threadName = "thread " + std::to_string(buffer->threadId);
+    }
+    buffers.push_back(std::move(buffer));
+    return buffers.back().get();
+}
+
+void Profiler::allocateEvents(ThreadBuffer& buffer)
+{
+    // 不做零初始化：只有writeIndex之前写入过的事件才会被读取，未触及的页面不占用内存
+    // 导出线程通过writeIndex的release/acquire看到这次分配
+    buffer.events.reset(new ProfileEvent[RING_CAPACITY]);
+}
+
+void Profiler::retireThread(ThreadBuffer* buffer)
+{
+    buffer->counters.reset();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const bool pending =
+        buffer->writeIndex.load(std::memory_order_relaxed) != buffer->resetIndex.load(std::memory_order_relaxed) ||
+        buffer->sampleWriteIndex.load(std::memory_order_relaxed) !=
+            buffer->sampleResetIndex.load(std::memory_order_relaxed);
+    if (pending)
+    {
+        buffer->retired = true;
+        return;
+    }
+    buffers.erase(std::find_if(buffers.begin(), buffers.end(),
+                               [buffer](const std::unique_ptr<ThreadBuffer>& entry) { return entry.get() == buffer; }));
+}
+
+bool Profiler::enableHardwareCounters(bool enable)
+{
+    countersEnabled.store(enable, std::memory_order_relaxed);
+    return enable && threadCounters() != nullptr;
+}
+
+void Profiler::openThreadCounters(ThreadBuffer& buffer)
+{
+    buffer.countersOpened = true;
+    auto counters = std::make_unique<HardwareCounters>();
+    if (!counters->isAvailable())
+    {
+        // 每个线程失败的原因相同，只提示一次
+        if (!counterErrorReported.exchange(true))
+        {
+            std::cerr << "硬件计数器不可用，仅记录时间：" << counters->getError() << std::endl;
+        }
+        return;
+    }
+    // 事件缓冲区先于计数器就绪，导出时通过sampleWriteIndex的release/acquire看到它
+    buffer.samples = std::make_unique<CounterSample[]>(COUNTER_RING_CAPACITY);
+    buffer.counters = std::move(counters);
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+    // 尚未注册的线程只暂存名称，首次记录时才注册（未启用分析时工作线程不分配缓冲区）
+    pendingThreadName = name;
+    ThreadBuffer* buffer = threadHandle().buffer;
+    if (!buffer) return;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->threadName = name;
+}
+
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    // 已退出线程的事件随reset一起丢弃，缓冲区不再需要
+    std::erase_if(buffers, [](const std::unique_ptr<ThreadBuffer>& buffer) { return buffer->retired; });
+    for (const auto& buffer : buffers)
+    {
+        buffer->resetIndex.store(buffer->writeIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+        buffer->sampleResetIndex.store(buffer->sampleWriteIndex.load(std::memory_order_acquire),
+                                       std::memory_order_relaxed);
+    }
+}
+
+void Profiler::collectEvents(const ThreadBuffer& buffer, std::vector<ProfileEvent>& out) const
+{
+    const uint64_t end = buffer.writeIndex.load(std::memory_order_acquire);
+    uint64_t begin = buffer.resetIndex.load(std::memory_order_relaxed);
+    if (end - begin > RING_CAPACITY)
+    {
+        begin = end - RING_CAPACITY; // 更早的事件已被覆盖
+    }
+    for (uint64_t i = begin; i < end; ++i)
+    {
+        out.push_back(buffer.events[i & (RING_CAPACITY - 1)]);
+    }
+}
+
+void Profiler::collectSamples(const ThreadBuffer& buffer, std::vector<CounterSample>& out) const
+{
+    const uint64_t end = buffer.sampleWriteIndex.load(std::memory_order_acquire);
+    uint64_t begin = buffer.sampleResetIndex.load(std::memory_order_relaxed);
+    if (end - begin > COUNTER_RING_CAPACITY)
+    {
+        begin = end - COUNTER_RING_CAPACITY;
+    }
+    for (uint64_t i = begin; i < end; ++i)
+    {
+        out.push_back(buffer.samples[i & (COUNTER_RING_CAPACITY - 1)]);
+    }
+}
+
+double Profiler::ticksPerMicrosecond() const
+{
+#ifdef SR_PROFILER_USE_TSC
+    // 与构造时的时间戳比较；间隔太短时先等待，保证换算精度
+    auto now = std::chrono::steady_clock::now();
+    if (now - calibrationTime < MIN_CALIBRATION_TIME)
+    {
+        std::this_thread::sleep_for(MIN_CALIBRATION_TIME - (now - calibrationTime));
+    }
+    const uint64_t ticks = timestamp();
+    now = std::chrono::steady_clock::now();
+    const double microseconds = std::chrono::duration<double, std::micro>(now - calibrationTime).count();
+    return static_cast<double>(ticks - calibrationTicks) / microseconds;
+#else
+    return 1000.0; // 纳秒
+#endif
+}
+
+void Profiler::printReport() const
+{
+    struct Aggregate {
+        uint64_t callCount = 0;
+        uint64_t totalTicks = 0;
+        uint64_t minTicks = UINT64_MAX;
+        uint64_t maxTicks = 0;
+    };
+
+    struct CounterAggregate {
+        std::string unitName;
+        uint64_t callCount = 0;
+        uint64_t totalTicks = 0;
+        uint64_t workUnits = 0;
+        uint64_t values[HardwareCounters::COUNT] = {};
+        uint32_t validMask = ~0u; // 所有样本都有效的计数器
+    };
+
+    // 按名称汇总（同一字面量在不同编译单元中可能地址不同，因此按内容比较）
+    std::map<std::string, Aggregate> records;
+    std::map<std::string, CounterAggregate> counterRecords;
+    std::vector<ProfileEvent> events;
+    std::vector<CounterSample> samples;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto& buffer : buffers)
+        {
+            collectEvents(*buffer, events);
+            collectSamples(*buffer, samples);
+        }
+    }
+    // 带计数器的作用域同样计入时间表
+    for (const CounterSample& sample : samples)
+    {
+        events.push_back({sample.name, sample.begin, sample.end});
+
+        CounterAggregate& record = counterRecords[sample.name];
+        record.unitName = sample.unitName;
+        record.callCount++;
+        record.totalTicks += sample.end - sample.begin;
+        record.workUnits += sample.workUnits;
+        record.validMask &= sample.validMask;
+        for (int i = 0; i < HardwareCounters::COUNT; ++i)
+        {
+            record.values[i] += sample.values[i];
+        }
+    }
+    for (const ProfileEvent& event : events)
+    {
+        Aggregate& record = records[event.name];
+        const uint64_t duration = event.end - event.begin;
+        record.callCount++;
+        record.totalTicks += duration;
+        record.minTicks = std::min(record.minTicks, duration);
+        record.maxTicks = std::max(record.maxTicks, duration);
+    }
+
+    const double ticksPerMs = ticksPerMicrosecond() * 1000.0;
+    std::cout << "\n===== 性能分析报告 =====\n";
+    std::cout << std::left << std::setw(30) << "任务名称"
+              << std::setw(12) << "调用次数"
+              << std::setw(12) << "总时间(ms)"
+              << std::setw(12) << "平均时间(ms)"
+              << std::setw(12) << "最小时间(ms)"
+              << std::setw(12) << "最大时间(ms)" << std::endl;
+
+    std::cout << std::string(90, '-') << std::endl;
+
+    for (const auto& [name, record] : records)
+    {
+        std::cout << std::left << std::setw(30) << name
+                  << std::setw(12) << record.callCount
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(12) << record.totalTicks / ticksPerMs
+                  << std::setw(12) << record.totalTicks / ticksPerMs / record.callCount
+                  << std::setw(12) << record.minTicks / ticksPerMs
+                  << std::setw(12) << record.maxTicks / ticksPerMs << std::endl;
+    }
+
+    if (!counterRecords.empty())
+    {
+        // 缺失的计数器显示为n/a；每单位的数值按作用域给出的工作量（像素、三角形等）换算
+        const auto printValue = [](const CounterAggregate& record, bool valid, double value) {
+            if (valid && record.workUnits > 0)
+            {
+                std::cout << std::setw(14) << value;
+            }
+            else
+            {
+                std::cout << std::setw(14) << "n/a";
+            }
+        };
+        const auto hasCounter = [](const CounterAggregate& record, int counter) {
+            return (record.validMask & (1u << counter)) != 0;
+        };
+
+        std::cout << "\n----- 硬件计数器 -----\n";
+        std::cout << std::left << std::setw(30) << "任务名称"
+                  << std::setw(12) << "调用次数"
+                  << std::setw(12) << "总时间(ms)"
+                  << std::setw(8) << "IPC"
+                  << std::setw(10) << "单位"
+                  << std::setw(14) << "单位数"
+                  << std::setw(14) << "周期/单位"
+                  << std::setw(14) << "LLC缺失/单位"
+                  << std::setw(14) << "分支缺失/单位" << std::endl;
+        std::cout << std::string(128, '-') << std::endl;
+
+        for (const auto& [name, record] : counterRecords)
+        {
+            const double units = static_cast<double>(record.workUnits);
+            const uint64_t cycles = record.values[HardwareCounters::CYCLES];
+            std::cout << std::left << std::setw(30) << name
+                      << std::setw(12) << record.callCount
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(12) << record.totalTicks / ticksPerMs;
+            if (hasCounter(record, HardwareCounters::CYCLES) && hasCounter(record, HardwareCounters::INSTRUCTIONS) &&
+                cycles > 0)
+            {
+                std::cout << std::setw(8) << std::setprecision(2)
+                          << static_cast<double>(record.values[HardwareCounters::INSTRUCTIONS]) / cycles;
+            }
+            else
+            {
+                std::cout << std::setw(8) << "n/a";
+            }
+            std::cout << std::setw(10) << record.unitName
+                      << std::setw(14) << record.workUnits << std::setprecision(3);
+            printValue(record, hasCounter(record, HardwareCounters::CYCLES), cycles / units);
+            printValue(record, hasCounter(record, HardwareCounters::LLC_MISSES),
+                       record.values[HardwareCounters::LLC_MISSES] / units);
+            printValue(record, hasCounter(record, HardwareCounters::BRANCH_MISSES),
+                       record.values[HardwareCounters::BRANCH_MISSES] / units);
+            std::cout << std::endl;
+        }
+    }
+
+    std::cout << "========================\n";
+}
+
+bool Profiler::writeChromeTrace(const std::string& filename, uint64_t rangeBegin, uint64_t rangeEnd) const
+{
+    std::ofstream file(filename);
+    if (!file)
+    {
+        std::cerr << "无法创建文件：" << filename << std::endl;
+        return false;
+    }
+
+    const double ticksPerUs = ticksPerMicrosecond();
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // 时间以最早的事件为零点
+    std::vector<std::vector<ProfileEvent>> threadEvents(buffers.size());
+    std::vector<std::vector<CounterSample>> threadSamples(buffers.size());
+    uint64_t origin = UINT64_MAX;
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        std::vector<ProfileEvent> events;
+        collectEvents(*buffers[i], events);
+        for (const ProfileEvent& event : events)
+        {
+            if (event.begin >= rangeBegin && event.end <= rangeEnd)
+            {
+                threadEvents[i].push_back(event);
+                origin = std::min(origin, event.begin);
+            }
+        }
+
+        std::vector<CounterSample> samples;
+        collectSamples(*buffers[i], samples);
+        for (const CounterSample& sample : samples)
+        {
+            if (sample.begin >= rangeBegin && sample.end <= rangeEnd)
+            {
+                threadSamples[i].push_back(sample);
+                origin = std::min(origin, sample.begin);
+            }
+        }
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        const ThreadBuffer& buffer = *buffers[i];
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.threadId
+             << ",\"args\":{\"name\":";
+        writeJsonString(file, buffer.threadName.c_str());
+        file << "}}";
+        first = false;
+
+        for (const ProfileEvent& event : threadEvents[i])
+        {
+            file << ",\n{\"name\":";
+            writeJsonString(file, event.name);
+            file << ",\"cat\":\"render\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.threadId
+                 << ",\"ts\":" << (event.begin - origin) / ticksPerUs
+                 << ",\"dur\":" << (event.end - event.begin) / ticksPerUs << "}";
+        }
+
+        // 计数器读数作为事件参数，在trace中选中事件即可查看
+        for (const CounterSample& sample : threadSamples[i])
+        {
+            file << ",\n{\"name\":";
+            writeJsonString(file, sample.name);
+            file << ",\"cat\":\"render\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.threadId
+                 << ",\"ts\":" << (sample.begin - origin) / ticksPerUs
+                 << ",\"dur\":" << (sample.end - sample.begin) / ticksPerUs
+                 << ",\"args\":{";
+            writeJsonString(file, sample.unitName);
+            file << ":" << sample.workUnits;
+            for (int counter = 0; counter < HardwareCounters::COUNT; ++counter)
+            {
+                if (sample.validMask & (1u << counter))
+                {
+                    file << ",\"" << HardwareCounters::getName(counter) << "\":" << sample.values[counter];
+                }
+            }
+            file << "}}";
+        }
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
@@ -1,115 +1,217 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
 #include <vector>
-#include <iostream>
-#include <iomanip>
-#include <mutex>
+#include "perf_counters.h"
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <x86intrin.h>
+#define SR_PROFILER_USE_TSC 1
+#endif
+
+// 一个完整的事件：名称为静态字符串（字面量），时间戳为Profiler::timestamp()的计数
+struct ProfileEvent {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+// 附带硬件计数器读数的事件：workUnits为作用域处理的工作量（像素、三角形等），用于换算每单位的开销
+struct CounterSample {
+    const char* name;
+    const char* unitName; // 工作量单位，静态字符串
+    uint64_t begin;
+    uint64_t end;
+    uint64_t workUnits;
+    uint64_t values[HardwareCounters::COUNT]; // 作用域内的增量
+    uint32_t validMask;
+};
 
 /**
- * 性能分析器 - 用于测量和记录各个渲染步骤的执行时间
+ * 性能分析器 - 记录各个渲染步骤的开始/结束事件
+ *
+ * - 每个线程首次记录时注册自己的环形缓冲区，之后的记录只写本线程的缓冲区，热路径上没有锁，
+ *   缓冲区写满后覆盖最早的事件。
+ * - 事件名称必须是静态字符串（字符串字面量），只保存指针，不做哈希和复制。
+ * - 时间戳在x86上使用TSC（要求invariant TSC，各核同步），其他平台使用steady_clock纳秒数；
+ *   导出时按与steady_clock的比值换算为微秒。
+ * - 关闭时（默认）每个作用域只有一次原子读。
+ * - 启用硬件计数器后，PROFILE_COUNTERS_SCOPE作用域在开始和结束时读取本线程的perf计数器组
+ *   （每次读取是一次系统调用，只适合诊断），报告中给出IPC和每单位工作量的缓存/分支缺失；
+ *   计数器不可用时打印一次原因，这些作用域退化为普通的计时作用域。
+ * - 汇总报告和Chrome trace导出读取所有线程的缓冲区，应在没有线程记录时调用（例如帧之间或渲染结束后）。
+ *
+ * 导出的JSON可直接在chrome://tracing或Perfetto UI中打开，按线程显示各核的时间线。
  */
 class Profiler {
 public:
+    static constexpr size_t RING_CAPACITY = 1 << 16; // 每个线程保留的事件数（2的幂）
+    static constexpr int MAX_OPEN_SCOPES = 64;       // PROFILE_BEGIN/END的最大嵌套深度
+    static constexpr size_t COUNTER_RING_CAPACITY = 1 << 14; // 每个线程保留的计数器事件数（2的幂）
+
     // 单例模式获取实例
     static Profiler& getInstance() {
         static Profiler instance;
         return instance;
     }
 
-    // 开始测量一个指定名称的任务
-    void startProfile(const std::string& name) {
-        std::lock_guard<std::mutex> lock(mutex);
-        auto& record = records[name];
-        record.starts.push_back(std::chrono::high_resolution_clock::now());
+    void setEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // 启用硬件计数器，返回调用线程上计数器是否可用（其他线程在首次使用时各自打开）
+    bool enableHardwareCounters(bool enable);
+    bool areHardwareCountersEnabled() const { return countersEnabled.load(std::memory_order_relaxed); }
+
+    // 当前线程的计数器组，未启用或不可用时返回nullptr
+    HardwareCounters* threadCounters() {
+        if (!areHardwareCountersEnabled()) return nullptr;
+        ThreadBuffer& buffer = threadBuffer();
+        if (!buffer.countersOpened) {
+            openThreadCounters(buffer);
+        }
+        return buffer.counters.get();
     }
 
-    // 结束对指定名称任务的测量
-    void endProfile(const std::string& name) {
-        std::lock_guard<std::mutex> lock(mutex);
-        auto now = std::chrono::high_resolution_clock::now();
-        auto& record = records[name];
-        
-        if (!record.starts.empty()) {
-            auto start = record.starts.back();
-            record.starts.pop_back();
-            
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now - start).count();
-            record.totalTime += duration;
-            record.callCount++;
-            
-            if (duration < record.minTime || record.minTime == 0)
-                record.minTime = duration;
-                
-            if (duration > record.maxTime)
-                record.maxTime = duration;
+    // 当前时间戳（TSC或纳秒）
+    static uint64_t timestamp() {
+#ifdef SR_PROFILER_USE_TSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // 记录一个完整事件（作用域结束时调用）
+    void record(const char* name, uint64_t begin, uint64_t end) {
+        ThreadBuffer& buffer = threadBuffer();
+        if (!buffer.events) {
+            allocateEvents(buffer);
         }
+        const uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+        buffer.events[index & (RING_CAPACITY - 1)] = {name, begin, end};
+        buffer.writeIndex.store(index + 1, std::memory_order_release);
     }
 
-    // 重置所有性能数据
-    void reset() {
-        std::lock_guard<std::mutex> lock(mutex);
-        records.clear();
+    // 记录一个带计数器读数的事件，只能在threadCounters()返回非空的线程上调用
+    void recordCounters(const CounterSample& sample) {
+        ThreadBuffer& buffer = threadBuffer();
+        const uint64_t index = buffer.sampleWriteIndex.load(std::memory_order_relaxed);
+        buffer.samples[index & (COUNTER_RING_CAPACITY - 1)] = sample;
+        buffer.sampleWriteIndex.store(index + 1, std::memory_order_release);
     }
 
-    // 输出性能报告
-    void printReport() const {
-        std::lock_guard<std::mutex> lock(mutex);
-        std::cout << "\n===== 性能分析报告 =====\n";
-        std::cout << std::left << std::setw(30) << "任务名称" 
-                  << std::setw(12) << "调用次数" 
-                  << std::setw(12) << "总时间(ms)" 
-                  << std::setw(12) << "平均时间(ms)"
-                  << std::setw(12) << "最小时间(ms)" 
-                  << std::setw(12) << "最大时间(ms)" << std::endl;
-        
-        std::cout << std::string(90, '-') << std::endl;
-        
-        for (const auto& pair : records) {
-            const auto& name = pair.first;
-            const auto& record = pair.second;
-            
-            if (record.callCount > 0) {
-                double avgTime = static_cast<double>(record.totalTime) / record.callCount / 1000.0;
-                double totalTimeMs = record.totalTime / 1000.0;
-                double minTimeMs = record.minTime / 1000.0;
-                double maxTimeMs = record.maxTime / 1000.0;
-                
-                std::cout << std::left << std::setw(30) << name 
-                          << std::setw(12) << record.callCount
-                          << std::fixed << std::setprecision(3)
-                          << std::setw(12) << totalTimeMs
-                          << std::setw(12) << avgTime 
-                          << std::setw(12) << minTimeMs
-                          << std::setw(12) << maxTimeMs << std::endl;
-            }
+    // 开始/结束一个非作用域的测量，同一线程上按栈的顺序配对
+    void startProfile(const char* name) {
+        if (!isEnabled()) return;
+        ThreadBuffer& buffer = threadBuffer();
+        if (buffer.openDepth < MAX_OPEN_SCOPES) {
+            buffer.openScopes[buffer.openDepth] = {name, timestamp(), 0};
         }
-        
-        std::cout << "========================\n";
+        ++buffer.openDepth;
     }
 
+    void endProfile(const char* name) {
+        if (!isEnabled()) return;
+        ThreadBuffer& buffer = threadBuffer();
+        if (buffer.openDepth <= 0) return;
+        --buffer.openDepth;
+        if (buffer.openDepth < MAX_OPEN_SCOPES) {
+            const ProfileEvent& open = buffer.openScopes[buffer.openDepth];
+            record(open.name ? open.name : name, open.begin, timestamp());
+        }
+    }
+
+    // 为当前线程命名（显示在trace的线程列表中）
+    void setThreadName(const std::string& name);
+
+    // 丢弃此前记录的所有事件
+    void reset();
+
+    // 输出按名称汇总的性能报告
+    void printReport() const;
+
+    // 导出Chrome trace JSON，只包含完全落在[rangeBegin, rangeEnd]内的事件
+    bool writeChromeTrace(const std::string& filename, uint64_t rangeBegin = 0, uint64_t rangeEnd = UINT64_MAX) const;
+
+    // 时间戳计数换算为微秒的比例
+    double ticksPerMicrosecond() const;
+
 private:
-    Profiler() = default;
+    Profiler();
     ~Profiler() = default;
     Profiler(const Profiler&) = delete;
     Profiler& operator=(const Profiler&) = delete;
 
-    // 性能记录结构
-    struct ProfileRecord {
-        std::vector<std::chrono::time_point<std::chrono::high_resolution_clock>> starts;
-        uint64_t totalTime = 0;  // 微秒
-        uint64_t callCount = 0;
-        uint64_t minTime = 0;    // 微秒
-        uint64_t maxTime = 0;    // 微秒
+    // 单个线程的环形缓冲区，只有所属线程写入
+    struct ThreadBuffer {
+        std::unique_ptr<ProfileEvent[]> events; // 首次record时分配
+        std::atomic<uint64_t> writeIndex{0};
+        std::atomic<uint64_t> resetIndex{0}; // reset时的writeIndex，之前的事件不再导出
+        std::array<ProfileEvent, MAX_OPEN_SCOPES> openScopes{};
+        int openDepth = 0;
+        uint32_t threadId = 0;  // 注册顺序，作为trace中的tid
+        std::string threadName; // 由registryMutex保护
+        bool retired = false;   // 所属线程已退出，由registryMutex保护
+
+        // 硬件计数器及其事件，首次使用时打开
+        std::unique_ptr<HardwareCounters> counters;
+        bool countersOpened = false;
+        std::unique_ptr<CounterSample[]> samples;
+        std::atomic<uint64_t> sampleWriteIndex{0};
+        std::atomic<uint64_t> sampleResetIndex{0};
+    };
+
+    // 线程退出时退役其缓冲区（见retireThread）
+    struct ThreadBufferHandle {
+        ThreadBuffer* buffer = nullptr;
+        ~ThreadBufferHandle() {
+            if (buffer) {
+                Profiler::getInstance().retireThread(buffer);
+            }
+        }
     };
 
-    std::unordered_map<std::string, ProfileRecord> records;
-    mutable std::mutex mutex;
+    static ThreadBufferHandle& threadHandle() {
+        static thread_local ThreadBufferHandle handle;
+        return handle;
+    }
+
+    // 当前线程的缓冲区，首次调用时注册（只有这一次加锁）
+    ThreadBuffer& threadBuffer() {
+        ThreadBufferHandle& handle = threadHandle();
+        if (!handle.buffer) {
+            handle.buffer = registerThread();
+        }
+        return *handle.buffer;
+    }
+
+    ThreadBuffer* registerThread();
+    // 计数器的文件描述符立即关闭；没有待导出事件的缓冲区立即释放，其余保留到下一次reset
+    // （JobSystem::setWorkerCount反复重启工作线程时既不累积计数器也不累积缓冲区）
+    void retireThread(ThreadBuffer* buffer);
+    void allocateEvents(ThreadBuffer& buffer);
+    void openThreadCounters(ThreadBuffer& buffer);
+    // 复制一个线程缓冲区中仍有效的事件
+    void collectEvents(const ThreadBuffer& buffer, std::vector<ProfileEvent>& out) const;
+    void collectSamples(const ThreadBuffer& buffer, std::vector<CounterSample>& out) const;
+
+    std::atomic<bool> enabled{false};
+    std::atomic<bool> countersEnabled{false};
+    std::atomic<bool> counterErrorReported{false};
+    mutable std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers; // 已退出线程的缓冲区保留到下一次reset
+    uint32_t nextThreadId = 0;
+    uint64_t calibrationTicks = 0;                      // 构造时的时间戳，用于换算
+    std::chrono::steady_clock::time_point calibrationTime;
 };
 
-// 便于使用的辅助宏
+// 便于使用的辅助宏（名称必须是字符串字面量）
 #define PROFILE_BEGIN(name) Profiler::getInstance().startProfile(name)
 #define PROFILE_END(name) Profiler::getInstance().endProfile(name)
 #define PROFILE_RESET() Profiler::getInstance().reset()
@@ -118,17 +220,70 @@ private:
 // 自动测量作用域内代码执行时间的RAII类
 class ScopedProfiler {
 public:
-    explicit ScopedProfiler(const std::string& name) : name(name) {
-        PROFILE_BEGIN(name);
-    }
-    
+    explicit ScopedProfiler(const char* name)
+        : name(name), begin(Profiler::getInstance().isEnabled() ? Profiler::timestamp() : 0) {}
+
     ~ScopedProfiler() {
-        PROFILE_END(name);
+        if (begin != 0) {
+            Profiler::getInstance().record(name, begin, Profiler::timestamp());
+        }
     }
-    
+
+    ScopedProfiler(const ScopedProfiler&) = delete;
+    ScopedProfiler& operator=(const ScopedProfiler&) = delete;
+
 private:
-    std::string name;
+    const char* name;
+    uint64_t begin; // 0表示开始时分析器未启用
 };
 
 // 便于使用的作用域分析宏
-#define PROFILE_SCOPE(name) ScopedProfiler scopedProfiler##__LINE__(name)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ScopedProfiler PROFILE_CONCAT(scopedProfiler, __LINE__)(name)
+
+// 带硬件计数器的作用域：workUnits可在构造时给出，也可在作用域结束前通过setWorkUnits设置
+class CountedProfiler {
+public:
+    CountedProfiler(const char* name, const char* unitName, uint64_t workUnits = 0)
+        : name(name), unitName(unitName), workUnits(workUnits) {
+        Profiler& profiler = Profiler::getInstance();
+        if (!profiler.isEnabled()) return;
+        counters = profiler.threadCounters();
+        if (counters && !counters->read(startReading)) {
+            counters = nullptr;
+        }
+        begin = Profiler::timestamp();
+    }
+
+    ~CountedProfiler() {
+        if (begin == 0) return;
+        const uint64_t end = Profiler::timestamp();
+        Profiler& profiler = Profiler::getInstance();
+        HardwareCounters::Reading endReading;
+        CounterSample sample{name, unitName, begin, end, workUnits, {}, 0};
+        if (!counters || !counters->read(endReading) ||
+            !HardwareCounters::delta(startReading, endReading, sample.values)) {
+            profiler.record(name, begin, end);
+            return;
+        }
+        sample.validMask = counters->getValidMask();
+        profiler.recordCounters(sample);
+    }
+
+    void setWorkUnits(uint64_t units) { workUnits = units; }
+
+    CountedProfiler(const CountedProfiler&) = delete;
+    CountedProfiler& operator=(const CountedProfiler&) = delete;
+
+private:
+    const char* name;
+    const char* unitName;
+    uint64_t workUnits;
+    uint64_t begin = 0;
+    HardwareCounters* counters = nullptr;
+    HardwareCounters::Reading startReading{};
+};
+
+#define PROFILE_COUNTERS_SCOPE(name, unitName, workUnits) \
+    CountedProfiler PROFILE_CONCAT(countedProfiler, __LINE__)(name, unitName, workUnits)
@@ -1,18 +1,7 @@
-#include "platform.h"
 #include "renderer.h"
 
-// 将渲染器的帧缓冲区复制到平台帧缓冲区
-void copyFrameBufferToPlatform(const Renderer &renderer)
-{
-    // 获取平台帧缓冲区
-    uint32_t *dst = static_cast<uint32_t *>(platform_get_framebuffer());
-
-    // 直接使用帧缓冲区内置的复制方法
-    renderer.getFrameBuffer().copyToPlatform(dst);
-}
-
-// 将帧缓冲区保存为PPM格式图像（向后兼容）
-void saveToPPM(const std::string &filename, const FrameBuffer &frameBuffer,bool debugMode)
+// 将ARGB8888像素保存为PPM格式图像，pitch为每行像素数
+void saveToPPM(const std::string &filename, const uint32_t *pixels, int width, int height, int pitch, bool debugMode)
 {
     std::ofstream file(filename, std::ios::binary);
     if (!file)
@@ -24,19 +13,23 @@ void saveToPPM(const std::string &filename, const FrameBuffer &frameBuffer,bool
         return;
     }
 
-    int width = frameBuffer.getWidth();
-    int height = frameBuffer.getHeight();
-
     // 写入 PPM 文件头
     file << "P6\n"
          << width << " " << height << "\n255\n";
 
     // 写入像素数据（注意：PPM 只支持 RGB，不支持 alpha 通道）
-    const uint8_t *data = frameBuffer.getData();
-    for (int i = 0; i < width * height; ++i)
+    std::vector<uint8_t> row(width * 3);
+    for (int y = 0; y < height; ++y)
     {
-        int index = i * 4;                                           // RGBA 格式
-        file.write(reinterpret_cast<const char *>(&data[index]), 3); // 只写入 RGB
+        const uint32_t *src = pixels + static_cast<size_t>(y) * pitch;
+        for (int x = 0; x < width; ++x)
+        {
+            const uint32_t pixel = src[x]; // ARGB8888
+            row[x * 3] = static_cast<uint8_t>(pixel >> 16);
+            row[x * 3 + 1] = static_cast<uint8_t>(pixel >> 8);
+            row[x * 3 + 2] = static_cast<uint8_t>(pixel);
+        }
+        file.write(reinterpret_cast<const char *>(row.data()), row.size());
     }
 
     if (debugMode)
@@ -44,3 +37,37 @@ void saveToPPM(const std::string &filename, const FrameBuffer &frameBuffer,bool
         std::cout << "图像已保存到 " << filename << std::endl;
     }
 }
+
+// 将帧缓冲区保存为PPM格式图像（向后兼容）
+void saveToPPM(const std::string &filename, const FrameBuffer &frameBuffer,bool debugMode)
+{
+    // 按行展开（处理分块布局和尚未填充的延迟清除tile）
+    std::vector<uint32_t> pixels(static_cast<size_t>(frameBuffer.getWidth()) * frameBuffer.getHeight());
+    frameBuffer.copyToPlatform(pixels.data());
+    saveToPPM(filename, pixels.data(), frameBuffer.getWidth(), frameBuffer.getHeight(), frameBuffer.getWidth(), debugMode);
+}
+
+bool loadPPM(const std::string &filename, std::vector<uint32_t> &pixels, int &width, int &height)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::string magic;
+    int maxValue = 0;
+    if (!(file >> magic >> width >> height >> maxValue) || magic != "P6" || maxValue != 255 || width <= 0 || height <= 0)
+    {
+        return false;
+    }
+    file.get(); // 文件头后的单个空白字符
+
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+    if (!file.read(reinterpret_cast<char *>(rgb.data()), rgb.size()))
+    {
+        return false;
+    }
+    pixels.resize(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        pixels[i] = 0xFF000000u | (static_cast<uint32_t>(rgb[i * 3]) << 16) |
+                    (static_cast<uint32_t>(rgb[i * 3 + 1]) << 8) | rgb[i * 3 + 2];
+    }
+    return true;
+}
@@ -2,7 +2,8 @@
 #pragma once
 #include "renderer.h"
 
-// 将渲染器的帧缓冲区复制到平台帧缓冲区
-void copyFrameBufferToPlatform(const Renderer &renderer);
-
-void saveToPPM(const std::string &filename, const FrameBuffer &frameBuffer,bool debugMode);
\ No newline at end of file
+// 保存为PPM格式图像（不依赖平台层）
+void saveToPPM(const std::string &filename, const FrameBuffer &frameBuffer,bool debugMode);
+void saveToPPM(const std::string &filename, const uint32_t *pixels, int width, int height, int pitch, bool debugMode);
+// 读取saveToPPM写出的P6图像为ARGB8888像素（alpha为255），失败时返回false
+bool loadPPM(const std::string &filename, std::vector<uint32_t> &pixels, int &width, int &height);
\ No newline at end of file